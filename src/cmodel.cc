@@ -0,0 +1,376 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 1999, 2020 Manfred Maennle
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * $Id$
+ */
+
+
+
+#include "cmodel.hh"
+
+
+const size_t CModel::block;
+
+
+// //////////////////////////////////////////////////////////////////////
+
+void
+CModel::compile(const FModel& m) {
+  assert(m.rdim() > 0);
+  rdim_ = m.rdim();
+  udim_ = m.udim();
+  cdim_ = m.cdim();
+  sdim_ = m.sdim();
+  // /// fuzzy sets
+  mu_.resize(sdim_);
+  sigma_.resize(sdim_);
+  uindex_.assign(sdim_, 0);
+  for (size_t s = 0; s < sdim_; ++s) {
+    mu_[s] = m.fsets(s).mu();
+    sigma_[s] = m.fsets(s).sigma();
+  }
+  // /// premises: fset indices instead of pointers, in slot order
+  prem_begin_.resize(rdim_ + 1);
+  prem_.clear();
+  const FSet* fset_begin = (sdim_ > 0) ? &m.fsets(0) : NULL;
+  for (size_t r = 0; r < rdim_; ++r) {
+    prem_begin_[r] = prem_.size();
+    const Premise& prem = m.frules(r).prem();
+    assert(prem.size() == 2 * udim_);
+    for (size_t slot = 0; slot < prem.size(); ++slot) {
+      if (prem[slot] != NULL) {
+	size_t s = prem[slot] - fset_begin;
+	assert(s < sdim_);
+	uindex_[s] = slot / 2;
+	prem_.push_back(s);
+      }
+    }
+  }
+  prem_begin_[rdim_] = prem_.size();
+  // /// consequences
+  cons_.resize(rdim_ * cdim_);
+  for (size_t r = 0; r < rdim_; ++r) {
+    const Consequence& cons = m.frules(r).cons();
+    assert(cons.size() == (Subscript)cdim_);
+    for (size_t c = 0; c < cdim_; ++c) {
+      cons_[r * cdim_ + c] = cons[c];
+    }
+  }
+  // /// refinement tree
+  tree_ = false;
+  if (GLOBAL::tree_premises) {
+    tree_ = compile_tree(m);
+  }
+  return;
+}
+
+// //////////////////////////////////////////////////////////////////////
+
+bool
+CModel::compile_tree(const FModel& m) {
+  const vector<size_t>& history = m.history();
+  if ((sdim_ != 2 * (rdim_ - 1)) || (history.size() != sdim_)) {
+    return false;
+  }
+  const size_t none = sdim_;
+  /// premise slots of each node: fset index or none
+  vector< vector<size_t> > slots(1, vector<size_t>(2 * udim_, none));
+  node_parent_.assign(1, 0);
+  node_fset_.assign(1, none);
+  node_replaced_.assign(1, none);
+  rule_node_.assign(1, 0);
+  // /// replay the refinements: refinement k splits rule r along input u;
+  // /// rule r gets the new left fset 2k, the new rule r+1 the right one
+  for (size_t k = 0; 2 * k < history.size(); ++k) {
+    size_t r = history[2*k];
+    size_t u = history[2*k + 1];
+    if ((r >= rule_node_.size()) || (u >= udim_)) {
+      return false;
+    }
+    size_t parent = rule_node_[r];
+    for (size_t side = 0; side < 2; ++side) {
+      size_t slot = (side == 0) ? 2*u + 1 : 2*u;
+      vector<size_t> child(slots[parent]);
+      node_parent_.push_back(parent);
+      node_fset_.push_back(2*k + side);
+      node_replaced_.push_back(child[slot]);
+      child[slot] = 2*k + side;
+      slots.push_back(child);
+    }
+    rule_node_[r] = slots.size() - 2;
+    rule_node_.insert(rule_node_.begin() + r + 1, slots.size() - 1);
+  }
+  // /// the tree's leaves must be the model's premises
+  if (rule_node_.size() != rdim_) {
+    return false;
+  }
+  const FSet* fset_begin = m.fset_begin();
+  for (size_t r = 0; r < rdim_; ++r) {
+    const Premise& prem = m.frules(r).prem();
+    for (size_t slot = 0; slot < prem.size(); ++slot) {
+      size_t s = (prem[slot] != NULL) ? (size_t)(prem[slot] - fset_begin) 
+	: none;
+      if (s != slots[rule_node_[r]][slot]) {
+	return false;
+      }
+    }
+  }
+  node_prem_begin_.resize(slots.size() + 1);
+  node_prem_.clear();
+  for (size_t node = 0; node < slots.size(); ++node) {
+    node_prem_begin_[node] = node_prem_.size();
+    for (size_t slot = 0; slot < slots[node].size(); ++slot) {
+      if (slots[node][slot] != none) {
+	node_prem_.push_back(slots[node][slot]);
+      }
+    }
+  }
+  node_prem_begin_[slots.size()] = node_prem_.size();
+  return true;
+}
+
+// //////////////////////////////////////////////////////////////////////
+
+void
+CModel::tree_values(const Real* F, Real* act, size_t stride, size_t n) const {
+  for (size_t i = 0; i < n; ++i) {
+    act[i] = 1.0;
+  }
+  for (size_t node = 1; node < node_parent_.size(); ++node) {
+    const Real* pparent = act + node_parent_[node] * stride;
+    const Real* pnew = F + node_fset_[node] * stride;
+    Real* pact = act + node * stride;
+    if (node_replaced_[node] == sdim_) {
+      for (size_t i = 0; i < n; ++i) {
+	pact[i] = pparent[i] * pnew[i];
+      }
+    }
+    else {
+      const Real* pold = F + node_replaced_[node] * stride;
+      for (size_t i = 0; i < n; ++i) {
+	// /// the ratio is exact up to rounding only if neither the parent's
+	// /// activation nor the replaced fset's value is zero or subnormal
+	if ((pparent[i] >= REAL_MIN) && (pold[i] >= REAL_MIN)) {
+	  pact[i] = pparent[i] / pold[i] * pnew[i];
+	}
+	else {
+	  // /// cannot divide: take the node's full premise
+	  pact[i] = 1.0;
+	  for (size_t p = node_prem_begin_[node]; 
+	       p < node_prem_begin_[node+1]; ++p) {
+	    pact[i] *= F[node_prem_[p] * stride + i];
+	  }
+	}
+      }
+    }
+  }
+  return;
+}
+
+// //////////////////////////////////////////////////////////////////////
+
+void
+CModel::y_hat(const Umatrix& U, vector<Real>& yhat, 
+	      vector<bool>& covered) const {
+  assert(rdim_ > 0);
+  assert(U.empty() || (U.udim() == (Subscript)udim_));
+  yhat.resize(U.size());
+  covered.resize(U.size());
+  /// the block's inputs column by column (unless U has a column mirror)
+  vector<Real> ucol(U.has_columns() ? 0 : udim_ * block);
+  /// the block's membership values fset by fset
+  vector<Real> F(sdim_ * block);
+  vector<Real> prem(block);
+  /// the block's tree node activations node by node
+  vector<Real> act(tree_ ? node_parent_.size() * block : 0);
+  vector<Real> sum_premvalues(block);
+  vector<Real> sum_rulevalues(block);
+  for (size_t begin = 0; begin < U.size(); begin += block) {
+    size_t n = U.size() - begin;
+    if (n > block) {
+      n = block;
+    }
+    if (! U.has_columns()) {
+      for (size_t i = 0; i < n; ++i) {
+	Urow::const_iterator pu = U[begin+i].begin();
+	for (size_t k = 0; k < udim_; ++k) {
+	  ucol[k * block + i] = pu[k];
+	}
+      }
+    }
+    for (size_t s = 0; s < sdim_; ++s) {
+      const Real* pucol = U.has_columns() ? U.column(uindex_[s]) + begin
+	: &ucol[uindex_[s] * block];
+      membership(mu_[s], sigma_[s], pucol, &F[s * block], n);
+    }
+    for (size_t i = 0; i < n; ++i) {
+      sum_premvalues[i] = 0.0;
+      sum_rulevalues[i] = 0.0;
+    }
+    if (tree_) {
+      tree_values(&F[0], &act[0], block, n);
+    }
+    for (size_t r = 0; r < rdim_; ++r) {
+      const Real* pprem = &prem[0];
+      if (tree_) {
+	pprem = &act[rule_node_[r] * block];
+      }
+      else {
+	for (size_t i = 0; i < n; ++i) {
+	  prem[i] = 1.0;
+	}
+	for (size_t p = prem_begin_[r]; p < prem_begin_[r+1]; ++p) {
+	  const Real* pF = &F[prem_[p] * block];
+	  for (size_t i = 0; i < n; ++i) {
+	    prem[i] *= pF[i];
+	  }
+	}
+      }
+      for (size_t i = 0; i < n; ++i) {
+	sum_premvalues[i] += pprem[i];
+	sum_rulevalues[i] += inference(pprem[i], consvalue(r, U[begin+i]));
+      }
+    }
+    for (size_t i = 0; i < n; ++i) {
+      covered[begin+i] = (sum_premvalues[i] > 0.0);
+      if (covered[begin+i]) {
+	yhat[begin+i] = sum_rulevalues[i] / sum_premvalues[i];
+      }
+      else {
+	yhat[begin+i] = 0.0;
+      }
+    }
+  }
+  return;
+}
+
+// //////////////////////////////////////////////////////////////////////
+
+void
+CModel::y_hat(const Umatrix& U, const vector<Real>& w,
+	      vector<Real>& yhat, vector<bool>& covered) const {
+  assert(rdim_ > 0);
+  assert(w.size() == U.size() * rdim_);
+  yhat.resize(U.size());
+  covered.resize(U.size());
+  const Real* pw = w.empty() ? NULL : &w[0];
+  for (size_t i = 0; i < U.size(); ++i) {
+    register Real sum_premvalues = 0.0;
+    register Real sum_rulevalues = 0.0;
+    for (size_t r = 0; r < rdim_; ++r) {
+      sum_premvalues += pw[r];
+      sum_rulevalues += inference(pw[r], consvalue(r, U[i]));
+    }
+    covered[i] = (sum_premvalues > 0.0);
+    if (covered[i]) {
+      yhat[i] = sum_rulevalues / sum_premvalues;
+    }
+    else {
+      yhat[i] = 0.0;
+    }
+    pw += rdim_;
+  }
+  return;
+}
+
+// //////////////////////////////////////////////////////////////////////
+
+void
+CModel::premvalues(const Umatrix& U, size_t first, size_t last,
+		   vector<Real>& w) const {
+  assert(rdim_ > 0);
+  assert(U.empty() || (U.udim() == (Subscript)udim_));
+  assert(first <= last);
+  assert(last <= U.size());
+  w.resize((last - first) * rdim_);
+  /// the block's inputs column by column (unless U has a column mirror)
+  vector<Real> ucol(U.has_columns() ? 0 : udim_ * block);
+  /// the block's membership values fset by fset
+  vector<Real> F(sdim_ * block);
+  vector<Real> prem(block);
+  for (size_t begin = first; begin < last; begin += block) {
+    size_t n = last - begin;
+    if (n > block) {
+      n = block;
+    }
+    if (! U.has_columns()) {
+      for (size_t i = 0; i < n; ++i) {
+	Urow::const_iterator pu = U[begin+i].begin();
+	for (size_t k = 0; k < udim_; ++k) {
+	  ucol[k * block + i] = pu[k];
+	}
+      }
+    }
+    for (size_t s = 0; s < sdim_; ++s) {
+      const Real* pucol = U.has_columns() ? U.column(uindex_[s]) + begin
+	: &ucol[uindex_[s] * block];
+      membership(mu_[s], sigma_[s], pucol, &F[s * block], n);
+    }
+    for (size_t r = 0; r < rdim_; ++r) {
+      for (size_t i = 0; i < n; ++i) {
+	prem[i] = 1.0;
+      }
+      for (size_t p = prem_begin_[r]; p < prem_begin_[r+1]; ++p) {
+	const Real* pF = &F[prem_[p] * block];
+	for (size_t i = 0; i < n; ++i) {
+	  prem[i] *= pF[i];
+	}
+      }
+      Real* pw = &w[(begin - first) * rdim_ + r];
+      for (size_t i = 0; i < n; ++i) {
+	pw[i * rdim_] = prem[i];
+      }
+    }
+  }
+  return;
+}
+
+// //////////////////////////////////////////////////////////////////////
+
+void
+CModel::premvalues(const Umatrix& U, const vector<Real>& parent_w,
+		   size_t r, vector<Real>& w) const {
+  assert(rdim_ > 1);
+  assert(r + 1 < rdim_);
+  assert(parent_w.size() == U.size() * (rdim_ - 1));
+  w.resize(U.size() * rdim_);
+  if (U.empty()) {
+    return;
+  }
+  const Real* ppw = &parent_w[0];
+  Real* pw = &w[0];
+  for (size_t i = 0; i < U.size(); ++i) {
+    // /// rules before r and after r+1 are the parent's rules
+    for (size_t k = 0; k < r; ++k) {
+      pw[k] = ppw[k];
+    }
+    pw[r] = premvalue(r, U[i]);
+    pw[r+1] = premvalue(r+1, U[i]);
+    for (size_t k = r+2; k < rdim_; ++k) {
+      pw[k] = ppw[k-1];
+    }
+    ppw += rdim_ - 1;
+    pw += rdim_;
+  }
+  return;
+}
@@ -0,0 +1,285 @@
+#ifndef CMODEL_HH
+#define CMODEL_HH
+
+/*
+ * MIT License
+ *
+ * Copyright (c) 1999, 2020 Manfred Maennle
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * $Id$
+ */
+
+
+#ifndef WIN2017
+#include <vector.h>  // STL vectors
+#include <vec.h>     // TNT vectors
+#else
+#include <vector>    // STL vectors
+#include <tnt.h>     // TNT vectors
+#endif
+
+#include "global.hh"
+#include "fmodel.hh"
+
+
+
+/*
+ * **********************************************************************
+ * ********** CModel
+ * **********************************************************************
+ */
+
+/** Compiled Fuzzy Model: a read-only flat copy of a FModel for inference.
+ *
+ * The Fuzzy Sets are packed into the arrays mu, sigma and uindex; the
+ * premises refer to them by index (in the same order as the slots of
+ * the FRule premises), and the consequences are stored row by row.
+ * y_hat() evaluates exactly the same operations in the same order as
+ * FModel::y_hat(), so both give identical results.
+ *
+ * With #GLOBAL::tree_premises# the premises are evaluated along the
+ * refinement tree instead: each node's activation is its parent's
+ * times the new fuzzy set, divided by the fuzzy set it replaces, which
+ * costs O(rules) instead of O(rules * udim) per input vector. Where
+ * the parent's activation or the replaced fuzzy set's value is zero or
+ * subnormal, the node's full premise is multiplied out instead, so the
+ * activations differ from the premise values by a few roundings per
+ * tree level only; so do the results from FModel::y_hat().
+ * @memo
+ */
+class CModel
+{
+protected:
+  /// number of rules
+  size_t rdim_;
+  /// input space dimension
+  size_t udim_;
+  /// consequence dimension
+  size_t cdim_;
+  /// number of fsets
+  size_t sdim_;
+  /// fset centers
+  vector<Real> mu_;
+  /// fset steepnesses
+  vector<Real> sigma_;
+  /// fset input indices
+  vector<size_t> uindex_;
+  /// premise of rule r: prem_[prem_begin_[r]] ... prem_[prem_begin_[r+1]-1]
+  vector<size_t> prem_begin_;
+  /// fset indices of all premises
+  vector<size_t> prem_;
+  /// consequence parameters, cdim values per rule
+  vector<Real> cons_;
+  /// evaluate premises along the refinement tree
+  bool tree_;
+  /// parent of each tree node; node 0 is the root (the one-rule model)
+  vector<size_t> node_parent_;
+  /// fset added by each node
+  vector<size_t> node_fset_;
+  /// fset replaced by each node (sdim if none)
+  vector<size_t> node_replaced_;
+  /// full premise of node n: node_prem_[node_prem_begin_[n]] ...
+  vector<size_t> node_prem_begin_;
+  vector<size_t> node_prem_;
+  /// leaf node of each rule
+  vector<size_t> rule_node_;
+  /// build the refinement tree from the model's history; false if the
+  /// history does not reproduce the model's premises
+  bool compile_tree(const FModel& m);
+  /// node activations act[node * stride + i] from the fset values 
+  /// F[s * stride + i], for i < n
+  void tree_values(const Real* F, Real* act, size_t stride, size_t n) const;
+public:
+  /// number of input vectors the block kernels evaluate at once
+  static const size_t block = 256;
+  /// empty model
+  CModel() : rdim_(0), udim_(0), cdim_(0), sdim_(0), tree_(false) { }
+  /// compiled copy of a model
+  CModel(const FModel& m) 
+    : rdim_(0), udim_(0), cdim_(0), sdim_(0), tree_(false) { 
+    compile(m); 
+  }
+  ~CModel() { }
+  const size_t& rdim() const { return rdim_; }
+  const size_t& udim() const { return udim_; }
+  const size_t& cdim() const { return cdim_; }
+  const size_t& sdim() const { return sdim_; }
+  const bool& tree() const { return tree_; }
+
+  /// (re)compile from a model
+  void compile(const FModel& m);
+  /// membership value of fset s
+  Real F(size_t s, Real u) const {
+    assert(s < sdim_);
+#ifdef TRAPEZOIDAL_FSETS
+    return trapezoid(sigma_[s], (u-mu_[s]));
+#else
+    return sigmoid(sigma_[s] * (u-mu_[s]));
+#endif
+  }
+  /// premise value of rule r for a given input vector
+  Real premvalue(size_t r, const Urow& u) const {
+    assert(r < rdim_);
+    assert(u.size() == (Subscript)udim_);
+    const size_t* ps = &prem_[0] + prem_begin_[r];
+    const size_t* ps_end = &prem_[0] + prem_begin_[r+1];
+    Urow::const_iterator pu = u.begin();
+    register Real premvalue = 1.0;
+    while (ps != ps_end) {
+      premvalue *= F(*ps, pu[uindex_[*ps]]);
+      ++ps;
+    }
+    return premvalue;
+  }
+  /// membership values of all fsets for a given input vector
+  void fset_values(const Urow& u, vector<Real>& F) const {
+    assert(u.size() == (Subscript)udim_);
+    F.resize(sdim_);
+    Urow::const_iterator pu = u.begin();
+    for (size_t s = 0; s < sdim_; ++s) {
+      F[s] = this->F(s, pu[uindex_[s]]);
+    }
+  }
+  /// premise value of rule r from the membership values F of all fsets
+  Real premvalue(size_t r, const vector<Real>& F) const {
+    assert(r < rdim_);
+    assert(F.size() == sdim_);
+    const size_t* ps = &prem_[0] + prem_begin_[r];
+    const size_t* ps_end = &prem_[0] + prem_begin_[r+1];
+    register Real premvalue = 1.0;
+    while (ps != ps_end) {
+      premvalue *= F[*(ps++)];
+    }
+    return premvalue;
+  }
+  /// consequence value of rule r for a given input vector
+  Real consvalue(size_t r, const Urow& u) const {
+    assert(r < rdim_);
+    assert(cdim_ > 0);
+    assert(cdim_ <= u.size()+1);
+    const Real* pcons = &cons_[r * cdim_];
+    const Real* pcons_end = pcons + cdim_;
+    Urow::const_iterator pu = u.begin();
+    register Real consvalue = *(pcons++);
+    while (pcons != pcons_end) {
+      consvalue += *(pcons++) * *(pu++);
+    }
+    return consvalue;
+  }
+  /// feedforward step; returns $\hat{y}$
+  Real y_hat(const Urow& u) const throw (Error) {
+    vector<Real> F;
+    return y_hat(u, F);
+  }
+  /// feedforward step using F as scratch for the fset values (and the
+  /// tree node activations)
+  Real y_hat(const Urow& u, vector<Real>& F) const throw (Error) {
+    return y_hat_of(u, F);
+  }
+  /// feedforward step for an input vector u[0], ..., u[udim-1] of any 
+  /// type with operator[] (e.g., RecurrentInput), using F as scratch
+  template <class Input>
+  Real y_hat_of(const Input& u, vector<Real>& F) const throw (Error);
+  /// feedforward step for all input vectors, computed block by block
+  /// with the vectorized membership(); covered[i] is false (and 
+  /// yhat[i] = 0.0) where no rule covers U[i]
+  void y_hat(const Umatrix& U, vector<Real>& yhat, 
+	     vector<bool>& covered) const;
+  /// feedforward step for all input vectors from their premise values
+  /// w (see premvalues())
+  void y_hat(const Umatrix& U, const vector<Real>& w,
+	     vector<Real>& yhat, vector<bool>& covered) const;
+
+  /// premise values of all rules for all input vectors, row by row
+  /// (rdim values per input vector), computed block by block
+  void premvalues(const Umatrix& U, vector<Real>& w) const {
+    premvalues(U, 0, U.size(), w);
+  }
+  /// premise values of all rules for the input vectors U[first..last-1]
+  void premvalues(const Umatrix& U, size_t first, size_t last,
+		  vector<Real>& w) const;
+  /** premise values of all rules for all input vectors, for a model
+      that refines rule r of a parent model.
+      The parent's premise values parent_w (rdim-1 per input vector)
+      are reused; only the two new rules r and r+1 are evaluated.
+      @memo premise values of a refined model */
+  void premvalues(const Umatrix& U, const vector<Real>& parent_w,
+		  size_t r, vector<Real>& w) const;
+};
+
+
+/** Input vector of a simulation step: the n exogenous inputs u[0], ..., 
+ * u[n-1] of a data row, followed by the last outputs 
+ * $\hat{y}(t-1), \hat{y}(t-2), \ldots$, both read in place (see 
+ * OutputHistory).
+ * @memo input vector of a simulation step
+ */
+class RecurrentInput
+{
+  Urow u_;
+  size_t n_;
+  const Real* history_;
+public:
+  RecurrentInput(const Urow& u, size_t n, const Real* history)
+    : u_(u), n_(n), history_(history) { }
+  Real operator[](size_t k) const { 
+    return (k < n_) ? u_[k] : history_[k - n_]; 
+  }
+};
+
+
+template <class Input>
+Real
+CModel::y_hat_of(const Input& u, vector<Real>& F) const throw (Error) {
+  assert(rdim_ > 0);
+  F.resize(sdim_);
+  for (size_t s = 0; s < sdim_; ++s) {
+    F[s] = this->F(s, u[uindex_[s]]);
+  }
+  const Real* act = NULL;
+  if (tree_) {
+    F.resize(sdim_ + node_parent_.size());
+    tree_values(&F[0], &F[sdim_], 1, 1);
+    act = &F[sdim_];
+  }
+  register Real sum_premvalues = 0.0;
+  register Real sum_rulevalues = 0.0;
+  for (size_t r = 0; r < rdim_; ++r) {
+    register Real premvalue = tree_ ? act[rule_node_[r]] 
+      : this->premvalue(r, F);
+    // /// consequence value, as consvalue()
+    const Real* pcons = &cons_[r * cdim_];
+    register Real consvalue = pcons[0];
+    for (size_t k = 1; k < cdim_; ++k) {
+      consvalue += pcons[k] * u[k - 1];
+    }
+    sum_premvalues += premvalue;
+    sum_rulevalues += inference(premvalue, consvalue);
+  }
+  if (sum_premvalues <= 0.0) {
+    throw IncompleteCoverageError("CModel::y_hat()");
+  }
+  assert(sum_premvalues != 0.0);
+  return sum_rulevalues / sum_premvalues;
+}
+
+
+#endif /* ifndef CMODEL_HH */
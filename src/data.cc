@@ -28,10 +28,21 @@
 
 #ifndef WIN2017
 #include <fstream.h>
-#include <list.h>
+#include <algo.h>
 #else
 #include <fstream>
-#include <list>
+#include <algorithm>
+#endif
+#include <stdlib.h>
+#ifdef WIN2017
+#include <malloc.h>
+#endif
+#include <string.h>
+#include <ctype.h>
+#include <stdint.h>
+#include <sys/types.h>
+#ifndef WIN2017
+#include <sys/mman.h>
 #endif
 
 
@@ -39,176 +50,439 @@
 #include "data.hh"
 
 #include "data_lex.h"
-#undef yyFlexLexer
-#define yyFlexLexer data_FlexLexer
-#include <FlexLexer.h>
+#include "data_scan.hh"
 
 
-std::ostream& operator<<(std::ostream &strm, const vector<Real> &v) {
-  vector<Real>::const_iterator p = v.begin();
-  while (p != v.end()) {
-    strm << *(p++) << " ";
-  }
-  return strm;
-}
+/*
+ * ********** data scanner
+ */
 
-std::ostream& operator<<(std::ostream &strm, const Uvector &v) {
-  size_t N=v.dim();
-  for (size_t i=0; i<N; i++)
-    strm << v[i] << " ";
-  // strm << endl;
-  return strm;
+/// atof() of the number [p, end) (syntax of data_lex.l), with the same
+/// result: up to 19 significant digits and a decimal exponent of at most
+/// 22 need one exact multiplication or division of exact doubles, i.e.,
+/// the correctly rounded result of strtod(); the rest goes to strtod()
+static double 
+fast_atof(const char* p, const char* end) {
+  /// exact powers of ten
+  static const double power10[] = { 
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11, 
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22 };
+  const char* begin = p;
+  bool negative = false;
+  if ((*p == '-') || (*p == '+')) {
+    negative = (*p == '-');
+    ++p;
+  }
+  unsigned long long mantissa = 0;
+  int n_digits = 0;
+  int exponent = 0;
+  for (; (p < end) && (*p >= '0') && (*p <= '9'); ++p) {
+    if ((mantissa > 0) || (*p != '0')) {
+      mantissa = mantissa * 10 + (*p - '0');
+      ++n_digits;
+    }
+  }
+  if ((p < end) && (*p == '.')) {
+    for (++p; (p < end) && (*p >= '0') && (*p <= '9'); ++p) {
+      if ((mantissa > 0) || (*p != '0')) {
+	mantissa = mantissa * 10 + (*p - '0');
+	++n_digits;
+      }
+      --exponent;
+    }
+  }
+  bool exact = (n_digits <= 19);
+  if ((p < end) && ((*p == 'e') || (*p == 'E'))) {
+    ++p;
+    bool negative_exponent = false;
+    if ((p < end) && ((*p == '-') || (*p == '+'))) {
+      negative_exponent = (*p == '-');
+      ++p;
+    }
+    int e = 0;
+    for (; (p < end) && (*p >= '0') && (*p <= '9'); ++p) {
+      if (e < 100000) {
+	e = e * 10 + (*p - '0');
+      }
+    }
+    exponent += negative_exponent ? -e : e;
+  }
+  if (mantissa == 0) {
+    return negative ? -0.0 : 0.0;
+  }
+  if (exact && (mantissa <= (1ULL << 53)) 
+      && (exponent >= -22) && (exponent <= 22)) {
+    double value = (double)mantissa;
+    if (exponent < 0) {
+      value /= power10[-exponent];
+    }
+    else {
+      value *= power10[exponent];
+    }
+    return negative ? -value : value;
+  }
+  string number(begin, end);
+  return strtod(number.c_str(), NULL);
 }
 
 
-std::ostream& operator << (std::ostream& strm, const Data& d) {
-  strm << "### filename: \"" << d.filename_ << "\"\n";
-  vector<Uvector>::const_iterator pU = d.U_.begin();
-  vector<Real>::const_iterator py = d.y_.begin();
-  size_t blockline = 0;
-  while (pU != d.U_.end()) {
-    strm << *(pU++);
-    strm << *(py++) << endl;
-    if (++blockline == d.blocksize()) {
-      strm << endl;
-      blockline = 0;
+bool
+DataScanner::fill(void) {
+  if (file_ == NULL) { // / a range in memory is scanned at once
+    return false;
+  }
+  // /// move the incomplete line to the front
+  size_t rest = size_ - end_;
+  offset_ += end_;
+  for (size_t i = 0; i < rest; ++i) {
+    buffer_[i] = buffer_[end_ + i];
+  }
+  size_ = rest;
+  p_ = 0;
+  end_ = 0;
+  // /// end_ behind the last newline; at the end of the file, the rest
+  for (size_t i = size_; i > 0; --i) {
+    if (buffer_[i-1] == '\n') {
+      end_ = i;
+      break;
     }
   }
-  return strm;
+  while ((end_ == 0) && ! eof_) {
+    if (size_ == buffer_.size()) { // / a line longer than the buffer
+      buffer_.resize(2 * buffer_.size());
+    }
+    size_t n = fread(&buffer_[size_], 1, buffer_.size() - size_, file_);
+    if (n == 0) {
+      eof_ = true;
+      break;
+    }
+    for (size_t i = size_ + n; i > size_; --i) {
+      if (buffer_[i-1] == '\n') {
+	end_ = i;
+	break;
+      }
+    }
+    size_ += n;
+  }
+  if (eof_ && (end_ == 0)) {
+    end_ = size_;
+  }
+  data_ = &buffer_[0];
+  return (end_ > 0);
 }
 
 
-Data::Data(Subscript N, size_t M, Real x0) 
-{
-  filename_ = "";
-  blocksize_ = 0;
-  mean_y_ = 0.0;
-  variance_y_ = 0.0;
-  U_.resize(M);
-  vector<Uvector>::iterator pU = U_.begin();  
-  while (pU != U_.end()) {
-    pU->newsize(N);
-    Uvector::iterator p = pU->begin();  
-    while (p != pU->end()) {
-      *(p++) = x0;
+/// end of the longest number at p (data_lex.l: {number}); p if none
+static const char*
+scan_number(const char* p, const char* end) {
+  const char* q = p;
+  if ((q < end) && ((*q == '-') || (*q == '+'))) {
+    ++q;
+  }
+  const char* digits = q;
+  while ((q < end) && isdigit((unsigned char)*q)) {
+    ++q;
+  }
+  if (q > digits) { // / {dig}+ (\.{dig}*)?
+    if ((q < end) && (*q == '.')) {
+      ++q;
+      while ((q < end) && isdigit((unsigned char)*q)) {
+	++q;
+      }
     }
-    ++pU;
   }
-  y_.resize(M);
-  vector<Real>::iterator py = y_.begin();
-  while (py != y_.end()) {
-    *(py++) = x0;
+  else if ((q + 1 < end) && (*q == '.')
+	   && isdigit((unsigned char)q[1])) { // / \.{dig}+
+    q += 2;
+    while ((q < end) && isdigit((unsigned char)*q)) {
+      ++q;
+    }
   }
-  scale_factor_.resize(N+1, 1.0);
-  scale_shift_.resize(N+1, 0.0);
+  else {
+    return p;
+  }
+  if ((q < end) && ((*q == 'e') || (*q == 'E'))) { // / ([eE][-+]?{dig}+)?
+    const char* e = q + 1;
+    if ((e < end) && ((*e == '-') || (*e == '+'))) {
+      ++e;
+    }
+    if ((e < end) && isdigit((unsigned char)*e)) {
+      while ((e < end) && isdigit((unsigned char)*e)) {
+	++e;
+      }
+      q = e;
+    }
+  }
+  return q;
 }
 
-
-void
-Data::load(char* filename) throw (Error)
-{
-  filename_ = (string)filename;
-  if (filename == NULL) {
-    return;
+/// end of the longest name at p (data_lex.l: {name}); p if none
+static const char*
+scan_name(const char* p, const char* end) {
+  if ((p == end) || ! (isalnum((unsigned char)*p) || (*p == '$'))) {
+    return p;
   }
-  ifstream file(filename);
-  if (file == NULL) {
-    throw FileOpenError(filename);
+  const char* q = p + 1;
+  while ((q < end) && (isalnum((unsigned char)*q) || (*q == '_') || (*q == '.') 
+		       || (*q == '-') || (*q == '/') || (*q == '$'))) {
+    ++q;
   }
+  return q;
+}
 
-  int n_columns = 0;
-  int n_rows = 0;
-  int column = 0;
-  list<Real> patternvalues;
-  list<Real> shiftvalues;
-  list<Real> factorvalues;
-  data_FlexLexer* lexer = new data_FlexLexer(&file);
-  int token;
-  size_t blockline = 0;
-  int equal_blocksizes = 1;
+
+int
+DataScanner::next(void) {
+  /// the directives of data_lex.l; comments extend to the end of the line
+  static const struct { const char* text; int token; } directives[] = {
+    { "##shift:", T_DATA_SCALE_SHIFT },
+    { "##factor:", T_DATA_SCALE_FACTOR },
+    { "##comment:", T_DATA_COMMENT },
+    { "##source:", T_DATA_COMMENT },
+    { "##dynamics:", T_DATA_COMMENT },
+    { "##rows:", T_DATA_COMMENT },
+    { "##columns:", T_DATA_COMMENT },
+    { "##names:", T_DATA_COMMENT },
+    { "# ", T_DATA_COMMENT } };
+  for (;;) {
+    if ((p_ == end_) && ! fill()) {
+      return T_DATA_EOF;
+    }
+    const char* q = data_ + p_;
+    const char* end = data_ + end_;
+    if ((*q == ' ') || (*q == '\t')) {
+      ++p_;
+      continue;
+    }
+    if (*q == '\n') {
+      ++p_;
+      ++lineno_;
+      return T_DATA_NEWLINE;
+    }
+    if (*q == '#') {
+      for (size_t k = 0; k < sizeof(directives) / sizeof(directives[0]); ++k) {
+	size_t n = strlen(directives[k].text);
+	if (((size_t)(end - q) >= n) 
+	    && (strncmp(q, directives[k].text, n) == 0)) {
+	  p_ += n;
+	  if (directives[k].token == T_DATA_COMMENT) {
+	    while ((p_ < end_) && (data_[p_] != '\n')) {
+	      ++p_;
+	    }
+	  }
+	  return directives[k].token;
+	}
+      }
+    }
+    // /// longest match; a number before a name of the same length
+    const char* number_end = scan_number(q, end);
+    const char* name_end = scan_name(q, end);
+    if ((number_end > q) && (number_end >= name_end)) {
+      value_ = (Real)fast_atof(q, number_end);
+      p_ += number_end - q;
+      return T_DATA_NUMBER;
+    }
+    const char* error_end = q + 1;
+    if (name_end > q) {
+      error_end = name_end;
+    }
+    else if (*q == '"') { // / {string}
+      const char* e = q + 1;
+      while ((e < end) && (*e != '"') && (*e != '\n')) {
+	++e;
+      }
+      if ((e < end) && (*e == '"')) {
+	error_end = e + 1;
+      }
+    }
+    text_.assign(q, error_end);
+    p_ += error_end - q;
+    return T_DATA_ERROR;
+  }
+}
+
+
+/** Parser of text data files: the rows of numbers, the blocksize 
+ * (blank lines), and the scale (##shift: and ##factor: lines).
+ * Used by Data::load() and, chunk by chunk, by DataReader. 
+ * Data::load() may split the file into ranges of whole lines, parse 
+ * them concurrently, and append() the parsers in the order of the ranges.
+ * @memo parser of text data files
+ */
+class DataParser
+{
+protected:
+  string filename_;
+  DataScanner scanner_;
   enum states { UNDEFD_STATE, PATTERNLINE, SHIFTLINE, FACTORLINE };
-  states state = PATTERNLINE;
+  states state_;
+  int n_columns_;
+  int column_;
+  size_t n_rows_;
+  size_t blockline_;
+  int equal_blocksizes_;
+  size_t blocksize_;
+  /// last number of the current row
+  Real last_value_;
+  vector<Real> shiftvalues_;
+  vector<Real> factorvalues_;
+  /// a range behind the file's start: its first block continues the 
+  /// previous range's last one, so the first blank line only sets 
+  /// head_rows_, the rows before it (see append())
+  bool continued_;
+  bool blank_seen_;
+  size_t head_rows_;
+  /// a blank line ends a block of rows: check for equal blocksizes
+  void end_block(size_t rows);
+public:
+  DataParser(FILE* file, const string& filename)
+    : filename_(filename), scanner_(file), state_(PATTERNLINE), 
+      n_columns_(0), column_(0), n_rows_(0), blockline_(0), 
+      equal_blocksizes_(1), blocksize_(0), last_value_(0.0), 
+      continued_(false), blank_seen_(false), head_rows_(0) { }
+  /// parser of the whole lines [begin, end) of the file filename; 
+  /// continued for a range behind the file's start
+  DataParser(const char* begin, const char* end, const string& filename, 
+	     bool continued)
+    : filename_(filename), scanner_(begin, end), state_(PATTERNLINE), 
+      n_columns_(0), column_(0), n_rows_(0), blockline_(0), 
+      equal_blocksizes_(1), blocksize_(0), last_value_(0.0), 
+      continued_(continued), blank_seen_(false), head_rows_(0) { }
+  /** Parse the next (at most) n_rows rows. 
+   * Appends the rows' values to values and adds their y values to sum_y
+   * (either may be NULL). With file_size > 0, values reserves space 
+   * for the rows of a file of this size.
+   * @return the number of rows parsed, 0 at the end of the file
+   * @memo parse the next rows
+   */
+  size_t parse(size_t n_rows, vector<Real>* values, Real* sum_y, 
+	       uint64_t file_size) throw (Error);
+  /// number of columns
+  int n_columns(void) const { return n_columns_; }
+  /// number of rows parsed
+  size_t n_rows(void) const { return n_rows_; }
+  /// blocksize of the rows parsed (0 for unequal blocks)
+  size_t blocksize(void) const { return blocksize_; }
+  /// the file's scale; without ##shift: and ##factor: lines, resizes 
+  /// factor to 1.0 and shift to 0.0
+  void scale(vector<Real>& factor, vector<Real>& shift) const throw (Error);
+  /** Append the parser of the next range of the file, as if this parser 
+   * had parsed on into it.
+   * @return false if the range's rows have another number of columns
+   * @memo append the parser of the next range
+   */
+  bool append(const DataParser& range);
+};
 
-  blocksize_ = 0;
-  mean_y_ = 0.0;
-  variance_y_ = 0.0;
 
+void
+DataParser::end_block(size_t rows) {
+  if (equal_blocksizes_) {
+    if (blocksize_ == 0) { // / set initial blocksize
+      blocksize_ = rows;
+    }
+    else { // / check for equal blocksize
+      if ( (rows > 0) && (blocksize_ != rows) ) {
+	equal_blocksizes_ = 0; 
+	blocksize_ = 0;
+      }
+    }
+  }
+  blockline_ = 0;
+}
+
+
+size_t
+DataParser::parse(size_t n_rows, vector<Real>* values, Real* sum_y, 
+		  uint64_t file_size) throw (Error) {
+  size_t n_parsed = 0;
+  int token;
   do {
-    token=lexer->yylex();
+    token = scanner_.next();
     switch (token) {
     case T_DATA_COMMENT:
       break;
     case T_DATA_NUMBER:
-      if (state == PATTERNLINE) {
-	patternvalues.push_back(atof(lexer->YYText()));
-	++column;
+      if (state_ == PATTERNLINE) {
+	last_value_ = scanner_.value();
+	if (values != NULL) {
+	  values->push_back(last_value_);
+	}
+	++column_;
       }
-      else if (state == SHIFTLINE) {
-	shiftvalues.push_back(atof(lexer->YYText()));
+      else if (state_ == SHIFTLINE) {
+	shiftvalues_.push_back(scanner_.value());
       }
-      else if (state == FACTORLINE) {
-	factorvalues.push_back(atof(lexer->YYText()));
+      else if (state_ == FACTORLINE) {
+	factorvalues_.push_back(scanner_.value());
       }
       else { 
 	assert(1==0); // invalid state
       }
       break;
     case T_DATA_NEWLINE:
-      if ((state == PATTERNLINE) && (column > 0)) { 
+      if ((state_ == PATTERNLINE) && (column_ > 0)) { 
 	/// / i.e., one row scanned (containing numbers)
-	if (n_rows == 0) {
-	  /// first row
-	  n_columns = column;
+	if (n_rows_ == 0) {
+	  /// first row; reserve the values of the rows of this size
+	  n_columns_ = column_;
+	  if ((values != NULL) && (file_size > 0) 
+	      && (scanner_.position() > 0)) {
+	    values->reserve((size_t)n_columns_ * 
+			    (size_t)(file_size / scanner_.position() + 1));
+	  }
 	}
 	else {
 	  /// n_rows > 0
-	  if (column != n_columns) {
-	    string msg = "parse error in input file `" + (string)filename \
-	      + "': line " + itos(lexer->lineno()) \
+	  if (column_ != n_columns_) {
+	    string msg = "parse error in input file `" + filename_ \
+	      + "': line " + itos(scanner_.lineno()) \
 	      + ": number of columns not equal in each row!";
 	    throw Error(msg);
 	  }
 	}
-	++blockline;
-	++n_rows;
-	column = 0;
+	if (sum_y != NULL) {
+	  *sum_y += last_value_;
+	}
+	++blockline_;
+	++n_rows_;
+	column_ = 0;
+	if (++n_parsed == n_rows) {
+	  return n_parsed;
+	}
       }
-      else if (state == PATTERNLINE) {
+      else if (state_ == PATTERNLINE) {
 	/// / i.e., empty line scanned
-	if (equal_blocksizes) {
-	  if (blocksize_ == 0) { // / set initial blocksize
-	    blocksize_ = blockline;
-	  }
-	  else { // / check for equal blocksize
-	    if ( (blockline > 0) && (blocksize_ != blockline) ) {
-	      equal_blocksizes = 0; 
-	      blocksize_ = 0;
-	    }
-	  }
-	  blockline = 0;
+	if (continued_ && ! blank_seen_) {
+	  blank_seen_ = true;
+	  head_rows_ = blockline_;
+	  blockline_ = 0;
+	}
+	else {
+	  end_block(blockline_);
 	}
       }
-      else if (state == SHIFTLINE) {
-	state = PATTERNLINE;
+      else if (state_ == SHIFTLINE) {
+	state_ = PATTERNLINE;
       }
-      else if (state == FACTORLINE) {
-	state = PATTERNLINE;
+      else if (state_ == FACTORLINE) {
+	state_ = PATTERNLINE;
       }
       else {
 	assert(1==0);
       }
       break;
     case T_DATA_SCALE_SHIFT:
-      state = SHIFTLINE;
+      state_ = SHIFTLINE;
       break;
     case T_DATA_SCALE_FACTOR:
-      state = FACTORLINE;
+      state_ = FACTORLINE;
       break;
     case T_DATA_ERROR: 
       {
-	string msg = "parse error in input file `" + (string)filename \
-	  + "': line " + itos(lexer->lineno()) + ": lex error at `" \
-	  + (string)lexer->YYText() + "'.";
+	string msg = "parse error in input file `" + filename_ \
+	  + "': line " + itos(scanner_.lineno()) + ": lex error at `" \
+	  + scanner_.text() + "'.";
 	throw Error(msg);
       }
       break;
@@ -222,64 +496,1055 @@ Data::load(char* filename) throw (Error)
       }
     } /// end switch(token)
   } while((token != T_DATA_EOF) && (token != T_DATA_ERROR));
-  file.close();
-  if (n_columns < 1) {
-    string msg = "error in input file `" + (string)filename \
-      + "': n_columns < 1!";
-    throw Error(msg);
+  return n_parsed;
+}
+
+
+void
+DataParser::scale(vector<Real>& factor, vector<Real>& shift) const 
+  throw (Error) {
+  if ((shiftvalues_.size() > 0) || (factorvalues_.size() > 0)) {
+    if (shiftvalues_.size() != (unsigned int)n_columns_) {
+      string msg = "error in input file `" + filename_ \
+	+ "': no. of shift values != n_columns!";
+      throw Error(msg);
+    }
+    if (factorvalues_.size() != (unsigned int)n_columns_) {
+      string msg = "error in input file `" + filename_ \
+	+ "': no. of factor values != n_columns!";
+      throw Error(msg);
+    }
+    factor.resize(n_columns_);
+    shift.resize(n_columns_);
+    copy(factorvalues_.begin(), factorvalues_.end(), factor.begin());
+    copy(shiftvalues_.begin(), shiftvalues_.end(), shift.begin());
   }
-  // /// save patternvalues in data matrix
-  U_.resize(n_rows);
-  y_.resize(n_rows);
-  list<Real>::const_iterator pl = patternvalues.begin();
-  vector<Uvector>::iterator pU = U_.begin();  
+  else {
+    factor.resize(n_columns_, 1.0);
+    shift.resize(n_columns_, 0.0);
+  }
+}
+
+
+bool
+DataParser::append(const DataParser& range) {
+  if (range.n_rows_ > 0) {
+    if (n_rows_ == 0) {
+      n_columns_ = range.n_columns_;
+    }
+    else if (range.n_columns_ != n_columns_) {
+      return false;
+    }
+  }
+  n_rows_ += range.n_rows_;
+  if (range.blank_seen_) {
+    // /// the block across the boundary, then the range's (equal) blocks
+    end_block(blockline_ + range.head_rows_);
+    if (! range.equal_blocksizes_) {
+      equal_blocksizes_ = 0;
+      blocksize_ = 0;
+    }
+    else if (range.blocksize_ > 0) {
+      end_block(range.blocksize_);
+    }
+    blockline_ = range.blockline_;
+  }
+  else {
+    blockline_ += range.blockline_;
+  }
+  shiftvalues_.insert(shiftvalues_.end(), range.shiftvalues_.begin(), 
+		      range.shiftvalues_.end());
+  factorvalues_.insert(factorvalues_.end(), range.factorvalues_.begin(), 
+		       range.factorvalues_.end());
+  return true;
+}
+
+
+std::ostream& operator<<(std::ostream &strm, const vector<Real> &v) {
+  vector<Real>::const_iterator p = v.begin();
+  while (p != v.end()) {
+    strm << *(p++) << " ";
+  }
+  return strm;
+}
+
+std::ostream& operator<<(std::ostream &strm, const Uvector &v) {
+  size_t N=v.dim();
+  for (size_t i=0; i<N; i++)
+    strm << v[i] << " ";
+  // strm << endl;
+  return strm;
+}
+
+
+std::ostream& operator<<(std::ostream &strm, const Urow &v) {
+  size_t N=v.dim();
+  for (size_t i=0; i<N; i++)
+    strm << v[i] << " ";
+  return strm;
+}
+
+
+/*
+ * ********** u-part matrix
+ */
+
+/// alignment of the rows and of the columns in bytes
+static const size_t umatrix_alignment = 64;
+
+/// n Reals aligned to umatrix_alignment (NULL for n = 0)
+static Real*
+allocate_reals(size_t n) {
+  if (n == 0) {
+    return NULL;
+  }
+  void* p = NULL;
+#ifndef WIN2017
+  if (posix_memalign(&p, umatrix_alignment, n * sizeof(Real)) != 0) {
+    p = NULL;
+  }
+#else
+  p = _aligned_malloc(n * sizeof(Real), umatrix_alignment);
+#endif
+  if (p == NULL) {
+    throw std::bad_alloc();
+  }
+  return (Real*)p;
+}
+
+
+/// release Reals of allocate_reals()
+static void
+free_reals(Real* p) {
+#ifndef WIN2017
+  free(p);
+#else
+  _aligned_free(p);
+#endif
+}
+
+
+/** The size bytes of file, read only: mapped shared, so processes that
+ * map the same file share its pages; for WIN2017 (no mmap()) read into
+ * memory aligned to umatrix_alignment, and the position of file is kept
+ * (a text mode file with CRLF line ends reads less than size bytes and
+ * fails).
+ * @return NULL on failure
+ * @memo map a file
+ */
+static void*
+map_file(FILE* file, size_t size) {
+#ifndef WIN2017
+  void* map = mmap(NULL, size, PROT_READ, MAP_SHARED, fileno(file), 0);
+  return (map == MAP_FAILED) ? NULL : map;
+#else
+  Real* buffer = allocate_reals((size + sizeof(Real) - 1) / sizeof(Real));
+  __int64 position = _ftelli64(file);
+  bool ok = (_fseeki64(file, 0, SEEK_SET) == 0) 
+    && (fread(buffer, 1, size, file) == size);
+  _fseeki64(file, position, SEEK_SET);
+  if (! ok) {
+    free_reals(buffer);
+    return NULL;
+  }
+  return buffer;
+#endif
+}
+
+
+/// release the size bytes of map_file()
+static void
+unmap_file(void* map, size_t size) {
+#ifndef WIN2017
+  munmap(map, size);
+#else
+  free_reals((Real*)map);
+#endif
+}
+
+
+Umatrix::Umatrix(size_t n_rows, Subscript udim, Real x0) 
+  : data_(NULL), size_(0), udim_(0), columns_(NULL), mirror_(false),
+    by_columns_(false), map_(NULL), map_size_(0) {
+  newsize(n_rows, udim);
+  fill(data_, data_ + size_ * udim_, x0);
+}
+
+
+Umatrix::Umatrix(const Umatrix& U) 
+  : data_(NULL), size_(0), udim_(0), columns_(NULL), mirror_(false),
+    by_columns_(false), map_(NULL), map_size_(0) {
+  *this = U;
+}
+
+
+Umatrix::~Umatrix() {
+  free_reals(data_);
+  release_columns();
+}
+
+
+void
+Umatrix::release_columns() {
+  if (map_ != NULL) {
+    unmap_file(map_, map_size_);
+    map_ = NULL;
+    map_size_ = 0;
+  }
+  else {
+    free_reals(columns_);
+  }
+  columns_ = NULL;
+}
+
+
+void
+Umatrix::make_rows() {
+  assert(by_columns_);
+  data_ = allocate_reals(size_ * udim_);
+  /// transpose block by block of rows, for the cache
+  const size_t block = 256;
+  for (size_t begin = 0; begin < size_; begin += block) {
+    size_t end = (begin + block < size_) ? begin + block : size_;
+    for (Subscript k = 0; k < udim_; ++k) {
+      const Real* pcolumn = columns_ + offset_[k];
+      Real* pu = data_ + begin * udim_ + k;
+      for (size_t i = begin; i < end; ++i, pu += udim_) {
+	*pu = pcolumn[i];
+      }
+    }
+  }
+  release_columns();
+  offset_.clear();
+  by_columns_ = false;
+}
+
+
+Umatrix& 
+Umatrix::operator=(const Umatrix& U) {
+  if (this == &U) {
+    return *this;
+  }
+  if (U.by_columns_) {
+    /// the span of the columns, from the aligned start of the first 
+    /// one on, so the columns keep their alignment
+    free_reals(data_);
+    data_ = NULL;
+    release_columns();
+    size_ = U.size_;
+    udim_ = U.udim_;
+    offset_ = U.offset_;
+    mirror_ = false;
+    by_columns_ = true;
+    size_t first = 0;
+    size_t n_reals = 0;
+    if ((size_ > 0) && (udim_ > 0)) {
+      const size_t per_alignment = umatrix_alignment / sizeof(Real);
+      first = *min_element(offset_.begin(), offset_.end()) 
+	/ per_alignment * per_alignment;
+      n_reals = *max_element(offset_.begin(), offset_.end()) + size_ 
+	- first;
+    }
+    for (Subscript k = 0; k < udim_; ++k) {
+      offset_[k] -= first;
+    }
+    columns_ = allocate_reals(n_reals);
+    copy(U.columns_ + first, U.columns_ + first + n_reals, columns_);
+    return *this;
+  }
+  newsize(U.size_, U.udim_);
+  copy(U.data_, U.data_ + size_ * udim_, data_);
+  if (U.mirror_) {
+    mirror_columns();
+  }
+  return *this;
+}
+
+
+void
+Umatrix::newsize(size_t n_rows, Subscript udim) {
+  assert(udim >= 0);
+  release_columns();
+  offset_.clear();
+  mirror_ = false;
+  by_columns_ = false;
+  if ((data_ == NULL) || (n_rows * udim != size_ * udim_)) {
+    free_reals(data_);
+    data_ = allocate_reals(n_rows * udim);
+  }
+  size_ = n_rows;
+  udim_ = udim;
+}
+
+
+void
+Umatrix::mirror_columns() {
+  if (by_columns_) {
+    return;
+  }
+  release_columns();
+  /// every column aligned
+  const size_t per_alignment = umatrix_alignment / sizeof(Real);
+  size_t stride = (size_ + per_alignment - 1) / per_alignment * per_alignment;
+  offset_.resize(udim_);
+  for (Subscript k = 0; k < udim_; ++k) {
+    offset_[k] = k * stride;
+  }
+  mirror_ = true;
+  columns_ = allocate_reals(udim_ * stride);
+  /// transpose block by block of rows, for the cache
+  const size_t block = 256;
+  for (size_t begin = 0; begin < size_; begin += block) {
+    size_t end = (begin + block < size_) ? begin + block : size_;
+    for (Subscript k = 0; k < udim_; ++k) {
+      Real* pcolumn = columns_ + offset_[k];
+      const Real* pu = data_ + begin * udim_ + k;
+      for (size_t i = begin; i < end; ++i, pu += udim_) {
+	pcolumn[i] = *pu;
+      }
+    }
+  }
+}
+
+
+Real*
+Umatrix::allocate_columns(size_t n_rows, const vector<size_t>& offset, 
+			  size_t n_reals) {
+  free_reals(data_);
+  data_ = NULL;
+  release_columns();
+  size_ = n_rows;
+  udim_ = offset.size();
+  offset_ = offset;
+  mirror_ = false;
+  by_columns_ = true;
+  columns_ = allocate_reals(n_reals);
+  return columns_;
+}
+
+
+void
+Umatrix::map_columns(size_t n_rows, Subscript udim, void* map, 
+		     size_t map_size, size_t first, size_t stride) {
+  assert(udim >= 0);
+  free_reals(data_);
+  data_ = NULL;
+  release_columns();
+  size_ = n_rows;
+  udim_ = udim;
+  map_ = map;
+  map_size_ = map_size;
+  columns_ = (Real*)map;
+  offset_.resize(udim_);
+  for (Subscript k = 0; k < udim_; ++k) {
+    offset_[k] = first + k * stride;
+  }
+  mirror_ = false;
+  by_columns_ = true;
+}
+
+
+/*
+ * ********** data
+ */
+
+/// mean and variance of y[first, first + n_rows)
+static void
+y_statistics(const vector<Real>& y, size_t first, size_t n_rows, 
+	     Real& mean, Real& variance) {
+  mean = 0.0;
+  variance = 0.0;
+  if (n_rows > 0) {
+    for (size_t i = first; i < first + n_rows; ++i) {
+      mean += y[i];
+    }
+    mean /= (Real)n_rows;
+    for (size_t i = first; i < first + n_rows; ++i) {
+      Real difference = y[i] - mean;
+      variance += difference * difference;
+    }
+    variance /= (Real)n_rows;
+  }
+}
+
+
+std::ostream& operator << (std::ostream& strm, const Data& d) {
+  strm << "### filename: \"" << d.filename_ << "\"\n";
+  Umatrix::const_iterator pU = d.U_.begin();
+  vector<Real>::const_iterator py = d.y_.begin();
+  size_t blockline = 0;
+  while (pU != d.U_.end()) {
+    strm << *(pU++);
+    strm << *(py++) << endl;
+    if (++blockline == d.blocksize()) {
+      strm << endl;
+      blockline = 0;
+    }
+  }
+  return strm;
+}
+
+
+Data::Data(Subscript N, size_t M, Real x0) 
+{
+  filename_ = "";
+  blocksize_ = 0;
+  mean_y_ = 0.0;
+  variance_y_ = 0.0;
+  U_.newsize(M, N);
+  fill(U_.data(), U_.data() + M * N, x0);
+  y_.resize(M);
   vector<Real>::iterator py = y_.begin();
-  while (pU != U_.end()) {
-    pU->newsize(n_columns-1);
-    Uvector::iterator p = pU->begin();  
-    while (p != pU->end()) {
-      *(p++) = *(pl++);
+  while (py != y_.end()) {
+    *(py++) = x0;
+  }
+  scale_factor_.resize(N+1, 1.0);
+  scale_shift_.resize(N+1, 0.0);
+}
+
+
+/*
+ * ********** binary data files
+ */
+
+/// header of a binary data file (see write_binary_data())
+struct BinaryDataHeader {
+  char magic[8];
+  uint32_t version;
+  uint32_t real_size;
+  uint64_t n_rows;
+  uint64_t n_columns;
+  uint64_t blocksize;
+  double mean_y;
+  double variance_y;
+  /// file offset of the first column
+  uint64_t data_offset;
+  /// bytes from one column to the next
+  uint64_t column_stride;
+};
+
+static const char binary_data_magic[8] = { 'F','Z','Y','D','A','T','A','\0' };
+static const uint32_t binary_data_version = 1;
+/// alignment of the columns
+static const size_t binary_data_alignment = 64;
+
+static size_t 
+align(size_t n) {
+  return (n + binary_data_alignment - 1) / binary_data_alignment 
+    * binary_data_alignment;
+}
+
+/// file starts with the magic of a binary data file; rewinds file
+static bool
+is_binary_data(FILE* file) {
+  char magic[sizeof(binary_data_magic)];
+  size_t n = fread(magic, 1, sizeof(magic), file);
+  rewind(file);
+  return (n == sizeof(magic)) 
+    && (memcmp(magic, binary_data_magic, sizeof(magic)) == 0);
+}
+
+
+/// fseek() to offset, also beyond 2 GB on 32 bit systems
+static int
+seek_file(FILE* file, uint64_t offset) {
+#ifndef WIN2017
+  return fseeko(file, (off_t)offset, SEEK_SET);
+#else
+  return _fseeki64(file, (__int64)offset, SEEK_SET);
+#endif
+}
+
+
+/// size of file in bytes, also beyond 2 GB on 32 bit systems (0 on 
+/// failure); rewinds file
+static uint64_t
+file_size(FILE* file) {
+#ifndef WIN2017
+  off_t size = (fseeko(file, 0, SEEK_END) == 0) ? ftello(file) : -1;
+#else
+  __int64 size = (_fseeki64(file, 0, SEEK_END) == 0) ? _ftelli64(file) : -1;
+#endif
+  rewind(file);
+  return (size < 0) ? 0 : (uint64_t)size;
+}
+
+
+/// a file of size bytes fits into the address space (see map_file())
+static bool
+is_mappable(uint64_t size) {
+  return size <= (uint64_t)PTRDIFF_MAX;
+}
+
+
+/// reopen the binary data file filename, opened as file, in binary mode
+/// (for WIN2017, where text mode translates line ends)
+static FILE*
+reopen_binary(const char* filename, FILE* file) throw (Error) {
+  file = freopen(filename, "rb", file);
+  if (file == NULL) {
+    throw FileOpenError(filename);
+  }
+  return file;
+}
+
+
+void
+write_binary_data(const string& filename, const Umatrix& U,
+		  const vector<Real>& y, size_t first, size_t n_rows,
+		  size_t blocksize, const vector<Real>& scale_factor,
+		  const vector<Real>& scale_shift) throw (Error) {
+  assert(first + n_rows <= U.size());
+  assert(U.size() == y.size());
+  size_t n_columns = scale_factor.size();
+  assert(scale_shift.size() == n_columns);
+  assert((n_rows == 0) || ((size_t)U[first].size() + 1 == n_columns));
+  BinaryDataHeader header;
+  memset(&header, 0, sizeof(header));
+  memcpy(header.magic, binary_data_magic, sizeof(header.magic));
+  header.version = binary_data_version;
+  header.real_size = sizeof(Real);
+  header.n_rows = n_rows;
+  header.n_columns = n_columns;
+  // /// the block size Data::load() finds in the text file: blank lines 
+  // /// follow complete blocks only
+  header.blocksize = (n_rows >= blocksize) ? blocksize : 0;
+  // /// mean and variance of y, computed as by Data::load()
+  Real mean_y;
+  Real variance_y;
+  y_statistics(y, first, n_rows, mean_y, variance_y);
+  header.mean_y = mean_y;
+  header.variance_y = variance_y;
+  header.data_offset = align(sizeof(header) + 2 * n_columns * sizeof(Real));
+  header.column_stride = align(n_rows * sizeof(Real));
+  FILE* file = fopen(filename.c_str(), "wb");
+  if (file == NULL) {
+    throw FileOpenError(filename);
+  }
+  bool ok = (fwrite(&header, sizeof(header), 1, file) == 1);
+  ok = ok && (fwrite(&scale_shift[0], sizeof(Real), n_columns, file) 
+	      == n_columns);
+  ok = ok && (fwrite(&scale_factor[0], sizeof(Real), n_columns, file) 
+	      == n_columns);
+  // /// the columns, zero padded
+  vector<Real> column(header.column_stride / sizeof(Real), 0.0);
+  vector<char> padding(binary_data_alignment, 0);
+  size_t position = sizeof(header) + 2 * n_columns * sizeof(Real);
+  ok = ok && (fwrite(&padding[0], 1, header.data_offset - position, file) 
+	      == header.data_offset - position);
+  for (size_t j = 0; ok && (j < n_columns); ++j) {
+    for (size_t i = 0; i < n_rows; ++i) {
+      column[i] = (j + 1 < n_columns) ? U[first + i][j] : y[first + i];
     }
-    ++pU;
-    *(py++) = *(pl++);
+    ok = (fwrite(&column[0], sizeof(Real), column.size(), file) 
+	  == column.size());
   }
-  // save shift and factor values in data object
-  if ((shiftvalues.size() > 0) || (factorvalues.size() > 0)) {
-    if (shiftvalues.size() != (unsigned int)n_columns) {
-      string msg = "error in input file `" + (string)filename \
-	+ "': no. of shift values != n_columns!";
-      throw Error(msg);
+  if ((fclose(file) != 0) || ! ok) {
+    throw Error("error writing binary data file `" + filename + "'!");
+  }
+}
+
+
+/// read and check the header of the binary data file filename, opened
+/// as file; returns the file size
+static uint64_t
+read_binary_header(const char* filename, FILE* file, BinaryDataHeader& header)
+  throw (Error) {
+  string error = "error in binary data file `" + (string)filename + "': ";
+  uint64_t size = file_size(file);
+  if ((size < sizeof(header)) 
+      || (fread(&header, sizeof(header), 1, file) != 1)) {
+    throw Error(error + "incomplete header!");
+  }
+  if (header.version != binary_data_version) {
+    throw Error(error + "unknown version " + itos(header.version) + "!");
+  }
+  if (header.real_size != sizeof(Real)) {
+    throw Error(error + "written with sizeof(Real) = " 
+		+ itos(header.real_size) + "!");
+  }
+  if ((header.n_columns < 1)
+      || (header.data_offset < sizeof(header) 
+	  + 2 * header.n_columns * sizeof(Real))
+      || (header.column_stride < header.n_rows * sizeof(Real))
+      || (header.data_offset % sizeof(Real) != 0)
+      || (header.column_stride % sizeof(Real) != 0)
+      || (size < header.data_offset 
+	  + header.n_columns * header.column_stride)) {
+    throw Error(error + "inconsistent header or truncated file!");
+  }
+  return size;
+}
+
+
+void
+Data::load_binary(const char* filename, FILE* file) throw (Error) {
+  string error = "error in binary data file `" + (string)filename + "': ";
+  BinaryDataHeader header;
+  uint64_t size = read_binary_header(filename, file, header);
+  if (! is_mappable(size)) {
+    throw Error(error + "file too large to map on this system!");
+  }
+  size_t map_size = (size_t)size;
+  size_t n_rows = header.n_rows;
+  size_t n_columns = header.n_columns;
+  void* map = map_file(file, map_size);
+  if (map == NULL) {
+    throw Error(error + "cannot map the file!");
+  }
+  const char* data = (const char*)map;
+  const Real* shift = (const Real*)(data + sizeof(header));
+  const Real* factor = shift + n_columns;
+  scale_shift_.assign(shift, shift + n_columns);
+  scale_factor_.assign(factor, factor + n_columns);
+  blocksize_ = header.blocksize;
+  mean_y_ = header.mean_y;
+  variance_y_ = header.variance_y;
+  // /// y is copied; U_ reads the u-parts in place in the mapping if 
+  // /// its columns are aligned like those of Umatrix, else copies them
+  const Real* y_column = (const Real*)(data + header.data_offset 
+				       + (n_columns - 1) * header.column_stride);
+  y_.assign(y_column, y_column + n_rows);
+  if ((header.data_offset % umatrix_alignment == 0)
+      && (header.column_stride % umatrix_alignment == 0)) {
+    U_.map_columns(n_rows, n_columns - 1, map, map_size, 
+		   header.data_offset / sizeof(Real),
+		   header.column_stride / sizeof(Real));
+    return;
+  }
+  U_.newsize(n_rows, n_columns - 1);
+  for (size_t j = 0; j + 1 < n_columns; ++j) {
+    const Real* column = 
+      (const Real*)(data + header.data_offset + j * header.column_stride);
+    Real* pu = U_.data() + j;
+    for (size_t i = 0; i < n_rows; ++i, pu += n_columns - 1) {
+      *pu = column[i];
     }
-    if (factorvalues.size() != (unsigned int)n_columns) {
+  }
+  unmap_file(map, map_size);
+  return;
+}
+
+
+/// minimal size of the range of a text data file parsed by one thread
+static const size_t parse_range_min = 1 << 16;
+
+/** Parse the text data file filename, opened as file, on up to 
+ * GLOBAL::n_parse_threads threads: the mapped file (see map_file()) is 
+ * split into ranges of whole lines, and their parsers are appended in 
+ * order. 
+ * @return the parser of the whole file, with the values and the number
+ * of rows of each range; NULL if the file is not split or a range fails
+ * (the sequential parser then reports the error as usual)
+ * @memo parse a text data file concurrently
+ */
+static DataParser*
+parse_parallel(const char* filename, FILE* file, size_t file_size, 
+	       vector< vector<Real> >& values, vector<size_t>& rows) {
+  size_t n_ranges = file_size / parse_range_min;
+  if (n_ranges > (size_t)GLOBAL::n_parse_threads) {
+    n_ranges = GLOBAL::n_parse_threads;
+  }
+  if (n_ranges < 2) {
+    return NULL;
+  }
+  void* map = map_file(file, file_size);
+  if (map == NULL) {
+    return NULL;
+  }
+  const char* text = (const char*)map;
+  const char* end = text + file_size;
+  // /// each range starts behind a newline
+  vector<const char*> bounds(1, text);
+  for (size_t k = 1; k < n_ranges; ++k) {
+    const char* p = text + file_size / n_ranges * k;
+    if (p < bounds.back()) {
+      p = bounds.back();
+    }
+    const char* newline = (const char*)memchr(p, '\n', end - p);
+    bounds.push_back((newline != NULL) ? newline + 1 : end);
+  }
+  bounds.push_back(end);
+  vector<DataParser*> parsers(n_ranges, (DataParser*)NULL);
+  vector<int> parsed(n_ranges, 0);
+  values.assign(n_ranges, vector<Real>());
+  rows.assign(n_ranges, 0);
+#pragma omp parallel for schedule(static, 1) num_threads((int)n_ranges)
+  for (int k = 0; k < (int)n_ranges; ++k) {
+    try {
+      parsers[k] = new DataParser(bounds[k], bounds[k+1], filename, k > 0);
+      parsers[k]->parse(SIZE_MAX, &values[k], NULL, bounds[k+1] - bounds[k]);
+      rows[k] = parsers[k]->n_rows();
+      parsed[k] = 1;
+    }
+    catch(...) {
+    }
+  }
+  unmap_file(map, file_size);
+  bool ok = true;
+  for (size_t k = 0; k < n_ranges; ++k) {
+    ok = ok && parsed[k] && ((k == 0) || parsers[0]->append(*parsers[k]));
+    if (k > 0) {
+      delete parsers[k];
+    }
+  }
+  if (! ok) {
+    delete parsers[0];
+    values.clear();
+    return NULL;
+  }
+  return parsers[0];
+}
+
+
+void
+Data::load(char* filename) throw (Error)
+{
+  filename_ = (string)filename;
+  if (filename == NULL) {
+    return;
+  }
+  FILE* file = fopen(filename, "r");
+  if (file == NULL) {
+    throw FileOpenError(filename);
+  }
+  if (is_binary_data(file)) {
+    file = reopen_binary(filename, file);
+    try {
+      load_binary(filename, file);
+    }
+    catch(...) {
+      fclose(file);
+      throw;
+    }
+    fclose(file);
+    return;
+  }
+  uint64_t size = file_size(file);
+
+  // /// the values and the number of rows of each range of the file
+  vector< vector<Real> > patternvalues;
+  vector<size_t> rows;
+  DataParser* parser = NULL;
+
+  mean_y_ = 0.0;
+  variance_y_ = 0.0;
+
+  try {
+    if ((GLOBAL::n_parse_threads > 1) && is_mappable(size)) {
+      parser = parse_parallel(filename, file, (size_t)size, 
+			      patternvalues, rows);
+    }
+    if (parser == NULL) {
+      patternvalues.assign(1, vector<Real>());
+      parser = new DataParser(file, filename);
+      parser->parse(SIZE_MAX, &patternvalues[0], NULL, size);
+      rows.assign(1, parser->n_rows());
+    }
+  }
+  catch(...) {
+    delete parser;
+    fclose(file);
+    throw;
+  }
+  fclose(file);
+  int n_columns = parser->n_columns();
+  int n_rows = parser->n_rows();
+  blocksize_ = parser->blocksize();
+  try {
+    if (n_columns < 1) {
       string msg = "error in input file `" + (string)filename \
-	+ "': no. of factor values != n_columns!";
+	+ "': n_columns < 1!";
       throw Error(msg);
     }
-    scale_factor_.resize(n_columns);
-    scale_shift_.resize(n_columns);
-    copy(factorvalues.begin(), factorvalues.end(), scale_factor_.begin());
-    copy(shiftvalues.begin(), shiftvalues.end(), scale_shift_.begin());
+    // save shift and factor values in data object
+    parser->scale(scale_factor_, scale_shift_);
   }
-  else {
-    scale_factor_.resize(n_columns, 1.0);
-    scale_shift_.resize(n_columns, 0.0);
+  catch(...) {
+    delete parser;
+    throw;
+  }
+  delete parser;
+  // /// save patternvalues in data matrix, range by range; each range is
+  // /// released once copied
+  U_.newsize(n_rows, n_columns-1);
+  y_.resize(n_rows);
+  vector<size_t> first(rows.size(), 0);
+  for (size_t k = 1; k < rows.size(); ++k) {
+    first[k] = first[k-1] + rows[k-1];
+  }
+#pragma omp parallel for schedule(static, 1) num_threads((int)rows.size())
+  for (int k = 0; k < (int)rows.size(); ++k) {
+    vector<Real>::const_iterator pl = patternvalues[k].begin();
+    Real* p = U_.data() + first[k] * (n_columns-1);
+    vector<Real>::iterator py = y_.begin() + first[k];
+    for (size_t i = 0; i < rows[k]; ++i) {
+      p = copy(pl, pl + (n_columns-1), p);
+      pl += n_columns-1;
+      *(py++) = *(pl++);
+    }
+    vector<Real>().swap(patternvalues[k]);
   }
   
   // /// compute mean_y_ and variance_y_
-  if (n_rows > 0) {
-    py = y_.begin();
-    while (py != y_.end()) {
-      mean_y_ += *(py++);
+  y_statistics(y_, 0, n_rows, mean_y_, variance_y_);
+  return;
+}
+
+
+void
+Data::assign(const string& filename, const Umatrix& U, 
+	     const vector<Real>& y, size_t first, size_t n_rows, 
+	     size_t blocksize, const vector<Real>& scale_factor,
+	     const vector<Real>& scale_shift) {
+  assert(first + n_rows <= U.size());
+  assert(U.size() == y.size());
+  assert((size_t)U.udim() + 1 == scale_factor.size());
+  filename_ = filename;
+  U_.newsize(n_rows, U.udim());
+  Umatrix::const_iterator pU = U.begin() + first;
+  Umatrix::iterator pU_ = U_.begin();
+  for (size_t i = 0; i < n_rows; ++i, ++pU, ++pU_) {
+    copy(pU->begin(), pU->end(), pU_->begin());
+  }
+  y_.assign(y.begin() + first, y.begin() + first + n_rows);
+  // /// as write_binary_data() and load() do
+  blocksize_ = (n_rows >= blocksize) ? blocksize : 0;
+  scale_factor_ = scale_factor;
+  scale_shift_ = scale_shift;
+  y_statistics(y_, 0, n_rows, mean_y_, variance_y_);
+}
+
+
+void
+Data::assign_lags(const string& filename, const Data& a, 
+		  const vector<int>& dynamic_orders, bool ut_regressor,
+		  size_t first, size_t n_rows) {
+  size_t n_signals = a.udim() + 1;
+  assert(dynamic_orders.size() == n_signals);
+  size_t max_order = *max_element(dynamic_orders.begin(), 
+				  dynamic_orders.end());
+  assert(first + max_order + n_rows <= a.y().size());
+  filename_ = filename;
+  // /// the copy of signal s holds its n_rows + d_s - 1 values from 
+  // /// t = first + max_order - d_s on; the column of lag l starts at 
+  // /// d_s - l in it, and the one of lag 1 is aligned
+  const size_t per_alignment = umatrix_alignment / sizeof(Real);
+  vector<size_t> offset;
+  vector<size_t> start(n_signals, 0);
+  size_t n_reals = 0;
+  for (size_t s = 0; s < n_signals; ++s) {
+    size_t d = dynamic_orders[s];
+    if (d == 0) {
+      continue;
     }
-    mean_y_ /= (Real)n_rows;
-    py = y_.begin();
-    while (py != y_.end()) {
-      Real difference = *(py++) - mean_y_;
-      variance_y_ += difference * difference;
+    size_t lag_1 = (n_reals + d - 1 + per_alignment - 1) / per_alignment 
+      * per_alignment;
+    start[s] = lag_1 - (d - 1);
+    for (size_t l = 1; l <= d; ++l) {
+      offset.push_back(start[s] + d - l);
     }
-    variance_y_ /= (Real)n_rows;
+    n_reals = start[s] + n_rows + d - 1;
   }
-  return;
+  Real* columns = U_.allocate_columns(n_rows, offset, n_reals);
+  for (size_t s = 0; s < n_signals; ++s) {
+    size_t d = dynamic_orders[s];
+    if (d == 0) {
+      continue;
+    }
+    size_t t = first + max_order - d;
+    Real* p = columns + start[s];
+    if (s + 1 < n_signals) {
+      if (ut_regressor) {
+	++t;
+      }
+      Umatrix::const_iterator pU = a.U().begin() + t;
+      for (size_t j = 0; j < n_rows + d - 1; ++j, ++pU) {
+	p[j] = (*pU)[s];
+      }
+    }
+    else {
+      copy(a.y().begin() + t, a.y().begin() + t + n_rows + d - 1, p);
+    }
+  }
+  y_.assign(a.y().begin() + first + max_order, 
+	    a.y().begin() + first + max_order + n_rows);
+  // /// the scale of each lag of each signal, then of y(t)
+  scale_factor_.clear();
+  scale_shift_.clear();
+  for (size_t s = 0; s < n_signals; ++s) {
+    scale_factor_.insert(scale_factor_.end(), (size_t)dynamic_orders[s], 
+			 a.scale_factor()[s]);
+    scale_shift_.insert(scale_shift_.end(), (size_t)dynamic_orders[s], 
+			a.scale_shift()[s]);
+  }
+  scale_factor_.push_back(a.scale_factor().back());
+  scale_shift_.push_back(a.scale_shift().back());
+  blocksize_ = (n_rows >= a.blocksize()) ? a.blocksize() : 0;
+  y_statistics(y_, 0, n_rows, mean_y_, variance_y_);
+}
+
+
+
+/*
+ * ********** sequential reader
+ */
+
+DataReader::DataReader(const char* filename, bool scan) throw (Error)
+  : filename_(filename), file_(NULL), parser_(NULL), data_offset_(0), 
+    column_stride_(0), n_rows_(0), n_columns_(0), blocksize_(0), 
+    mean_y_(0.0), row_(0), scanned_(true) {
+  file_ = fopen(filename, "r");
+  if (file_ == NULL) {
+    throw FileOpenError(filename);
+  }
+  bool binary = is_binary_data(file_);
+  if (binary) {
+    file_ = reopen_binary(filename, file_);
+  }
+  try {
+    if (binary) {
+      BinaryDataHeader header;
+      read_binary_header(filename, file_, header);
+      n_rows_ = header.n_rows;
+      n_columns_ = header.n_columns;
+      blocksize_ = header.blocksize;
+      mean_y_ = header.mean_y;
+      data_offset_ = header.data_offset;
+      column_stride_ = header.column_stride;
+      scale_shift_.resize(n_columns_);
+      scale_factor_.resize(n_columns_);
+      if ((fread(&scale_shift_[0], sizeof(Real), n_columns_, file_) 
+	   != n_columns_)
+	  || (fread(&scale_factor_[0], sizeof(Real), n_columns_, file_) 
+	      != n_columns_)) {
+	throw Error("error in binary data file `" + filename_ 
+		    + "': truncated file!");
+      }
+    }
+    else if (! scan) {
+      // /// rows and columns are counted by read()
+      n_rows_ = SIZE_MAX;
+      scanned_ = false;
+      parser_ = new DataParser(file_, filename_);
+    }
+    else {
+      // /// scan the file as Data::load() does, without keeping the rows
+      parser_ = new DataParser(file_, filename_);
+      Real sum_y = 0.0;
+      parser_->parse(SIZE_MAX, NULL, &sum_y, 0);
+      if (parser_->n_columns() < 1) {
+	string msg = "error in input file `" + filename_ \
+	  + "': n_columns < 1!";
+	throw Error(msg);
+      }
+      n_rows_ = parser_->n_rows();
+      n_columns_ = parser_->n_columns();
+      blocksize_ = parser_->blocksize();
+      parser_->scale(scale_factor_, scale_shift_);
+      if (n_rows_ > 0) {
+	mean_y_ = sum_y / (Real)n_rows_;
+      }
+    }
+    rewind();
+  }
+  catch(...) {
+    delete parser_;
+    fclose(file_);
+    throw;
+  }
+}
+
+
+DataReader::~DataReader() {
+  delete parser_;
+  fclose(file_);
+}
+
+
+void
+DataReader::rewind() throw (Error) {
+  row_ = 0;
+  if (parser_ != NULL) {
+    delete parser_;
+    parser_ = NULL;
+    fseek(file_, 0, SEEK_SET);
+    parser_ = new DataParser(file_, filename_);
+  }
+}
+
+
+bool
+DataReader::read(Data& chunk, size_t n_rows) throw (Error) {
+  assert(n_rows > 0);
+  if (row_ >= n_rows_) {
+    return false;
+  }
+  if (n_rows > n_rows_ - row_) {
+    n_rows = n_rows_ - row_;
+  }
+  if (parser_ != NULL) {
+    values_.clear();
+    size_t n_parsed = parser_->parse(n_rows, &values_, NULL, 0);
+    if (! scanned_) {
+      if (n_parsed == 0) {
+	// /// the end of the file
+	n_rows_ = row_;
+	return false;
+      }
+      n_rows = n_parsed;
+      n_columns_ = parser_->n_columns();
+      parser_->scale(scale_factor_, scale_shift_);
+    }
+    else if (n_parsed != n_rows) {
+      throw Error("error in input file `" + filename_ 
+		  + "': file changed while reading!");
+    }
+  }
+  size_t udim = n_columns_ - 1;
+  chunk.filename_ = filename_;
+  chunk.blocksize_ = blocksize_;
+  chunk.scale_factor_ = scale_factor_;
+  chunk.scale_shift_ = scale_shift_;
+  chunk.U_.newsize(n_rows, udim);
+  chunk.y_.resize(n_rows);
+  if (parser_ != NULL) {
+    // /// the rows, as by Data::load()
+    vector<Real>::const_iterator pl = values_.begin();
+    Real* p = chunk.U_.data();
+    vector<Real>::iterator py = chunk.y_.begin();
+    while (py != chunk.y_.end()) {
+      p = copy(pl, pl + udim, p);
+      pl += udim;
+      *(py++) = *(pl++);
+    }
+  }
+  else {
+    // /// the chunk's part of each column
+    column_.resize(n_rows);
+    for (size_t j = 0; j < n_columns_; ++j) {
+      uint64_t offset = data_offset_ + j * column_stride_ 
+	+ row_ * sizeof(Real);
+      if ((seek_file(file_, offset) != 0) 
+	  || (fread(&column_[0], sizeof(Real), n_rows, file_) != n_rows)) {
+	throw Error("error in binary data file `" + filename_ 
+		    + "': truncated file!");
+      }
+      if (j < udim) {
+	Real* pu = chunk.U_.data() + j;
+	for (size_t i = 0; i < n_rows; ++i, pu += udim) {
+	  *pu = column_[i];
+	}
+      }
+      else {
+	copy(column_.begin(), column_.end(), chunk.y_.begin());
+      }
+    }
+  }
+  row_ += n_rows;
+  // /// mean and variance of the chunk's y values
+  y_statistics(chunk.y_, 0, n_rows, chunk.mean_y_, chunk.variance_y_);
+  return true;
 }
 
 
@@ -292,7 +1557,7 @@ Data::normalize(const vector<Real>& factor, const vector<Real>& shift)
   if (n_rows < 1) {
     return;
   }
-  size_t n_columns = U_[0].size();
+  size_t n_columns = U_.udim();
   if (n_columns+1 != (size_t)factor.size()) {
     string msg = "different n_columns in function";
     msg += " Data::normalize(...) for factor vector!";
@@ -312,13 +1577,15 @@ Data::normalize(const vector<Real>& factor, const vector<Real>& shift)
     *(pfactor++) = *(pf++); 
     *(pshift++) = *(ps++);
   }
-  // /// normalize
-  vector<Uvector>::iterator pU = U_.begin();  
+  // /// normalize (a matrix stored by columns is copied into rows, and 
+  // /// gets their mirror)
+  bool columns = U_.has_columns();
+  Umatrix::iterator pU = U_.begin();  
   vector<Real>::iterator py = y_.begin();  
   while (py != y_.end()) {
     pfactor = scale_factor_.begin();
     pshift = scale_shift_.begin();
-    Uvector::iterator p = pU->begin();  
+    Real* p = pU->begin();  
     while (p != pU->end()) {
       *p = normalization(*p, *pfactor, *pshift);
       pshift++;
@@ -343,5 +1610,8 @@ Data::normalize(const vector<Real>& factor, const vector<Real>& shift)
     }
     variance_y_ /= (Real)n_rows;
   }
+  if (columns) {
+    U_.mirror_columns();
+  }
   return;
 }
@@ -33,11 +33,14 @@
 
 #ifndef WIN2017
 #include <vector.h>  // STL vectors
+#include <iterator.h>
 #include <vec.h>     // TNT vectors
 #else
 #include <vector>    // STL vectors
+#include <iterator>
 #include <tnt.h>     // TNT vectors
 #endif
+#include <stddef.h>
 
 
 #include "global.hh"
@@ -60,17 +63,361 @@ typedef Vector<Real> Uvector;
 std::ostream& operator<<(std::ostream &strm, const Uvector &v);
 
 
+/** View of the n elements at p, e.g., of one row of a Umatrix stored 
+ * row by row, to modify it.
+ * Like a pointer, a view is copied shallow, and a const view does not 
+ * make its elements const; the elements of a RowView<const Real> are 
+ * read only.
+ * @memo
+ */
+template <class T>
+class RowView
+{
+  T* p_;
+  Subscript n_;
+public:
+  typedef T* iterator;
+  typedef const T* const_iterator;
+  /// empty view
+  RowView() : p_(NULL), n_(0) { }
+  /// view of the n elements at p
+  RowView(T* p, Subscript n) : p_(p), n_(n) { }
+  /// view of a Uvector
+  RowView(const Uvector& v) : p_(v.begin()), n_(v.size()) { }
+  /// read only view of a view
+  template <class S>
+  RowView(const RowView<S>& v) : p_(v.begin()), n_(v.size()) { }
+  Subscript size() const { return n_; }
+  Subscript dim() const { return n_; }
+  iterator begin() const { return p_; }
+  iterator end() const { return p_ + n_; }
+  /// the view of the n elements delta elements behind p
+  RowView moved(ptrdiff_t delta) const { return RowView(p_ + delta, n_); }
+  /// element i = 0, ..., n-1
+  T& operator[](Subscript i) const { 
+    assert((i >= 0) && (i < n_)); 
+    return p_[i];
+  }
+  /// element i = 1, ..., n (as for TNT vectors)
+  T& operator()(Subscript i) const { 
+    assert((i >= 1) && (i <= n_)); 
+    return p_[i-1];
+  }
+};
+
+
+/** Random access iterator over the elements of a Urow, i.e., over 
+ * p[offset[k]] (p[k] if offset is NULL).
+ * @memo
+ */
+class UrowIterator
+{
+  const Real* p_;
+  const size_t* offset_;
+  ptrdiff_t k_;
+public:
+  typedef std::random_access_iterator_tag iterator_category;
+  typedef Real value_type;
+  typedef ptrdiff_t difference_type;
+  typedef const Real* pointer;
+  typedef const Real& reference;
+  UrowIterator() : p_(NULL), offset_(NULL), k_(0) { }
+  /// iterator at element k of the view (p, offset)
+  UrowIterator(const Real* p, const size_t* offset, ptrdiff_t k) 
+    : p_(p), offset_(offset), k_(k) { }
+  reference operator*() const { 
+    return (offset_ != NULL) ? p_[offset_[k_]] : p_[k_]; 
+  }
+  reference operator[](ptrdiff_t j) const { 
+    return (offset_ != NULL) ? p_[offset_[k_ + j]] : p_[k_ + j]; 
+  }
+  UrowIterator& operator++() { ++k_; return *this; }
+  UrowIterator& operator--() { --k_; return *this; }
+  UrowIterator operator++(int) { UrowIterator it(*this); ++k_; return it; }
+  UrowIterator operator--(int) { UrowIterator it(*this); --k_; return it; }
+  UrowIterator& operator+=(ptrdiff_t j) { k_ += j; return *this; }
+  UrowIterator& operator-=(ptrdiff_t j) { k_ -= j; return *this; }
+  UrowIterator operator+(ptrdiff_t j) const { 
+    return UrowIterator(p_, offset_, k_ + j); 
+  }
+  UrowIterator operator-(ptrdiff_t j) const { 
+    return UrowIterator(p_, offset_, k_ - j); 
+  }
+  ptrdiff_t operator-(const UrowIterator& it) const { return k_ - it.k_; }
+  bool operator==(const UrowIterator& it) const { return k_ == it.k_; }
+  bool operator!=(const UrowIterator& it) const { return k_ != it.k_; }
+  bool operator<(const UrowIterator& it) const { return k_ < it.k_; }
+  bool operator>(const UrowIterator& it) const { return k_ > it.k_; }
+  bool operator<=(const UrowIterator& it) const { return k_ <= it.k_; }
+  bool operator>=(const UrowIterator& it) const { return k_ >= it.k_; }
+};
+
+
+/** Read only view of the u-part of one pattern: of a row of a Umatrix,
+ * of a RowView, or of a Uvector.  Element k is p[k], or p[offset[k]] 
+ * for a row of a Umatrix stored column by column, where offset[k] is 
+ * the start of column k and p points to the row's element of column 0.
+ * Like a pointer, a view is copied shallow.
+ * @memo
+ */
+class Urow
+{
+  const Real* p_;
+  const size_t* offset_;
+  Subscript n_;
+public:
+  typedef UrowIterator iterator;
+  typedef UrowIterator const_iterator;
+  /// empty view
+  Urow() : p_(NULL), offset_(NULL), n_(0) { }
+  /// view of the n elements at p
+  Urow(const Real* p, Subscript n) : p_(p), offset_(NULL), n_(n) { }
+  /// view of the n elements p[offset[0]], ..., p[offset[n-1]]
+  Urow(const Real* p, const size_t* offset, Subscript n) 
+    : p_(p), offset_(offset), n_(n) { }
+  /// view of a Uvector
+  Urow(const Uvector& v) : p_(v.begin()), offset_(NULL), n_(v.size()) { }
+  /// read only view of a RowView
+  template <class T>
+  Urow(const RowView<T>& v) : p_(v.begin()), offset_(NULL), n_(v.size()) { }
+  Subscript size() const { return n_; }
+  Subscript dim() const { return n_; }
+  iterator begin() const { return iterator(p_, offset_, 0); }
+  iterator end() const { return iterator(p_, offset_, n_); }
+  /// the view of the same elements delta elements behind p (e.g., of 
+  /// the next row)
+  Urow moved(ptrdiff_t delta) const { return Urow(p_ + delta, offset_, n_); }
+  /// element i = 0, ..., n-1
+  const Real& operator[](Subscript i) const { 
+    assert((i >= 0) && (i < n_)); 
+    return (offset_ != NULL) ? p_[offset_[i]] : p_[i];
+  }
+  /// element i = 1, ..., n (as for TNT vectors)
+  const Real& operator()(Subscript i) const { 
+    assert((i >= 1) && (i <= n_)); 
+    return (offset_ != NULL) ? p_[offset_[i-1]] : p_[i-1];
+  }
+};
+
+/* Stream output operator for Urows.  
+ */
+std::ostream& operator<<(std::ostream &strm, const Urow &v);
+
+
+/** Random access iterator over the rows of a Umatrix (see
+ * Umatrix::iterator and Umatrix::const_iterator): View is RowView<Real>
+ * or Urow.
+ * @memo
+ */
+template <class View>
+class RowIterator
+{
+  View row_;
+  /// elements from one row to the next
+  ptrdiff_t stride_;
+  ptrdiff_t i_;
+  void move(ptrdiff_t k) {
+    row_ = row_.moved(k * stride_);
+    i_ += k;
+  }
+public:
+  typedef std::random_access_iterator_tag iterator_category;
+  typedef View value_type;
+  typedef ptrdiff_t difference_type;
+  typedef const View* pointer;
+  typedef const View& reference;
+  RowIterator() : stride_(0), i_(0) { }
+  /// iterator at row i, the view row; the next row is stride elements
+  /// behind
+  RowIterator(const View& row, ptrdiff_t stride, ptrdiff_t i) 
+    : row_(row), stride_(stride), i_(i) { }
+  /// const_iterator from iterator
+  template <class S>
+  RowIterator(const RowIterator<S>& it) 
+    : row_(*it), stride_(it.stride()), i_(it.index()) { }
+  /// row index
+  ptrdiff_t index() const { return i_; }
+  /// elements from one row to the next
+  ptrdiff_t stride() const { return stride_; }
+  reference operator*() const { return row_; }
+  pointer operator->() const { return &row_; }
+  value_type operator[](ptrdiff_t k) const { return row_.moved(k * stride_); }
+  RowIterator& operator++() { move(1); return *this; }
+  RowIterator& operator--() { move(-1); return *this; }
+  RowIterator operator++(int) { RowIterator it(*this); move(1); return it; }
+  RowIterator operator--(int) { RowIterator it(*this); move(-1); return it; }
+  RowIterator& operator+=(ptrdiff_t k) { move(k); return *this; }
+  RowIterator& operator-=(ptrdiff_t k) { move(-k); return *this; }
+  RowIterator operator+(ptrdiff_t k) const { 
+    RowIterator it(*this); 
+    it.move(k); 
+    return it; 
+  }
+  RowIterator operator-(ptrdiff_t k) const { 
+    RowIterator it(*this); 
+    it.move(-k); 
+    return it; 
+  }
+  ptrdiff_t operator-(const RowIterator& it) const { return i_ - it.i_; }
+  bool operator==(const RowIterator& it) const { return i_ == it.i_; }
+  bool operator!=(const RowIterator& it) const { return i_ != it.i_; }
+  bool operator<(const RowIterator& it) const { return i_ < it.i_; }
+  bool operator>(const RowIterator& it) const { return i_ > it.i_; }
+  bool operator<=(const RowIterator& it) const { return i_ <= it.i_; }
+  bool operator>=(const RowIterator& it) const { return i_ >= it.i_; }
+};
+
+
+/** Matrix of the u-parts of patterns, stored row by row in one 
+ * contiguous block aligned to 64 bytes (i.e., without an allocation 
+ * per row), or column by column: in place in a mapped binary data file
+ * (see map_columns()), or in allocated columns that may overlap, as the
+ * lagged regressors u(t-1), u(t-2), ... of one signal do (see 
+ * allocate_columns() and Data::assign_lags()).
+ * Row i is the view U[i]; rows are iterated like the elements of a 
+ * vector<Uvector>.  The rows of a matrix stored column by column are 
+ * views of the column offsets; changing its elements (the non-const 
+ * operator[], begin(), end() and data()) first copies it into rows.
+ * The optional column-major mirror of the rows (see mirror_columns(), 
+ * built by fzymodel -Mc) serves the kernels that evaluate blocks of 
+ * patterns column by column, which otherwise transpose each block; it 
+ * is a copy, i.e., it does not see later changes of the rows.  
+ * @memo
+ */
+class Umatrix
+{
+  /// the rows, udim_ Reals each; NULL if stored by columns
+  Real* data_;
+  size_t size_;
+  Subscript udim_;
+  /// column k at columns_ + offset_[k]: the mirror of the rows, or the
+  /// matrix stored by columns
+  Real* columns_;
+  vector<size_t> offset_;
+  /// has a column-major mirror of the rows
+  bool mirror_;
+  /// stored column by column (in columns_ only)
+  bool by_columns_;
+  /// mapping of map_size_ bytes that holds the columns, NULL if allocated
+  void* map_;
+  size_t map_size_;
+  /// free or unmap the columns
+  void release_columns();
+  /// the column offsets of the rows of a matrix stored by columns
+  const size_t* offsets() const { 
+    return offset_.empty() ? NULL : &offset_[0]; 
+  }
+  /// store the matrix row by row (before changes)
+  void make_rows();
+public:
+  typedef RowIterator< RowView<Real> > iterator;
+  typedef RowIterator<Urow> const_iterator;
+  /// empty matrix
+  Umatrix() 
+    : data_(NULL), size_(0), udim_(0), columns_(NULL), mirror_(false),
+      by_columns_(false), map_(NULL), map_size_(0) { }
+  /// n_rows rows of udim elements x0
+  Umatrix(size_t n_rows, Subscript udim, Real x0 = 0.0);
+  Umatrix(const Umatrix& U);
+  ~Umatrix();
+  Umatrix& operator=(const Umatrix& U);
+  /// resize to n_rows rows of udim elements, stored row by row; the 
+  /// elements are undefined
+  void newsize(size_t n_rows, Subscript udim);
+  /// number of rows
+  size_t size() const { return size_; }
+  bool empty() const { return size_ == 0; }
+  /// number of elements per row
+  Subscript udim() const { return udim_; }
+  /// row i
+  Urow operator[](size_t i) const {
+    assert(i < size_);
+    if (by_columns_) {
+      return Urow(columns_ + i, offsets(), udim_);
+    }
+    return Urow(data_ + i * udim_, udim_);
+  }
+  /// modify row i
+  RowView<Real> operator[](size_t i) {
+    assert(i < size_);
+    if (by_columns_) {
+      make_rows();
+    }
+    return RowView<Real>(data_ + i * udim_, udim_);
+  }
+  const_iterator begin() const { 
+    if (by_columns_) {
+      return const_iterator(Urow(columns_, offsets(), udim_), 1, 0);
+    }
+    return const_iterator(Urow(data_, udim_), udim_, 0); 
+  }
+  const_iterator end() const { 
+    return begin() + size_;
+  }
+  iterator begin() { 
+    if (by_columns_) {
+      make_rows();
+    }
+    return iterator(RowView<Real>(data_, udim_), udim_, 0); 
+  }
+  iterator end() { return begin() + size_; }
+  /// all rows, one after the other (NULL if stored by columns)
+  const Real* data() const { return data_; }
+  /// modify all rows
+  Real* data() { 
+    if (by_columns_) {
+      make_rows();
+    }
+    return data_; 
+  }
+  /// (re)build the column-major mirror from the rows; a matrix stored 
+  /// by columns has its columns already
+  void mirror_columns();
+  /** Set the matrix to n_rows rows of offset.size() elements, stored 
+   * column by column in n_reals allocated Reals: column k starts at 
+   * Real offset[k].  Columns may overlap.
+   * @return the Reals, to be filled by the caller
+   * @memo store the matrix in allocated columns
+   */
+  Real* allocate_columns(size_t n_rows, const vector<size_t>& offset, 
+			 size_t n_reals);
+  /** Set the matrix to n_rows rows of udim elements, stored column by 
+   * column in place in the mapping map of map_size bytes (see map_file()
+   * in data.cc): column k starts at Real first + k * stride of the 
+   * mapping.  The matrix unmaps it when it is destroyed or resized; 
+   * copies of the matrix allocate their columns.
+   * @memo store the matrix in the columns of a mapped file
+   */
+  void map_columns(size_t n_rows, Subscript udim, void* map, size_t map_size,
+		   size_t first, size_t stride);
+  /// stored column by column
+  bool by_columns() const { return by_columns_; }
+  /// has columns: is stored by columns, or has a column-major mirror
+  bool has_columns() const { return by_columns_ || mirror_; }
+  /// column k = 0, ..., udim-1 (size() Reals)
+  const Real* column(Subscript k) const { 
+    assert(has_columns());
+    assert((k >= 0) && (k < udim_));
+    return columns_ + offset_[k];
+  }
+};
+
+
+class DataReader;
+
+
 /** Data container.
  * @memo
  */
 class Data 
 {
+  friend class DataReader;
 protected:
   string filename_;
   /// block size for twodimensional plots
   size_t blocksize_;
   /// u-parts of the patterns 
-  vector<Uvector> U_;
+  Umatrix U_;
   /// y-parts of the patterns 
   vector<Real> y_;
   /// mean of all y values
@@ -96,14 +443,14 @@ public:
   Data(Subscript N, size_t M, Real x0);
   const size_t udim() const { 
     if (U_.size() > 0) 
-      return (size_t)U_[0].size();
+      return (size_t)U_.udim();
     else 
       return 0;
   }
   /// filename of loaded data
   const string& filename() const { return filename_; }
   /// u-parts of all patterns
-  const vector<Uvector>& U() const { return U_; }
+  const Umatrix& U() const { return U_; }
   /// y-parts of all patterns
   const vector<Real>& y() const { return y_; }
   /// scale factor
@@ -117,17 +464,140 @@ public:
   /// variance of all y values
   const Real& variance_y() const { return variance_y_; }
   /// modify u-parts of all patterns
-  vector<Uvector>& U() { return U_; }
+  Umatrix& U() { return U_; }
   /// modify y-parts of all patterns
   vector<Real>& y() { return y_; }
-  /// load data matrix from file
+  /// load data matrix from file (text, or binary, see write_binary_data())
   void load(char* filename) throw (Error);
   /// normalize data matrix with given scale_factor and scale_shift
   void normalize(const vector<Real>& factor, const vector<Real>& shift) 
     throw (Error);
+  /** Set the data to the rows [first, first + n_rows) of U and y, as 
+   * load() reads them from the file write_binary_data() writes of them.
+   * @memo set the data to rows of U and y
+   */
+  void assign(const string& filename, const Umatrix& U, 
+	      const vector<Real>& y, size_t first, size_t n_rows, 
+	      size_t blocksize, const vector<Real>& scale_factor,
+	      const vector<Real>& scale_shift);
+  /** Set the data to the lagged regressors of the signals of a (see 
+   * fzymkdat -d): for dynamic_orders d_1, ..., d_n, d_y the row 
+   * u_1(t-1), ..., u_1(t-d_1), ..., y(t-1), ..., y(t-d_y) and y(t), 
+   * for the n_rows times t = first + max(d_s) + i of a (with 
+   * ut_regressor, u_s(t-l) is read at t-l+1, i.e., u(t) is a 
+   * regressor).  The lags of a signal are views of a single copy of it
+   * (see Umatrix::allocate_columns()); only y(t) is copied again.
+   * The scale repeats each signal's scale d_s times, as the header 
+   * fzymkdat writes.
+   * @memo set the data to lagged regressors, one copy per signal
+   */
+  void assign_lags(const string& filename, const Data& a, 
+		   const vector<int>& dynamic_orders, bool ut_regressor,
+		   size_t first, size_t n_rows);
   /// print data into a stream
   friend std::ostream& operator << (std::ostream& strm, const Data& d);
+protected:
+  /// load data matrix from the binary file filename, opened as file
+  /// (only y_ is copied; U_ reads the mapped columns in place)
+  void load_binary(const char* filename, FILE* file) throw (Error);
 };
 
 
+class DataParser;
+
+
+/** Sequential reader of a data file (text or binary, see Data::load()),
+ *  for files that do not fit into memory.
+ *
+ * The constructor scans the whole file once, for the number of rows and
+ * columns, the blocksize, the scale and the mean of y, as Data::load() 
+ * computes them; read() then loads the rows chunk by chunk.
+ * Unscanned, a text file is only read as far as read() goes: n_rows() 
+ * is SIZE_MAX until read() has reached the end of the file, blocksize() 
+ * and mean_y() are 0, and udim() and the scale are known after the 
+ * first read().
+ * @memo sequential reader of a data file
+ */
+class DataReader
+{
+protected:
+  string filename_;
+  FILE* file_;
+  /// parser of a text file, NULL for a binary file
+  DataParser* parser_;
+  /// binary file: offset and stride of the columns
+  size_t data_offset_;
+  size_t column_stride_;
+  size_t n_rows_;
+  size_t n_columns_;
+  size_t blocksize_;
+  Real mean_y_;
+  vector<Real> scale_factor_;
+  vector<Real> scale_shift_;
+  /// index of the next row to read
+  size_t row_;
+  /// the constructor scanned the whole file
+  bool scanned_;
+  /// text file: the values of the last chunk
+  vector<Real> values_;
+  /// binary file: one column of the last chunk
+  vector<Real> column_;
+private:
+  DataReader(const DataReader&);
+  DataReader& operator=(const DataReader&);
+public:
+  /// open the data file filename, and scan it unless scan is false
+  DataReader(const char* filename, bool scan = true) throw (Error);
+  ~DataReader();
+  /// filename of the data file
+  const string& filename() const { return filename_; }
+  /// number of rows
+  size_t n_rows() const { return n_rows_; }
+  /// dimension of the u-parts
+  size_t udim() const { return n_columns_ - 1; }
+  /// blocksize (for twodimensional print)
+  size_t blocksize() const { return blocksize_; }
+  /// mean of all y values
+  Real mean_y() const { return mean_y_; }
+  /// scale factor
+  const vector<Real>& scale_factor() const { return scale_factor_; }
+  /// scale shift
+  const vector<Real>& scale_shift() const { return scale_shift_; }
+  /** Load the next (at most) n_rows rows into chunk, with the file's 
+   *  filename, blocksize and scale, and mean and variance of the 
+   *  chunk's y values.
+   * @return false after the last row
+   * @memo load the next chunk of rows
+   */
+  bool read(Data& chunk, size_t n_rows) throw (Error);
+  /// restart at the first row
+  void rewind() throw (Error);
+};
+
+
+/** Write the rows first, ..., first + n_rows - 1 of U and y into the 
+ *  binary data file filename.
+ *
+ * Data::load() reads it, like the corresponding text file, by mmap(), 
+ * i.e. without parsing; only y is copied, and the u-parts are read in 
+ * place in the mapped columns, which processes that load the same file
+ * share (see Umatrix::map_columns()).  For WIN2017 the file is read 
+ * into memory.
+ * The file holds, in the machine's byte order:
+ * a header (magic "FZYDATA", version, sizeof(Real), no. of rows and 
+ * columns, blocksize, mean and variance of y, offset and stride of the 
+ * columns), scale_shift and scale_factor (one Real per column), and the
+ * columns u_1, ..., u_n, y of n_rows Reals each, every column aligned 
+ * to 64 bytes.
+ *
+ * @param blocksize  block size of a text file (0 for none)
+ * @exception FileOpenError
+ * @memo write a binary data file
+ */
+void write_binary_data(const string& filename, const Umatrix& U,
+		       const vector<Real>& y, size_t first, size_t n_rows,
+		       size_t blocksize, const vector<Real>& scale_factor,
+		       const vector<Real>& scale_shift) throw (Error);
+
+
 #endif /// #ifndef DATA_HH
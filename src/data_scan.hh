@@ -0,0 +1,91 @@
+#ifndef DATA_SCAN_HH
+#define DATA_SCAN_HH
+
+/*
+ * MIT License
+ *
+ * Copyright (c) 1999, 2020 Manfred Maennle
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * $Id$
+ */
+
+
+/* includes:
+ */
+
+#include <stdio.h>
+#include <stddef.h>
+
+#include "global.hh"
+
+
+/** Scanner for data files.
+ *
+ * Returns the tokens of data_lex.l (see data_lex.h) with the same 
+ * longest-match rules, but reads the file in large blocks of complete 
+ * lines (no token spans a newline) and converts the numbers by 
+ * fast_atof() on the spot. Scans a file, or a range of whole lines in 
+ * memory (e.g., of a mapped file).
+ * @memo scanner for data files
+ */
+class DataScanner 
+{
+protected:
+  /// NULL when scanning a range in memory
+  FILE* file_;
+  vector<char> buffer_;
+  /// the current block: data_[0, size_), i.e., the buffer_ or the range 
+  /// in memory; the unread complete lines are [p_, end_), [end_, size_) 
+  /// is an incomplete line
+  const char* data_;
+  size_t size_;
+  size_t p_;
+  size_t end_;
+  /// file offset of data_[0]
+  size_t offset_;
+  bool eof_;
+  int lineno_;
+  string text_;
+  Real value_;
+  /// read the next block of complete lines; false at the end of the file
+  bool fill(void);
+public:
+  DataScanner(FILE* file) 
+    : file_(file), buffer_(1 << 20), data_(&buffer_[0]), size_(0), p_(0), 
+      end_(0), offset_(0), eof_(false), lineno_(1) { }
+  /// scanner of the lines [begin, end) in memory
+  DataScanner(const char* begin, const char* end) 
+    : file_(NULL), data_(begin), size_(end - begin), p_(0), end_(size_), 
+      offset_(0), eof_(true), lineno_(1) { }
+  /// next token
+  int next(void);
+  /// value of a T_DATA_NUMBER
+  Real value(void) const { return value_; }
+  /// text of a T_DATA_ERROR
+  const string& text(void) const { return text_; }
+  /// line number (incremented at each T_DATA_NEWLINE, as yylineno)
+  int lineno(void) const { return lineno_; }
+  /// number of bytes scanned
+  size_t position(void) const { return offset_ + p_; }
+};
+
+
+#endif /* #ifndef DATA_SCAN_HH */
@@ -40,6 +40,11 @@
 #include "fzy_lex.h"
 
 #include "fmodel.hh"
+#include "cmodel.hh"
+
+#ifdef SIMD_MEMBERSHIP
+#include <immintrin.h>
+#endif
 
 
 // /// offset when printing the error (y - y_hat) in the last column
@@ -272,6 +277,7 @@ FModel::copy(const FModel& oldmodel)
     //#WIN2017 (frulenew++)->copy(*(fruleold++), fsets_.begin(), oldmodel.fsets_.begin());
     (frulenew++)->copy(*(fruleold++), &*(fsets_.begin()), &*(oldmodel.fsets_.begin()));
   }
+  index_fsets();
   return;
 }
 
@@ -335,6 +341,46 @@ FModel::FModel(const FModel& oldmodel, size_t r, size_t u)
       k += 2;
     }
   }
+  index_fsets();
+}
+
+// //////////////////////////////////////////////////////////////////////
+
+void 
+FModel::index_fsets(void) {
+  fset_uindex_.assign(sdim_, 0);
+  fset_rules_begin_.assign(sdim_ + 1, 0);
+  const FSet* fset_begin = this->fset_begin();
+  // /// count the references of each fset and note its input index
+  FRuleContainer::const_iterator pr = frules_.begin();
+  while (pr != frules_.end()) {
+    Premise::const_iterator pprem = pr->prem().begin();
+    while (pprem != pr->prem().end()) {
+      if (*pprem != NULL) {
+	assert((size_t)(*pprem - fset_begin) < sdim_);
+	fset_uindex_[*pprem - fset_begin] = (pprem - pr->prem().begin()) / 2;
+	++fset_rules_begin_[*pprem - fset_begin + 1];
+      }
+      ++pprem;
+    }
+    ++pr;
+  }
+  for (size_t s = 0; s < sdim_; ++s) {
+    fset_rules_begin_[s+1] += fset_rules_begin_[s];
+  }
+  // /// list the referencing rules, in rule order
+  fset_rules_.resize(fset_rules_begin_[sdim_]);
+  vector<size_t> next(fset_rules_begin_.begin(), fset_rules_begin_.end() - 1);
+  for (size_t r = 0; r < rdim_; ++r) {
+    Premise::const_iterator pprem = frules_[r].prem().begin();
+    while (pprem != frules_[r].prem().end()) {
+      if (*pprem != NULL) {
+	fset_rules_[next[*pprem - fset_begin]++] = r;
+      }
+      ++pprem;
+    }
+  }
+  return;
 }
 
 // //////////////////////////////////////////////////////////////////////
@@ -422,43 +468,58 @@ FModel::erase_parameters() {
 
 void 
 FModel::load(char* filename) throw (Error) {
-#ifdef YYDEBUG
-  fzy_debug = 1;
-#endif
   if (filename == NULL) {
     return;
   }
   else if (strcmp(filename, "stdin") == 0) {
-    fzy_in = stdin;
+    load(stdin, filename);
   }
   else {
-    fzy_in = fopen(filename, "r");
-    if (fzy_in == NULL) {
+    FILE* file = fopen(filename, "r");
+    if (file == NULL) {
       throw FileOpenError(filename);
     }
+    try {
+      load(file, filename);
+    }
+    catch(Error&) {
+      fclose(file);
+      throw;
+    }
+    fclose(file);
   }
+  return;
+}
+
+// //////////////////////////////////////////////////////////////////////
+
+void 
+FModel::load(FILE* file, const string& filename) throw (Error) {
+#ifdef YYDEBUG
+  fzy_debug = 1;
+#endif
+  fzy_in = file;
+  fzy_lineno = 1;
   try {
     fzy_parse((void *)this);
   }
   catch(ParseError& error) {
     throw Error((string)"in file `" + filename + "' line " + error.msg());
   }
-  if (strcmp(filename, "stdin") != 0) {
-    fclose(fzy_in);
-  }
   return;
 }
 
 // //////////////////////////////////////////////////////////////////////
 
 Real 
-FModel::y_hat(const Uvector& u) throw (Error) {
+FModel::y_hat(const Urow& u, vector<Real>& F) throw (Error) {
   assert(frules_.size() > 0);
+  fset_values(u, F);
   FRuleContainer::const_iterator pfrule = frules_.begin();
   register Real sum_premvalues = 0.0;
   register Real sum_rulevalues = 0.0;
   while (pfrule != frules_.end()) {
-    register Real premvalue = pfrule->premvalue(u);
+    register Real premvalue = pfrule->premvalue(F, fset_begin());
     sum_premvalues += premvalue;
     sum_rulevalues += inference(premvalue, (pfrule++)->consvalue(u));
   }
@@ -475,7 +536,32 @@ Real
 FModel::R2(const Data& d) {
   assert(frules_.size() > 0);
   assert(d.y().size() > 0);
-  if (d.variance_y() < 10*REAL_MIN) {
+  Real variance_error = 0.0;
+  if (d.variance_y() >= 10*REAL_MIN) {
+    vector<Real> error_vect;
+    estimation_errors(d, error_vect);
+    vector<Real>::iterator error = error_vect.begin();
+    Real mean_error = 0.0;
+    while (error != error_vect.end()) {
+      mean_error += *(error++);
+    }
+    mean_error /= d.y().size();
+    error = error_vect.begin();
+    while (error != error_vect.end()) {
+      *error -= mean_error;
+      variance_error += *error * *error;
+      ++error;
+    }
+    variance_error /= d.y().size();
+  }
+  return R2(variance_error, d.variance_y());
+}
+
+// //////////////////////////////////////////////////////////////////////
+
+Real 
+FModel::R2(Real variance_error, Real variance_y) {
+  if (variance_y < 10*REAL_MIN) {
     string msg = (string)GLOBAL::prgname + ": error in FModel::R2(): ";
     msg += (string)"y variance of input data is (almost) 0.0\n";
     if ((!GLOBAL::quiet) || (!GLOBAL::logfile)) {
@@ -486,18 +572,28 @@ FModel::R2(const Data& d) {
     }
     return -REAL_MAX;
   }
-  vector<Real> error_vect(d.y().size());
-  vector<Uvector>::const_iterator u = d.U().begin();
+  return 1.0 - variance_error / variance_y;
+}
+
+// //////////////////////////////////////////////////////////////////////
+
+void
+FModel::estimation_errors(const Data& d, vector<Real>& error_vect) {
+  assert(frules_.size() > 0);
+  error_vect.resize(d.y().size());
+  Umatrix::const_iterator u = d.U().begin();
   vector<Real>::const_iterator y = d.y().begin();
   vector<Real>::iterator error = error_vect.begin();
-  Real mean_error = 0.0;
-  Real variance_error = 0.0;
+  CModel cmodel(*this);
+  vector<Real> yhat_vect;
+  vector<bool> covered;
+  cmodel.y_hat(d.U(), yhat_vect, covered);
+  vector<Real>::const_iterator pyhat = yhat_vect.begin();
+  vector<bool>::const_iterator pcovered = covered.begin();
   while (u != d.U().end()) { // for all u
-    Real yhat;
-    try {
-      yhat = y_hat(*u);
-    }
-    catch(IncompleteCoverageError& error) {
+    Real yhat = *(pyhat++);
+    if (! *(pcovered++)) {
+      IncompleteCoverageError error("CModel::y_hat()");
       string msg = (string)GLOBAL::prgname+": error caught in FModel::R2(): ";
       msg += error.msg() + "\n";
       if ((!GLOBAL::quiet) || (!GLOBAL::logfile)) {
@@ -510,23 +606,12 @@ FModel::R2(const Data& d) {
       //return -REAL_MAX;
     }
     *error = *y - yhat;
-    mean_error += *error;
     ++u;
     ++y;
     ++error;
   } // end for all u
-  mean_error /= d.y().size();
-  error = error_vect.begin();
-  while (error != error_vect.end()) {
-    *error -= mean_error;
-    variance_error += *error * *error;
-    ++error;
-  }
-  variance_error /= d.y().size();
-  return 1.0 - variance_error / d.variance_y();
 }
 
-
 // //////////////////////////////////////////////////////////////////////
 
 size_t 
@@ -535,10 +620,12 @@ FModel::worst_rule_index(const Data& d) throw (Error) {
   vector<Real> w(rdim_);
   vector<Real> f(rdim_);
   vector<Real> rule_error(rdim_, 0.0);
-  vector<Uvector>::const_iterator u = d.U().begin();
+  vector<Real> F(sdim_);
+  Umatrix::const_iterator u = d.U().begin();
   vector<Real>::const_iterator y = d.y().begin();
   // ///// calculate forward step
   while (u != d.U().end()) { // //// for all u
+    fset_values(*u, F);
     Real sum_w = 0.0;
     Real y_hat = 0.0;
     Real difference;
@@ -551,7 +638,7 @@ FModel::worst_rule_index(const Data& d) throw (Error) {
       assert(pr != frules_.end());
       assert(pw != w.end());
       assert(pf != f.end());
-      *pw = pr->premvalue(*u);
+      *pw = pr->premvalue(F, fset_begin());
       sum_w += *pw;
       *pf = pr->consvalue(*u);
       y_hat += inference(*pw, *pf);
@@ -617,67 +704,96 @@ FModel::estimation(const Data& d, const char* outfilename) throw (Error) {
     }
     file << "### data file: \"" << d.filename() << "\"\n" << flush;
   }
-  Real sum_error = 0.0;
-  vector<Uvector>::const_iterator u = d.U().begin();
+  PredictionState state;
+  estimation(d, (outfilename != NULL) ? &file : NULL, state);
+  if (outfilename != NULL) {
+    file.close();
+  }
+//   gettimeofday(&time_end, NULL);
+//   long time_diff = 1000000 * (time_end.tv_sec - time_begin.tv_sec)
+//     + (time_end.tv_usec - time_begin.tv_usec);
+//   if (outfilename == NULL) {
+//     verbose(2, "estimation time", time_diff);
+//   }
+  return sqrt(state.sum_error / d.U().size());
+  // return sqrt(sum_error);
+}
+
+// //////////////////////////////////////////////////////////////////////
+
+void
+FModel::estimation(const Data& d, std::ostream* file, PredictionState& state)
+  throw (Error) {
+  assert(frules_.size() > 0);
+  Real& sum_error = state.sum_error;
+  Umatrix::const_iterator u = d.U().begin();
   vector<Real>::const_iterator y = d.y().begin();
-  size_t blockline = 0;
+  size_t& blockline = state.blockline;
   // /// for Page-Hinkley test
-  Real U_t = 0.0;
-  Real T_t = 0.0;
-  Real m_t = 0.0;
-  Real M_t = 0.0;
+  Real& U_t = state.U_t;
+  Real& T_t = state.T_t;
+  Real& m_t = state.m_t;
+  Real& M_t = state.M_t;
+  // /// evaluate on the compiled model, a block of inputs at a time
+  CModel cmodel(*this);
+  vector<Real> yhat_vect;
+  vector<bool> covered;
+  cmodel.y_hat(d.U(), yhat_vect, covered);
+  vector<Real>::const_iterator pyhat = yhat_vect.begin();
+  vector<bool>::const_iterator pcovered = covered.begin();
   // /// do the estimation
   while (u != d.U().end()) { // //// for all u
     ++blockline;
-    Real yhat;
-    try {
-      yhat = y_hat(*u);
-    }
-    catch(IncompleteCoverageError& error) {
+    Real yhat = *(pyhat++);
+    if (! *(pcovered++)) {
+      IncompleteCoverageError error("CModel::y_hat()");
       string msg = (string)GLOBAL::prgname; 
       msg += (string)": warning from FModel::estimation(): "+error.msg()+"\n";
-      if ((!GLOBAL::quiet) || (!GLOBAL::logfile)) {
-	cerr << msg << flush;
-      }
-      if (GLOBAL::logfile) {
-	GLOBAL::logfile << msg;
+#pragma omp critical (fzy_output)
+      {
+	if ((!GLOBAL::quiet) || (!GLOBAL::logfile)) {
+	  cerr << msg << flush;
+	}
+	if (GLOBAL::logfile) {
+	  GLOBAL::logfile << msg;
+	}
       }
-      if (outfilename != NULL) {
-	file << " ### warning: next u not covered by model:\n";
+      if (file != NULL) {
+	*file << " ### warning: next u not covered by model:\n";
       }
       yhat = 0.0;
     }
-    if (outfilename != NULL) {
+    if (file != NULL) {
       Real difference = 0.0;
       if (GLOBAL::denormalize) {
-	Uvector::const_iterator pu = u->begin();
+	Urow::const_iterator pu = u->begin();
 	vector<Real>::const_iterator ps = d.scale_shift().begin();
 	vector<Real>::const_iterator pf = d.scale_factor().begin();
 	while (pu != u->end()) {
 	  // /// print u
-	  file << denormalization(*(pu++), *(pf++), *(ps++)) << " ";
+	  *file << denormalization(*(pu++), *(pf++), *(ps++)) << " ";
 	}
 	// /// print yhat
-	file << denormalization(yhat, *(pf), *ps) << " ";
+	*file << denormalization(yhat, *(pf), *ps) << " ";
 	// /// print y
-	file << denormalization(*y, *(pf), *ps) << " ";
+	*file << denormalization(*y, *(pf), *ps) << " ";
 	// /// print y - yhat
 	difference = denormalization( (*y - yhat) , *(pf), err_offset);
-	file << (difference + GLOBAL::error_offset);
+	*file << (difference + GLOBAL::error_offset);
       }
       else {
-	Uvector::const_iterator pu = u->begin();
+	Urow::const_iterator pu = u->begin();
 	while (pu != u->end()) {
 	  // /// print u
-	  file << *(pu++) << " ";
+	  *file << *(pu++) << " ";
 	}
 	// /// print yhat
-	file << yhat << " ";
+	*file << yhat << " ";
 	// /// print y
-	file << *y << " ";
+	*file << *y << " ";
 	// /// print y - yhat
 	difference = (*y - yhat);
-	file << (difference + GLOBAL::error_offset);
+	*file << (difference + GLOBAL::error_offset);
       }
       // /// Page-Hinkley test
       if (GLOBAL::page_hinkley) {
@@ -691,20 +807,20 @@ FModel::estimation(const Data& d, const char* outfilename) throw (Error) {
 	if (T_t > M_t) {
 	  M_t = T_t;
 	}
-	file << " " << (U_t - m_t);
-	file << " " << (M_t - T_t);
+	*file << " " << (U_t - m_t);
+	*file << " " << (M_t - T_t);
 	if ( ((U_t - m_t) >= GLOBAL::page_hinkley_lambda)
 	     || ((M_t - T_t) >= GLOBAL::page_hinkley_lambda) ) { 
-	  file << " 1";
+	  *file << " 1";
 	}
 	else {
-	  file << " 0";
+	  *file << " 0";
 	}
       }
-      file << endl;
+      *file << endl;
       // /// print additional newlines
       if (blockline == d.blocksize()) {
-	file << endl;
+	*file << endl;
 	blockline = 0;
       }
     }
@@ -717,17 +833,54 @@ FModel::estimation(const Data& d, const char* outfilename) throw (Error) {
     ++u;
     ++y;
   } // //// end for all u
-  if (outfilename != NULL) {
-    file.close();
+  return;
+}
+
+// //////////////////////////////////////////////////////////////////////
+
+Real
+FModel::estimation(const Data& d, const vector<Real>& parent_w, size_t r)
+  throw (Error) {
+  assert(frules_.size() > 1);
+  CModel cmodel(*this);
+  vector<Real> w;
+  cmodel.premvalues(d.U(), parent_w, r, w);
+  vector<Real> yhat_vect;
+  vector<bool> covered;
+  cmodel.y_hat(d.U(), w, yhat_vect, covered);
+  Real y_scale_factor =  *(d.scale_factor().end() - 1);
+  Real sum_error = 0.0;
+  for (size_t i = 0; i < yhat_vect.size(); ++i) {
+    if (! covered[i]) {
+      IncompleteCoverageError error("CModel::y_hat()");
+      string msg = (string)GLOBAL::prgname; 
+      msg += (string)": warning from FModel::estimation(): "+error.msg()+"\n";
+#pragma omp critical (fzy_output)
+      {
+	if ((!GLOBAL::quiet) || (!GLOBAL::logfile)) {
+	  cerr << msg << flush;
+	}
+	if (GLOBAL::logfile) {
+	  GLOBAL::logfile << msg;
+	}
+      }
+    }
+    Real error = d.y()[i] - yhat_vect[i];
+    if (y_scale_factor > 0.0) {
+      error /= y_scale_factor;
+    }
+    sum_error += error * error;
   }
-//   gettimeofday(&time_end, NULL);
-//   long time_diff = 1000000 * (time_end.tv_sec - time_begin.tv_sec)
-//     + (time_end.tv_usec - time_begin.tv_usec);
-//   if (outfilename == NULL) {
-//     verbose(2, "estimation time", time_diff);
-//   }
   return sqrt(sum_error / d.U().size());
-  // return sqrt(sum_error);
+}
+
+// //////////////////////////////////////////////////////////////////////
+
+void
+FModel::premvalues(const Data& d, vector<Real>& w) {
+  assert(frules_.size() > 0);
+  CModel cmodel(*this);
+  cmodel.premvalues(d.U(), w);
 }
 
 
@@ -754,45 +907,57 @@ FModel::simulation(const Data& d, const char* outfilename) throw (Error) {
     }
     file << "### data file: \"" << d.filename() << "\"\n" << flush;
   }
-  Real sum_error = 0.0;
-  vector<Uvector>::const_iterator u = d.U().begin();
+  PredictionState state;
+  simulation(d, (outfilename != NULL) ? &file : NULL, state);
+  if (outfilename != NULL) {
+    file.close();
+  }
+  return sqrt(state.sum_error / d.U().size());
+  // return sqrt(sum_error);
+}
+
+// //////////////////////////////////////////////////////////////////////
+
+void
+FModel::simulation(const Data& d, std::ostream* file, PredictionState& state)
+  throw (Error) {
+  assert(frules_.size() > 0);
+  assert(GLOBAL::order > 0);
+  assert(GLOBAL::order < (int)d.udim());
+  Real& sum_error = state.sum_error;
+  Umatrix::const_iterator u = d.U().begin();
   vector<Real>::const_iterator y = d.y().begin();
-  Uvector recurrent_u(*u);
-  size_t blockline = 0;
-  Real yhat = 0.0;
+  // /// the first row of the whole simulation starts the recurrency
+  bool first = state.history.empty();
+  OutputHistory& history = state.history;
+  const size_t n_exogenous = d.udim() - GLOBAL::order;
+  size_t& blockline = state.blockline;
+  Real& yhat = state.yhat;
   // /// for Page-Hinkley test
-  Real U_t = 0.0;
-  Real T_t = 0.0;
-  Real m_t = 0.0;
-  Real M_t = 0.0;
+  Real& U_t = state.U_t;
+  Real& T_t = state.T_t;
+  Real& m_t = state.m_t;
+  Real& M_t = state.M_t;
+  // /// evaluate on the compiled model
+  CModel cmodel(*this);
+  vector<Real> F;
   // /// do the simulation
   while (u != d.U().end()) {
     // //// for all u
     ++blockline;
-    Uvector::const_iterator pu = u->end() - 1;
-    Uvector::iterator precurrent_u = recurrent_u.end() - 1;
-    if (u != d.U().begin()) {
+    if (! first) {
       // /// insert recurrency, except at first step
-      while (precurrent_u != recurrent_u.end() - GLOBAL::order) {
-	*precurrent_u = *(precurrent_u - 1);
-	precurrent_u--;
-      }
-      // /// copy last y_hat
-      *(precurrent_u--) = yhat;
-      // /// copy rest of u
-      pu -= GLOBAL::order;
-      while (pu >= u->begin()) {
-	*(precurrent_u--) = *(pu--);
-      } 
+      history.push(yhat);
     }
     else {
-      // /// copy u
-      while (pu >= u->begin()) {
-	*(precurrent_u--) = *(pu--);
-      } 
+      // /// take the outputs of the first row
+      history.assign(u->begin() + n_exogenous, GLOBAL::order);
+      first = false;
     }
+    // /// the exogenous inputs of the row, then the outputs
+    RecurrentInput recurrent_u(*u, n_exogenous, history.window());
     try {
-      yhat = y_hat(recurrent_u);
+      yhat = cmodel.y_hat_of(recurrent_u, F);
     }
     catch(IncompleteCoverageError& error) {
       string msg = (string)GLOBAL::prgname; 
@@ -803,42 +968,40 @@ FModel::simulation(const Data& d, const char* outfilename) throw (Error) {
       if (GLOBAL::logfile) {
 	GLOBAL::logfile << msg;
       }
-      if (outfilename != NULL) {
-	file << " ### warning: next u not covered by model:\n";
+      if (file != NULL) {
+	*file << " ### warning: next u not covered by model:\n";
       }
       yhat = 0.0;
     }
-    if (outfilename != NULL) {
+    if (file != NULL) {
       Real difference = 0.0;
       if (GLOBAL::denormalize) {
 	// /// print recurrent_u
-	precurrent_u = recurrent_u.begin();
 	vector<Real>::const_iterator ps = d.scale_shift().begin();
 	vector<Real>::const_iterator pf = d.scale_factor().begin();
-	while (precurrent_u != recurrent_u.end()) {
-	  file << denormalization(*(precurrent_u++), *(pf++), *(ps++)) << " ";
+	for (size_t k = 0; k < d.udim(); ++k) {
+	  *file << denormalization(recurrent_u[k], *(pf++), *(ps++)) << " ";
 	}
 	// /// print yhat
-	file << denormalization(yhat, *(pf), *ps) << " ";
+	*file << denormalization(yhat, *(pf), *ps) << " ";
 	// /// print y
-	file << denormalization(*y, *(pf), *ps) << " ";
+	*file << denormalization(*y, *(pf), *ps) << " ";
 	// /// print y - yhat
 	difference = denormalization( (*y - yhat) , *(pf), err_offset);
-	file << (difference + GLOBAL::error_offset);
+	*file << (difference + GLOBAL::error_offset);
       }
       else {
 	// /// print recurrent_u
-	precurrent_u = recurrent_u.begin();
-	while (precurrent_u != recurrent_u.end()) {
-	  file << *(precurrent_u++) << " ";
+	for (size_t k = 0; k < d.udim(); ++k) {
+	  *file << recurrent_u[k] << " ";
 	}
 	// /// print yhat
-	file << yhat << " ";
+	*file << yhat << " ";
 	// /// print y
-	file << *y << " ";
+	*file << *y << " ";
 	// /// print y - yhat
 	difference = (*y - yhat);
-	file << (difference + GLOBAL::error_offset);
+	*file << (difference + GLOBAL::error_offset);
       }
       // /// Page-Hinkley test
       if (GLOBAL::page_hinkley) {
@@ -852,20 +1015,20 @@ FModel::simulation(const Data& d, const char* outfilename) throw (Error) {
 	if (T_t > M_t) {
 	  M_t = T_t;
 	}
-	file << " " << (U_t - m_t);
-	file << " " << (M_t - T_t);
+	*file << " " << (U_t - m_t);
+	*file << " " << (M_t - T_t);
 	if ( ((U_t - m_t) >= GLOBAL::page_hinkley_lambda)
 	     || ((M_t - T_t) >= GLOBAL::page_hinkley_lambda) ) { 
-	  file << " 1";
+	  *file << " 1";
 	}
 	else {
-	  file << " 0";
+	  *file << " 0";
 	}
       }
-      file << endl;
+      *file << endl;
       // /// print additional newlines
       if (blockline == d.blocksize()) {
-	file << endl;
+	*file << endl;
 	blockline = 0;
       }
     }
@@ -878,11 +1041,7 @@ FModel::simulation(const Data& d, const char* outfilename) throw (Error) {
     ++u;
     ++y;
   } // //// end for all u
-  if (outfilename != NULL) {
-    file.close();
-  }
-  return sqrt(sum_error / d.U().size());
-  // return sqrt(sum_error);
+  return;
 }
 
 
@@ -911,37 +1070,219 @@ FModel::reset_consequences(void) {
 
 // //////////////////////////////////////////////////////////////////////
 
+/// warn that a consequence optimization was skipped
+static void
+SVD_warning(const SVDError& error) {
+  string msg = (string)"\n" + GLOBAL::prgname + ": ";
+  msg += (string)"optimize_SVD(): warning: " + error.msg();
+  msg += (string)"\nSVD optimization of consequence parameters skipped.\n";
+#pragma omp critical (fzy_output)
+  {
+    if ((!GLOBAL::quiet) || (!GLOBAL::logfile)) {
+      cerr << msg << flush;
+    }
+    if (GLOBAL::logfile) {
+      GLOBAL::logfile << msg;
+    }
+  }
+}
+
+// //////////////////////////////////////////////////////////////////////
+
 void 
 FModel::optimize_SVD(const Data& d) throw (Error) {
   assert(frules_.size() > 0);
-  assert(d.U().size() == d.y().size());
-  size_t m = d.U().size();
+  CModel cmodel(*this);
+  vector<Real> w;
+  if (GLOBAL::consequence_local) {
+    // /// one small problem per rule, a block of samples at a time
+    const size_t block = 4096;
+    vector<StreamingLeastSquares> ls(rdim_, StreamingLeastSquares(cdim_));
+    for (size_t first = 0; first < d.U().size(); first += block) {
+      size_t last = first + block;
+      if (last > d.U().size()) {
+	last = d.U().size();
+      }
+      cmodel.premvalues(d.U(), first, last, w);
+      add_local_LS_rows(ls, d, first, w);
+    }
+    solve_local_LS(ls);
+    return;
+  }
+  if (GLOBAL::consequence_streaming) {
+    // /// a block of premise values at a time, i.e. the memory does not
+    // /// grow with the number of samples
+    const size_t block = 4096;
+    StreamingLeastSquares ls(cdim_ * rdim_);
+    for (size_t first = 0; first < d.U().size(); first += block) {
+      size_t last = first + block;
+      if (last > d.U().size()) {
+	last = d.U().size();
+      }
+      cmodel.premvalues(d.U(), first, last, w);
+      add_LS_rows(ls, d, first, w);
+    }
+    solve_LS(ls);
+    return;
+  }
+  // /// A block by block of premise values, as for the streaming problem
+  const size_t block = 4096;
+  Matrix<Real> A;
+  Vector<Real> y;
+  new_LS(d, A, y);
+  for (size_t first = 0; first < d.U().size(); first += block) {
+    size_t last = first + block;
+    if (last > d.U().size()) {
+      last = d.U().size();
+    }
+    cmodel.premvalues(d.U(), first, last, w);
+    set_LS_rows(A, d, first, w);
+  }
+  solve_SVD(A, y);
+}
+
+// //////////////////////////////////////////////////////////////////////
+
+void 
+FModel::optimize_SVD(const Data& d, const vector<Real>& parent_w, size_t r,
+		     const SplitLeastSquares* parent_ls) throw (Error) {
+  assert(frules_.size() > 1);
+  CModel cmodel(*this);
+  vector<Real> w;
+  cmodel.premvalues(d.U(), parent_w, r, w);
+  if (GLOBAL::consequence_local) {
+    vector<StreamingLeastSquares> ls(rdim_, StreamingLeastSquares(cdim_));
+    add_local_LS_rows(ls, d, 0, w);
+    solve_local_LS(ls);
+    return;
+  }
+  if (GLOBAL::consequence_streaming) {
+    StreamingLeastSquares ls(cdim_ * rdim_);
+    add_LS_rows(ls, d, 0, w);
+    solve_LS(ls);
+    return;
+  }
+  Matrix<Real> A;
+  Vector<Real> y;
+  build_LS(d, w, A, y);
+  if (parent_ls != NULL) {
+    // /// rule r of the parent is split into the rules r and r+1: CGLS 
+    // /// preconditioned by the parent's QR factors; the SVD of the same
+    // /// A if it fails
+    Vector<Real> p;
+    if (parent_ls->solve_split(A, r * cdim_, cdim_, p)) {
+      set_consequences(p);
+      return;
+    }
+  }
+  solve_SVD(A, y);
+}
+
+// //////////////////////////////////////////////////////////////////////
+
+SplitLeastSquares* 
+FModel::split_LS(const Data& d, const vector<Real>& w) throw (Error) {
+  assert(frules_.size() > 0);
+  Matrix<Real> A;
+  Vector<Real> y;
+  build_LS(d, w, A, y);
+  SplitLeastSquares* ls = NULL;
+  try {
+    ls = new SplitLeastSquares(A, y, (GLOBAL::svd_threads > 0) ? 
+			       GLOBAL::svd_threads : 1);
+  }
+  catch(SVDError& error) {
+    return NULL;
+  }
+  if (! ls->full_rank()) {
+    delete ls;
+    return NULL;
+  }
+  return ls;
+}
+
+// //////////////////////////////////////////////////////////////////////
+
+void 
+FModel::solve_SVD(const Matrix<Real>& A, const Vector<Real>& y) 
+  throw (Error) {
+  assert(frules_.size() > 0);
   size_t n = cdim_ * rdim_;
-  assert(m >= n);
+  assert(A.num_cols() == (Subscript)n);
   Vector<Real> p(n);
-  Matrix<Real> A(m, n);
   Matrix<Real> Q;
   Matrix<Real> U;
   Matrix<Real> V;
+  // /// solve y = A * p
+  try {
+    if (GLOBAL::svd_threads > 0) {
+      SVD_QR(A, Q, U, V, GLOBAL::svd_threads);
+    }
+    else {
+      SVD(A, Q, U, V);
+    }
+  }
+  catch(SVDError& error) {
+    SVD_warning(error);
+    return;
+  }
+  // calculate inverse of Q
+  for(size_t row = 1; row <= n; ++row) {
+    if (Q(row, row) != 0.0) {
+      Q(row, row) = 1.0 / Q(row, row);
+    }
+  }
+  // p is LMS solution of y = A * p;
+  p = V * (Q * (transpose(U) * y)); 
+  set_consequences(p);
+}
+
+// //////////////////////////////////////////////////////////////////////
+
+void 
+FModel::build_LS(const Data& d, const vector<Real>& w, Matrix<Real>& A, 
+		 Vector<Real>& y) throw (Error) {
+  assert(w.size() == d.U().size() * rdim_);
+  new_LS(d, A, y);
+  set_LS_rows(A, d, 0, w);
+}
+
+// //////////////////////////////////////////////////////////////////////
+
+void 
+FModel::new_LS(const Data& d, Matrix<Real>& A, Vector<Real>& y) {
+  assert(d.U().size() == d.y().size());
+  size_t m = d.U().size();
+  size_t n = cdim_ * rdim_;
+  assert(m >= n);
+  A.newsize(m, n);
   // create y
-  Vector<Real> y(m);
+  y.newsize(m);
   Vector<Real>::iterator py = y.begin();
   vector<Real>::const_iterator pdy = d.y().begin();
   while (pdy != d.y().end()) {
     *(py++) = *(pdy++);
   }
+}
+
+// //////////////////////////////////////////////////////////////////////
+
+void 
+FModel::set_LS_rows(Matrix<Real>& A, const Data& d, size_t first, 
+		    const vector<Real>& w) throw (Error) {
+  assert(A.num_cols() == (Subscript)(cdim_ * rdim_));
+  assert(first + w.size() / rdim_ <= (size_t)A.num_rows());
   // /// build A
-  vector<Uvector>::const_iterator u = d.U().begin();
-  size_t row = 1;
-  while (u != d.U().end()) { // for all u
+  Umatrix::const_iterator u = d.U().begin() + first;
+  Umatrix::const_iterator u_end = u + w.size() / rdim_;
+  vector<Real>::const_iterator pw_row = w.begin();
+  size_t row = first + 1;
+  while (u != u_end) { // for all u
     Real sum_w = 0.0;
-    vector<Real> w(rdim_);
-    vector<Real>::iterator pw = w.begin();
+    vector<Real>::const_iterator pw = pw_row;
     FRuleContainer::const_iterator pr = frules_.begin();
     while (pr != frules_.end()) { // for all rules 
-      assert(pr != frules_.end());
       assert(pw != w.end());
-      *pw = pr->premvalue(*u);
       sum_w += *pw;
       ++pr;
       ++pw;
@@ -949,47 +1290,30 @@ FModel::optimize_SVD(const Data& d) throw (Error) {
     if (sum_w <= 0.0) {
       throw IncompleteCoverageError("FModel::optimize_SVD()");
     }
-    pw = w.begin();
+    pw = pw_row;
     pr = frules_.begin();
     size_t column = 1;
     while (pr != frules_.end()) { // for all rules 
       Real v = *pw / sum_w;
       A(row, column) = v; // * 1.0; // c_0
       ++column;
-      Uvector::const_iterator ui = u->begin();
+      Urow::const_iterator ui = u->begin();
       for(size_t c = 1; c < cdim_; ++c) { // c_1, ..., c_C (max c_N)
 	A(row, column++) = v * *(ui++);
       }
       ++pr;
       ++pw;
     } // end for all rules 
+    pw_row = pw;
     ++u;
     ++row;
   } // end for all u
-  // /// solve y = A * p
-  try {
-    SVD(A, Q, U, V);
-  }
-  catch(SVDError& error) {
-    string msg = (string)"\n" + GLOBAL::prgname + ": ";
-    msg += (string)"optimize_SVD(): warning: " + error.msg();
-    msg += (string)"\nSVD optimization of consequence parameters skipped.\n";
-    if ((!GLOBAL::quiet) || (!GLOBAL::logfile)) {
-      cerr << msg << flush;
-    }
-    if (GLOBAL::logfile) {
-      GLOBAL::logfile << msg;
-    }
-    return;
-  }
-  // calculate inverse of Q
-  for(row = 1; row <= n; ++row) {
-    if (Q(row, row) != 0.0) {
-      Q(row, row) = 1.0 / Q(row, row);
-    }
-  }
-  // p is LMS solution of y = A * p;
-  p = V * (Q * (transpose(U) * y)); 
+}
+
+// //////////////////////////////////////////////////////////////////////
+
+void 
+FModel::set_consequences(const Vector<Real>& p) {
   // /// write p to consequence parameters
   FRuleContainer::const_iterator pr = frules_.begin();
   Vector<Real>::const_iterator pp = p.begin();
@@ -1004,27 +1328,164 @@ FModel::optimize_SVD(const Data& d) throw (Error) {
 
 // //////////////////////////////////////////////////////////////////////
 
-Real 
-FModel::optimize_GRAD_DESCENT(const Data& a, const Data& b, 
-		       size_t min_iterations, size_t max_iterations) {
-  assert(frules_.size() > 0);
-  // / cross validate after each N_OPTS_PER_STEP iterations of GRAD_DESCENT
-  size_t iteration = 0;
-  Real a_fitness = REAL_MAX;
-  Real b_fitness = REAL_MAX;
-  Real sum_a_fitness = REAL_MAX;  
-  Real sum_b_fitness = REAL_MAX;
-  struct timeval time_begin;
-  struct timeval time_end;
-  gettimeofday(&time_begin, NULL);
-  while (iteration < max_iterations) {
-    try {
-      Real new_a_fitness = 0.0;
-      Real new_b_fitness = 0.0;
-      Real new_sum_a_fitness = 0.0;
-      Real new_sum_b_fitness = 0.0;
-      size_t k = 0;
-      while (k < GLOBAL::steps_per_validation) {
+void 
+FModel::add_LS_rows(StreamingLeastSquares& ls, const Data& d, size_t first,
+		    const vector<Real>& w) throw (Error) {
+  assert(ls.cols() == (int)(cdim_ * rdim_));
+  assert(first + w.size() / rdim_ <= d.U().size());
+  vector<Real> a(cdim_ * rdim_);
+  vector<Real>::const_iterator pw = w.begin();
+  for (size_t i = first; pw != w.end(); ++i) { // for all u
+    const Urow u = d.U()[i];
+    Real sum_w = 0.0;
+    for (size_t r = 0; r < rdim_; ++r) { // for all rules 
+      sum_w += pw[r];
+    }
+    if (sum_w <= 0.0) {
+      throw IncompleteCoverageError("FModel::optimize_SVD()");
+    }
+    // /// the row of A, as in set_LS_rows()
+    vector<Real>::iterator pa = a.begin();
+    for (size_t r = 0; r < rdim_; ++r) { // for all rules 
+      Real v = *(pw++) / sum_w;
+      *(pa++) = v; // * 1.0; // c_0
+      Urow::const_iterator ui = u.begin();
+      for(size_t c = 1; c < cdim_; ++c) { // c_1, ..., c_C (max c_N)
+	*(pa++) = v * *(ui++);
+      }
+    }
+    ls.add_row(&a[0], d.y()[i]);
+  } // end for all u
+}
+
+// //////////////////////////////////////////////////////////////////////
+
+void 
+FModel::solve_LS(const StreamingLeastSquares& ls) {
+  Vector<Real> p;
+  try {
+    ls.solve(p);
+  }
+  catch(SVDError& error) {
+    SVD_warning(error);
+    return;
+  }
+  set_consequences(p);
+}
+
+// //////////////////////////////////////////////////////////////////////
+
+void 
+FModel::add_local_LS_rows(vector<StreamingLeastSquares>& ls, const Data& d,
+			  size_t first, const vector<Real>& w) throw (Error) {
+  assert(ls.size() == rdim_);
+  size_t n = w.size() / rdim_;
+  assert(first + n <= d.U().size());
+  // /// square roots of the normalized premise values
+  vector<Real> weights(w.size());
+  for (size_t i = 0; i < n; ++i) { // for all u
+    Real sum_w = 0.0;
+    for (size_t r = 0; r < rdim_; ++r) { // for all rules 
+      sum_w += w[i * rdim_ + r];
+    }
+    if (sum_w <= 0.0) {
+      throw IncompleteCoverageError("FModel::optimize_SVD()");
+    }
+    for (size_t r = 0; r < rdim_; ++r) { // for all rules 
+      weights[i * rdim_ + r] = sqrt(w[i * rdim_ + r] / sum_w);
+    }
+  }
+  // /// the rules' problems are independent of each other
+  int n_rules = (int)rdim_;
+#pragma omp parallel for schedule(dynamic) num_threads(GLOBAL::n_gradient_threads)
+  for (int r = 0; r < n_rules; ++r) {
+    vector<Real> a(cdim_);
+    for (size_t i = 0; i < n; ++i) { // for all u
+      Real v = weights[i * rdim_ + r];
+      if (v <= 0.0) {
+	continue;
+      }
+      const Urow u = d.U()[first + i];
+      a[0] = v; // * 1.0; // c_0
+      Urow::const_iterator ui = u.begin();
+      for(size_t c = 1; c < cdim_; ++c) { // c_1, ..., c_C (max c_N)
+	a[c] = v * *(ui++);
+      }
+      ls[r].add_row(&a[0], v * d.y()[first + i]);
+    }
+  }
+}
+
+// //////////////////////////////////////////////////////////////////////
+
+void 
+FModel::solve_local_LS(const vector<StreamingLeastSquares>& ls) {
+  assert(ls.size() == rdim_);
+  vector<int> failed(rdim_, 0);
+  int n_rules = (int)rdim_;
+#pragma omp parallel for schedule(dynamic) num_threads(GLOBAL::n_gradient_threads)
+  for (int r = 0; r < n_rules; ++r) {
+    Vector<Real> p;
+    try {
+      ls[r].solve(p);
+    }
+    catch(SVDError& error) {
+      failed[r] = 1;
+      continue;
+    }
+    // /// write p to the consequence parameters of rule r
+    Consequence::iterator pc = frules_[r].cons().begin();
+    Vector<Real>::const_iterator pp = p.begin();
+    while (pc != frules_[r].cons().end()) {
+      *(pc++) = *(pp++);
+    }
+  }
+  // /// the rules without enough samples keep their consequences
+  for (size_t r = 0; r < rdim_; ++r) {
+    if (failed[r]) {
+      SVD_warning(SVDError());
+      break;
+    }
+  }
+}
+
+// //////////////////////////////////////////////////////////////////////
+
+Real 
+FModel::optimize_GRAD_DESCENT(const Data& a, const Data& b, 
+		       size_t min_iterations, size_t max_iterations) {
+  OptimizationState state;
+  return optimize_GRAD_DESCENT(a, b, min_iterations, max_iterations, state);
+}
+
+// //////////////////////////////////////////////////////////////////////
+
+Real 
+FModel::optimize_GRAD_DESCENT(const Data& a, const Data& b, 
+		       size_t min_iterations, size_t max_iterations, 
+		       OptimizationState& state) {
+  assert(frules_.size() > 0);
+  // / cross validate after each N_OPTS_PER_STEP iterations of GRAD_DESCENT
+  if (state.stopped) {
+    return state.b_fitness;
+  }
+  size_t& iteration = state.iteration;
+  size_t first_iteration = iteration;
+  Real& a_fitness = state.a_fitness;
+  Real& b_fitness = state.b_fitness;
+  Real& sum_a_fitness = state.sum_a_fitness;
+  Real& sum_b_fitness = state.sum_b_fitness;
+  struct timeval time_begin;
+  struct timeval time_end;
+  gettimeofday(&time_begin, NULL);
+  while (iteration < max_iterations) {
+    try {
+      Real new_a_fitness = 0.0;
+      Real new_b_fitness = 0.0;
+      Real new_sum_a_fitness = 0.0;
+      Real new_sum_b_fitness = 0.0;
+      size_t k = 0;
+      while (k < GLOBAL::steps_per_validation) {
 	new_a_fitness = GRAD_DESCENT(a);
 	new_b_fitness = estimation(b); // hold out method (cross validation)
 	new_sum_a_fitness += new_a_fitness;
@@ -1050,6 +1511,7 @@ FModel::optimize_GRAD_DESCENT(const Data& a, const Data& b,
 	  GRAD_DESCENT_backstep();
 	  --iteration;
 	  // /// stop optimization
+	  state.stopped = true;
 	  break;
 	}
       }
@@ -1057,21 +1519,28 @@ FModel::optimize_GRAD_DESCENT(const Data& a, const Data& b,
     catch(IncompleteCoverageError& error) {
       string msg = (string)GLOBAL::prgname;
       msg+=(string)": warning from optimize_GRAD_DESCENT(): "+error.msg()+"\n";
-      if ((!GLOBAL::quiet) || (!GLOBAL::logfile)) {
-	cerr << msg << flush;
-      }
-      if (GLOBAL::logfile) {
-	GLOBAL::logfile << msg;
+#pragma omp critical (fzy_output)
+      {
+	if ((!GLOBAL::quiet) || (!GLOBAL::logfile)) {
+	  cerr << msg << flush;
+	}
+	if (GLOBAL::logfile) {
+	  GLOBAL::logfile << msg;
+	}
       }
       GRAD_DESCENT_backstep();
       --iteration;
+      state.stopped = true;
       break;
     } // end catch
   } // end while (iteration < max_iterations) 
   gettimeofday(&time_end, NULL);
   long time_diff = 1000000 * (time_end.tv_sec - time_begin.tv_sec)
     + (time_end.tv_usec - time_begin.tv_usec);
-  long mean_iteration_time = time_diff / (long)iteration;
+  long mean_iteration_time = 0;
+  if (iteration > first_iteration) {
+    mean_iteration_time = time_diff / (long)(iteration - first_iteration);
+  }
   verbose(2, "GRAD_DESCENT iterations", iteration);
   verbose(2, "GRAD_DESCENT mean time per iteration", mean_iteration_time);
   verbose(20, "fitness on training data:", a_fitness);   //#WIN2017 
@@ -1082,16 +1551,21 @@ FModel::optimize_GRAD_DESCENT(const Data& a, const Data& b,
 // //////////////////////////////////////////////////////////////////////
 
 Real 
-FModel::GRAD_DESCENT(const Data& d) throw (Error) {
+FModel::gradients(const Data& d, size_t begin, size_t end, Real* d_cons, 
+		  Real* d_mu, Real* d_sigma, const string& caller) 
+  throw (Error) {
   assert(frules_.size() > 0);
   vector<Real> w(rdim_);
   vector<Real> f(rdim_);
+  vector<Real> F(sdim_);
   Real sum_error = 0.0;
-  vector<Uvector>::const_iterator u = d.U().begin();
-  vector<Real>::const_iterator y = d.y().begin();
+  Umatrix::const_iterator u = d.U().begin() + begin;
+  Umatrix::const_iterator u_end = d.U().begin() + end;
+  vector<Real>::const_iterator y = d.y().begin() + begin;
   // ///// calculate forward step and new gradients 
   // ///// for each u individually
-  while (u != d.U().end()) { // //// for all u
+  while (u != u_end) { // //// for all u
+    fset_values(*u, F);
     Real sum_w = 0.0;
     Real y_hat = 0.0;
     Real difference;
@@ -1103,7 +1577,7 @@ FModel::GRAD_DESCENT(const Data& d) throw (Error) {
       assert(pr != frules_.end());
       assert(pw != w.end());
       assert(pf != f.end());
-      *pw = pr->premvalue(*u);
+      *pw = pr->premvalue(F, fset_begin());
       sum_w += *pw;
       *pf = pr->consvalue(*u);
       y_hat += inference(*pw, *pf);
@@ -1112,7 +1586,7 @@ FModel::GRAD_DESCENT(const Data& d) throw (Error) {
       ++pf;
     } // /// end for all rules 
     if (sum_w <= 0.0) {
-      throw IncompleteCoverageError("FModel::GRAD_DESCENT()");
+      throw IncompleteCoverageError(caller);
     }
     y_hat /= sum_w;
     difference = (*y - y_hat); 
@@ -1130,7 +1604,7 @@ FModel::GRAD_DESCENT(const Data& d) throw (Error) {
     }
     else {
       assert(1==0);
-      throw Error("fatal error in FModel::GRAD_DESCENT: invalid GLOBAL::norm");
+      throw Error("fatal error in " + caller + ": invalid GLOBAL::norm");
     }
     // /// factor for cons
     Real factor_c = factor;
@@ -1152,10 +1626,11 @@ FModel::GRAD_DESCENT(const Data& d) throw (Error) {
 	for (int i=0; i<GLOBAL::local_cons_optimization; ++i) {
 	  factor_r *= *pw;
 	}
-	Consequence::iterator pc = pr->d_cons().begin();
-	Uvector::const_iterator pu = u->begin();
+	Real* pc = d_cons + (pr - frules_.begin()) * cdim_;
+	Real* pc_end = pc + cdim_;
+	Urow::const_iterator pu = u->begin();
 	*(pc++) += factor_r; // * 1.0;     // / c0
-	while (pc != pr->d_cons().end()) { // / c1...cN
+	while (pc != pc_end) { // / c1...cN
 	  *(pc++) += factor_r * *(pu++);
 	}
       } // / end if (w[r] > 0)
@@ -1169,33 +1644,42 @@ FModel::GRAD_DESCENT(const Data& d) throw (Error) {
     while (ps != fsets_.end()) { // /// for all fsets
       Real sum_w_d = 0.0;
       Real sum_fw_d = 0.0;
-      pr = frules_.begin();
-      pw = w.begin();
-      pf = f.begin();
-      int uindex = -1;
-      while (pr != frules_.end()) { // /// for all rules
-	// if (*pw > 0.0) { // / i.e., if w[r] > 0.0
-	Premise::const_iterator pprem = pr->prem().begin();	
-	assert(pprem != pr->prem().end());
-	do { // /// for all clauses in rule r
-	  //#WIN2017 if (*pprem == ps) { // fset ps in premise of rule pr
-	  if (*pprem == &*ps) { // fset ps in premise of rule pr
-	    uindex = (pprem - pr->prem().begin()) / 2;
-	    sum_w_d += *pw;
-	    sum_fw_d += *pf * *pw;
-	  }
-	  ++pprem;
-	} while (pprem != pr->prem().end());
-	// } // /// end if w[r] > 0.0
-	++pr;
-	++pw;
-	++pf;
-      } // /// end for all rules
+      size_t sindex = ps - fsets_.begin();
+      int uindex = fset_uindex_[sindex];
+      vector<size_t>::const_iterator prindex 
+	= fset_rules_.begin() + fset_rules_begin_[sindex];
+      vector<size_t>::const_iterator prindex_end 
+	= fset_rules_.begin() + fset_rules_begin_[sindex+1];
+      assert(prindex != prindex_end);
+      while (prindex != prindex_end) { // /// for all rules using fset ps
+	sum_w_d += w[*prindex];
+	sum_fw_d += f[*prindex] * w[*prindex];
+	++prindex;
+      } // /// end for all rules using fset ps
       // /// compute common factor
       assert(uindex >= 0);
       assert(uindex < (int)udim_);
       Real factor_s = factor * (y_hat*sum_w_d - sum_fw_d);
 #ifdef TRAPEZOIDAL_FSETS
+//       if (ps->sigma() != 0.0) {
+// 	Real left;
+// 	Real right;
+// 	if (ps->sigma() > 0.0) {
+// 	  left = ps->mu() - 0.5 / ps->sigma();
+// 	  right = ps->mu() + 0.5 / ps->sigma();
+// 	}
+// 	else {
+// 	  left = ps->mu() + 0.5 / ps->sigma();
+// 	  right = ps->mu() - 0.5 / ps->sigma();
+// 	}
+// 	if ( ((*u)[uindex] > left) && ((*u)[uindex] < right) ) {
+// 	  factor_s *= 1.0 / ps->F((*u)[uindex]);
+// 	  d_mu[sindex] += factor_s * ( - ps->sigma());
+// 	  d_sigma[sindex] += factor_s * ( - ps->mu() + (*u)[uindex]);
+// 	}
+// 	// else: derivation is 0
+//       }
+//       // else: derivation is 0
       Real fset_value = 0.0;
       int odd_fset = 0;
       FSetContainer::iterator ps_old = fsets_.begin();
@@ -1215,8 +1699,8 @@ FModel::GRAD_DESCENT(const Data& d) throw (Error) {
 	  right = ps->mu() - 0.5 / ps->sigma();
 	}
 	if ( ((*u)[uindex] > left) && ((*u)[uindex] < right) ) {
-	  fset_value = 1.0 / ps->F((*u)[uindex]);
-	  ps->add_d_sigma(factor_s * fset_value * (((*u)[uindex]) - ps->mu()));
+	  fset_value = 1.0 / F[sindex];
+	  d_sigma[sindex] += factor_s * fset_value * (((*u)[uindex]) - ps->mu());
 	}
 	// else: derivation is 0
 	// /// check for equal adjacent mu
@@ -1224,12 +1708,12 @@ FModel::GRAD_DESCENT(const Data& d) throw (Error) {
 	  if (odd_fset) {
 	    if ( ((*u)[uindex] > left) && ((*u)[uindex] < right)
 		 && ((*u)[uindex] > left_old) && ((*u)[uindex] < right_old) ) {
-	      fset_value = 1.0 / ps->F((*u)[uindex]);
+	      fset_value = 1.0 / F[sindex];
 	      Real delta_mu = (factor_s + factor_s_old) 
 		* fset_value *  fset_value_old
 		* (- ps->sigma()) * (- ps_old->sigma());
-	      ps->add_d_mu(delta_mu);
-	      ps_old->add_d_mu(delta_mu);
+	      d_mu[sindex] += delta_mu;
+	      d_mu[ps_old - fsets_.begin()] += delta_mu;
 	    }
 	    odd_fset = 0;
 	  }
@@ -1244,21 +1728,21 @@ FModel::GRAD_DESCENT(const Data& d) throw (Error) {
 	}
 	else {
 	  if ( ((*u)[uindex] > left) && ((*u)[uindex] < right) ) {
-	    ps->add_d_mu(factor_s * fset_value * ( - ps->sigma()));
+	    d_mu[sindex] += factor_s * fset_value * ( - ps->sigma());
 	  }
 	  // else: derivation is 0
 	}
       }
       else { 
-	throw Error("error in FModel::GRAD_DESCENT(): div through sigma == 0");
+	throw Error("error in " + caller + ": division through sigma == 0");
       }
 #else
-    int odd_fset = 0;
-    FSetContainer::iterator ps_old = fsets_.begin();
-    Real factor_s_old = 0.0;
-    Real fset_value_old = 0.0;
-      Real fset_value = (1.0 - ps->F((*u)[uindex]));
-      ps->add_d_sigma(factor_s * fset_value * (ps->mu() - (*u)[uindex]));
+      int odd_fset = 0;
+      FSetContainer::iterator ps_old = fsets_.begin();
+      Real factor_s_old = 0.0;
+      Real fset_value_old = 0.0;
+      Real fset_value = (1.0 - F[sindex]);
+      d_sigma[sindex] += factor_s * fset_value * (ps->mu() - (*u)[uindex]);
       // /// check for equal adjacent mu
       if (GLOBAL::adjacent_equal_mu) {
 	if (odd_fset) {
@@ -1266,8 +1750,8 @@ FModel::GRAD_DESCENT(const Data& d) throw (Error) {
 	  Real delta_mu =  (factor_s + factor_s_old)
 	    * fset_value * fset_value_old 
 	    * ps->sigma() * ps_old->sigma();
-	  ps->add_d_mu(delta_mu);
-	  ps_old->add_d_mu(delta_mu);
+	  d_mu[sindex] += delta_mu;
+	  d_mu[ps_old - fsets_.begin()] += delta_mu;
 	}
 	else {
 	  odd_fset = 1;
@@ -1277,7 +1761,7 @@ FModel::GRAD_DESCENT(const Data& d) throw (Error) {
 	}
       }
       else {
-	ps->add_d_mu(factor_s * fset_value * ps->sigma());
+	d_mu[sindex] += factor_s * fset_value * ps->sigma();
       }
 #endif
       ++ps;
@@ -1285,6 +1769,106 @@ FModel::GRAD_DESCENT(const Data& d) throw (Error) {
     ++u;
     ++y;
   } // /// end for all u
+  return sum_error;
+}
+
+// //////////////////////////////////////////////////////////////////////
+
+Real 
+FModel::accumulate_gradients(const Data& d, const string& caller) 
+  throw (Error) {
+  assert(frules_.size() > 0);
+  size_t n = d.U().size();
+  size_t n_shards = GLOBAL::n_gradient_threads;
+  if (n_shards > n) {
+    n_shards = n;
+  }
+  if (n_shards <= 1) {
+    // /// one shard: accumulate onto the current gradients in place
+    vector<Real> d_cons(rdim_ * cdim_ + 1);
+    vector<Real> d_mu(sdim_ + 1);
+    vector<Real> d_sigma(sdim_ + 1);
+    for (size_t r = 0; r < rdim_; ++r) {
+      for (size_t c = 0; c < cdim_; ++c) {
+	d_cons[r * cdim_ + c] = frules_[r].d_cons(c);
+      }
+    }
+    for (size_t s = 0; s < sdim_; ++s) {
+      d_mu[s] = fsets_[s].d_mu();
+      d_sigma[s] = fsets_[s].d_sigma();
+    }
+    Real sum_error = gradients(d, 0, n, &d_cons[0], &d_mu[0], &d_sigma[0],
+			       caller);
+    for (size_t r = 0; r < rdim_; ++r) {
+      for (size_t c = 0; c < cdim_; ++c) {
+	frules_[r].d_cons(c) = d_cons[r * cdim_ + c];
+      }
+    }
+    for (size_t s = 0; s < sdim_; ++s) {
+      fsets_[s].d_mu() = d_mu[s];
+      fsets_[s].d_sigma() = d_sigma[s];
+    }
+    return sum_error;
+  }
+  // /// several shards: contiguous blocks of samples, each with its own
+  // /// gradient buffers, reduced in shard order afterwards
+  vector< vector<Real> > d_cons(n_shards, vector<Real>(rdim_*cdim_+1, 0.0));
+  vector< vector<Real> > d_mu(n_shards, vector<Real>(sdim_ + 1, 0.0));
+  vector< vector<Real> > d_sigma(n_shards, vector<Real>(sdim_ + 1, 0.0));
+  vector<Real> shard_error(n_shards, 0.0);
+  vector<int> shard_failed(n_shards, 0);
+  vector<string> shard_msg(n_shards);
+#pragma omp parallel for schedule(static, 1) num_threads(n_shards)
+  for (int t = 0; t < (int)n_shards; ++t) {
+    size_t begin = n * t / n_shards;
+    size_t end = n * (t + 1) / n_shards;
+    try {
+      shard_error[t] = gradients(d, begin, end, &d_cons[t][0], &d_mu[t][0],
+				 &d_sigma[t][0], caller);
+    }
+    catch(IncompleteCoverageError& error) {
+      shard_failed[t] = 1;
+    }
+    catch(Error& error) {
+      shard_failed[t] = 2;
+      shard_msg[t] = error.msg();
+    }
+    catch(...) {
+      // /// nothing may leave the parallel region
+      shard_failed[t] = 2;
+      shard_msg[t] = caller + ": unknown error in gradient shard";
+    }
+  }
+  for (size_t t = 0; t < n_shards; ++t) {
+    if (shard_failed[t] == 1) {
+      throw IncompleteCoverageError(caller);
+    }
+    if (shard_failed[t] == 2) {
+      throw Error(shard_msg[t]);
+    }
+  }
+  Real sum_error = 0.0;
+  for (size_t t = 0; t < n_shards; ++t) {
+    for (size_t r = 0; r < rdim_; ++r) {
+      for (size_t c = 0; c < cdim_; ++c) {
+	frules_[r].d_cons(c) += d_cons[t][r * cdim_ + c];
+      }
+    }
+    for (size_t s = 0; s < sdim_; ++s) {
+      fsets_[s].add_d_mu(d_mu[t][s]);
+      fsets_[s].add_d_sigma(d_sigma[t][s]);
+    }
+    sum_error += shard_error[t];
+  }
+  return sum_error;
+}
+
+// //////////////////////////////////////////////////////////////////////
+
+Real 
+FModel::GRAD_DESCENT(const Data& d) throw (Error) {
+  assert(frules_.size() > 0);
+  Real sum_error = accumulate_gradients(d, "FModel::GRAD_DESCENT()");
   // ***** update parameters using GRAD_DESCENT rule
   // / 1. update consequence parameters
   FRuleContainer::const_iterator pr = frules_.begin();
@@ -1398,13 +1982,27 @@ FModel::GRAD_DESCENT_backstep(void) {
 Real 
 FModel::optimize_RPROP(const Data& a, const Data& b, 
 		       size_t min_iterations, size_t max_iterations) {
+  OptimizationState state;
+  return optimize_RPROP(a, b, min_iterations, max_iterations, state);
+}
+
+// //////////////////////////////////////////////////////////////////////
+
+Real 
+FModel::optimize_RPROP(const Data& a, const Data& b, 
+		       size_t min_iterations, size_t max_iterations, 
+		       OptimizationState& state) {
   assert(frules_.size() > 0);
   // / cross validate after each N_OPTS_PER_STEP iterations of RPROP
-  size_t iteration = 0;
-  Real a_fitness = REAL_MAX;
-  Real b_fitness = REAL_MAX;
-  Real sum_a_fitness = REAL_MAX;  
-  Real sum_b_fitness = REAL_MAX;
+  if (state.stopped) {
+    return state.b_fitness;
+  }
+  size_t& iteration = state.iteration;
+  size_t first_iteration = iteration;
+  Real& a_fitness = state.a_fitness;
+  Real& b_fitness = state.b_fitness;
+  Real& sum_a_fitness = state.sum_a_fitness;
+  Real& sum_b_fitness = state.sum_b_fitness;
   struct timeval time_begin;
   struct timeval time_end;
   gettimeofday(&time_begin, NULL);
@@ -1441,6 +2039,7 @@ FModel::optimize_RPROP(const Data& a, const Data& b,
 	  RPROP_backstep();
 	  --iteration;
 	  // /// stop optimization
+	  state.stopped = true;
 	  break;
 	}
       }
@@ -1448,14 +2047,18 @@ FModel::optimize_RPROP(const Data& a, const Data& b,
     catch(IncompleteCoverageError& error) {
       string msg = (string)GLOBAL::prgname;
       msg += (string)": warning from optimize_RPROP(): " + error.msg() + "\n";
-      if ((!GLOBAL::quiet) || (!GLOBAL::logfile)) {
-	cerr << msg << flush;
-      }
-      if (GLOBAL::logfile) {
-	GLOBAL::logfile << msg;
+#pragma omp critical (fzy_output)
+      {
+	if ((!GLOBAL::quiet) || (!GLOBAL::logfile)) {
+	  cerr << msg << flush;
+	}
+	if (GLOBAL::logfile) {
+	  GLOBAL::logfile << msg;
+	}
       }
       RPROP_backstep();
       --iteration;//<<<=== creates compile error on old gcc; if so, comment out
+      state.stopped = true;
       break;
     } // end catch
     catch(...) {
@@ -1467,7 +2070,10 @@ FModel::optimize_RPROP(const Data& a, const Data& b,
   gettimeofday(&time_end, NULL);
   long time_diff = 1000000 * (time_end.tv_sec - time_begin.tv_sec)
     + (time_end.tv_usec - time_begin.tv_usec);
-  long mean_iteration_time = time_diff / (long)iteration;
+  long mean_iteration_time = 0;
+  if (iteration > first_iteration) {
+    mean_iteration_time = time_diff / (long)(iteration - first_iteration);
+  }
   verbose(2, "RPROP iterations", iteration);
   verbose(2, "RPROP mean time per iteration", mean_iteration_time);
   verbose(20, "fitness on training data:", a_fitness);   //#WIN2017 
@@ -1480,226 +2086,7 @@ FModel::optimize_RPROP(const Data& a, const Data& b,
 Real 
 FModel::RPROP(const Data& d) throw (Error) {
   assert(frules_.size() > 0);
-  vector<Real> w(rdim_);
-  vector<Real> f(rdim_);
-  Real sum_error = 0.0;
-  vector<Uvector>::const_iterator u = d.U().begin();
-  vector<Real>::const_iterator y = d.y().begin();
-  // ///// calculate forward step and new gradients 
-  // ///// for each u individually
-  while (u != d.U().end()) { // //// for all u
-    Real sum_w = 0.0;
-    Real y_hat = 0.0;
-    Real difference;
-    FRuleContainer::const_iterator pr = frules_.begin();
-    vector<Real>::iterator pw = w.begin();
-    vector<Real>::iterator pf = f.begin();
-    // /// forward step: calculate w, f, error
-    while (pr != frules_.end()) { // /// for all rules 
-      assert(pr != frules_.end());
-      assert(pw != w.end());
-      assert(pf != f.end());
-      *pw = pr->premvalue(*u);
-      sum_w += *pw;
-      *pf = pr->consvalue(*u);
-      y_hat += inference(*pw, *pf);
-      ++pr;
-      ++pw;
-      ++pf;
-    } // /// end for all rules 
-    if (sum_w <= 0.0) {
-      throw IncompleteCoverageError("FModel::RPROP()");
-    }
-    y_hat /= sum_w;
-    difference = (*y - y_hat); 
-    sum_error += difference * difference;
-    // /// calculate gradients for all parameters
-    Real factor = 1.0;
-    if (GLOBAL::norm == 2) {
-      factor = difference / sum_w;
-    } 
-    else if (GLOBAL::norm == 1) {
-      factor = sign(difference) / sum_w;
-    }
-    else if (GLOBAL::norm == 3) {
-      factor = sign(difference) * difference * difference / sum_w;
-    }
-    else {
-      assert(1==0);
-      throw Error("fatal error in FModel::RPROP(): invalid GLOBAL::norm");
-    }
-    // /// factor for cons
-    Real factor_c = factor;
-    for (int i=0; i<GLOBAL::local_cons_optimization; ++i) {
-      factor_c /= sum_w;
-    }
-    // / 1. calculate consequence parameter gradients
-    pr = frules_.begin();
-    pw = w.begin();
-    pf = f.begin();
-    while (pr != frules_.end()) { // /// for all rules
-      assert(pr != frules_.end());
-      assert(pw != w.end());
-      assert(pf != f.end());
-      // /// for all rules: calculate parameter gradients if w_r > 0
-      if (*pw > 0.0) { // / i.e., if w[r] > 0
-	// / 1. calculate consequence parameter gradients
-	register Real factor_r = -factor_c * *pw;
-	for (int i=0; i<GLOBAL::local_cons_optimization; ++i) {
-	  factor_r *= *pw;
-	}
-	Consequence::iterator pc = pr->d_cons().begin();
-	Uvector::const_iterator pu = u->begin();
-	*(pc++) += factor_r; // * 1.0;     // / c0
-	while (pc != pr->d_cons().end()) { // / c1...cN
-	  *(pc++) += factor_r * *(pu++);
-	}
-      } // / end if (w[r] > 0)
-      // / else: nothing to do (add 0.0 to all gradients)
-      ++pr;
-      ++pw;
-      ++pf;
-    } // /// end for all rules 
-    // / 2. calculate fset parameter gradients
-    FSetContainer::iterator ps = fsets_.begin();
-    while (ps != fsets_.end()) { // /// for all fsets
-      Real sum_w_d = 0.0;
-      Real sum_fw_d = 0.0;
-      pr = frules_.begin();
-      pw = w.begin();
-      pf = f.begin();
-      int uindex = -1;
-      while (pr != frules_.end()) { // /// for all rules
-	// if (*pw > 0.0) { // / i.e., if w[r] > 0.0
-	Premise::const_iterator pprem = pr->prem().begin();	
-	assert(pprem != pr->prem().end());
-	do { // /// for all clauses in rule r
-	  //#WIN2017 if (*pprem == ps) { // fset ps in premise of rule pr
-	  if (*pprem == &*ps) { // fset ps in premise of rule pr
-	    uindex = (pprem - pr->prem().begin()) / 2;
-	    sum_w_d += *pw;
-	    sum_fw_d += *pf * *pw;
-	  }
-	  ++pprem;
-	} while (pprem != pr->prem().end());
-	// } // /// end if w[r] > 0.0
-	++pr;
-	++pw;
-	++pf;
-      } // /// end for all rules
-      // /// compute common factor
-      assert(uindex >= 0);
-      assert(uindex < (int)udim_);
-      Real factor_s = factor * (y_hat*sum_w_d - sum_fw_d);
-#ifdef TRAPEZOIDAL_FSETS
-//       if (ps->sigma() != 0.0) {
-// 	Real left;
-// 	Real right;
-// 	if (ps->sigma() > 0.0) {
-// 	  left = ps->mu() - 0.5 / ps->sigma();
-// 	  right = ps->mu() + 0.5 / ps->sigma();
-// 	}
-// 	else {
-// 	  left = ps->mu() + 0.5 / ps->sigma();
-// 	  right = ps->mu() - 0.5 / ps->sigma();
-// 	}
-// 	if ( ((*u)[uindex] > left) && ((*u)[uindex] < right) ) {
-// 	  factor_s *= 1.0 / ps->F((*u)[uindex]);
-// 	  ps->add_d_mu(factor_s * ( - ps->sigma()));
-// 	  ps->add_d_sigma(factor_s * ( - ps->mu() + (*u)[uindex]));
-// 	}
-// 	// else: derivation is 0
-//       }
-//       // else: derivation is 0
-      Real fset_value = 0.0;
-      int odd_fset = 0;
-      FSetContainer::iterator ps_old = fsets_.begin();
-      Real factor_s_old = 0.0;
-      Real left_old = 0.0;
-      Real right_old = 0.0;
-      Real fset_value_old = 0.0;
-      if (ps->sigma() != 0.0) {
-	Real left;
-	Real right;
-	if (ps->sigma() > 0.0) {
-	  left = ps->mu() - 0.5 / ps->sigma();
-	  right = ps->mu() + 0.5 / ps->sigma();
-	}
-	else {
-	  left = ps->mu() + 0.5 / ps->sigma();
-	  right = ps->mu() - 0.5 / ps->sigma();
-	}
-	if ( ((*u)[uindex] > left) && ((*u)[uindex] < right) ) {
-	  fset_value = 1.0 / ps->F((*u)[uindex]);
-	  ps->add_d_sigma(factor_s * fset_value * (((*u)[uindex]) - ps->mu()));
-	}
-	// else: derivation is 0
-	// /// check for equal adjacent mu
-	if (GLOBAL::adjacent_equal_mu) {
-	  if (odd_fset) {
-	    if ( ((*u)[uindex] > left) && ((*u)[uindex] < right)
-		 && ((*u)[uindex] > left_old) && ((*u)[uindex] < right_old) ) {
-	      fset_value = 1.0 / ps->F((*u)[uindex]);
-	      Real delta_mu = (factor_s + factor_s_old) 
-		* fset_value *  fset_value_old
-		* (- ps->sigma()) * (- ps_old->sigma());
-	      ps->add_d_mu(delta_mu);
-	      ps_old->add_d_mu(delta_mu);
-	    }
-	    odd_fset = 0;
-	  }
-	  else {
-	    odd_fset = 1;
-	    ps_old = ps;
-	    factor_s_old = factor_s;
-	    left_old = left;
-	    right_old = right;
-	    fset_value_old = fset_value;
-	  }
-	}
-	else {
-	  if ( ((*u)[uindex] > left) && ((*u)[uindex] < right) ) {
-	    ps->add_d_mu(factor_s * fset_value * ( - ps->sigma()));
-	  }
-	  // else: derivation is 0
-	}
-      }
-      else { 
-	throw Error("error in FModel::RPROP(): division through sigma == 0");
-      }
-#else
-      int odd_fset = 0;
-      FSetContainer::iterator ps_old = fsets_.begin();
-      Real factor_s_old = 0.0;
-      Real fset_value_old = 0.0;
-      Real fset_value = (1.0 - ps->F((*u)[uindex]));
-      ps->add_d_sigma(factor_s * fset_value * (ps->mu() - (*u)[uindex]));
-      // /// check for equal adjacent mu
-      if (GLOBAL::adjacent_equal_mu) {
-	if (odd_fset) {
-	  odd_fset = 0;
-	  Real delta_mu =  (factor_s + factor_s_old)
-	    * fset_value * fset_value_old 
-	    * ps->sigma() * ps_old->sigma();
-	  ps->add_d_mu(delta_mu);
-	  ps_old->add_d_mu(delta_mu);
-	}
-	else {
-	  odd_fset = 1;
-	  ps_old = ps;
-	  factor_s_old = factor_s;
-	  fset_value_old = fset_value;
-	}
-      }
-      else {
-	ps->add_d_mu(factor_s * fset_value * ps->sigma());
-      }
-#endif
-      ++ps;
-    } // /// end for all fsets 
-    ++u;
-    ++y;
-  } // /// end for all u
+  Real sum_error = accumulate_gradients(d, "FModel::RPROP()");
   // ***** update parameters using RPROP rule
   // / 1. update consequence parameters
   FRuleContainer::const_iterator pr = frules_.begin();
@@ -1888,11 +2275,13 @@ FModel::RPROP_backstep(void) {
 
 // //////////////////////////////////////////////////////////////////////
 
-std::ostream& operator << (std::ostream& strm, const FModel& fmodel)
+void
+FModel::write(std::ostream& strm, int precision) const
 {
+  const FModel& fmodel = *this;
   FRuleContainer::const_iterator pp;
   int original_precision = strm.precision();
-  strm.precision(REAL_DIG);
+  strm.precision(precision);
   strm << "rdim = " << fmodel.rdim_ << endl;
   strm << "udim = " << fmodel.udim_ << endl;
   strm << "cdim = " << fmodel.cdim_ << endl;
@@ -2006,6 +2395,14 @@ std::ostream& operator << (std::ostream& strm, const FModel& fmodel)
   }
   // /// ok, return
   strm.precision(original_precision);
+  return;
+}
+
+// //////////////////////////////////////////////////////////////////////
+
+std::ostream& operator << (std::ostream& strm, const FModel& fmodel)
+{
+  fmodel.write(strm, REAL_DIG);
   return strm;
 }
 
@@ -2025,10 +2422,8 @@ sigmoid(Real x)
   return 1.0 / (1.0 + exp(x)); 
 }
 #else
-Real 
-sigmoid(Real x)
-{ 
-  static Real sigm_tab[] = {
+/// sigmoid lookup table; index: |_ x * 2000/7 _|
+static Real sigm_tab[] = {
     0.500000, 0.499125, 0.498250, 0.497375, 0.496500, 0.495625, 0.494750,
     0.493875, 0.493000, 0.492126, 0.491251, 0.490376, 0.489502, 0.488627,
     0.487752, 0.486878, 0.486004, 0.485129, 0.484255, 0.483381, 0.482507,
@@ -2315,10 +2710,14 @@ sigmoid(Real x)
     0.000974, 0.000970, 0.000967, 0.000963, 0.000960, 0.000957, 0.000953,
     0.000950, 0.000947, 0.000943, 0.000940, 0.000937, 0.000934, 0.000930,
     0.000927, 0.000924, 0.000921, 0.000917, 0.000914, 0.000911, 0.000908 
-  };
-  const Real real_min = 0.00001;
-  // const Real real_min = 16 * REAL_MIN;
-  // const Real real_min = 0.0;
+};
+static const Real real_min = 0.00001;
+// static const Real real_min = 16 * REAL_MIN;
+// static const Real real_min = 0.0;
+
+Real 
+sigmoid(Real x)
+{ 
   if (x < 0.0) { 
     if (x < -7.0) {
       return 1.0 - real_min;
@@ -2339,3 +2738,221 @@ sigmoid(Real x)
 } /// end Real sigmoid(Real x)
 #endif /// #ifdef EXACT_SIGMOID
 
+
+
+/*
+ * **********************************************************************
+ * ********** membership kernels
+ * **********************************************************************
+ */ 
+
+static void
+membership_scalar(Real mu, Real sigma, const Real* u, Real* F, size_t n)
+{
+  for (size_t i = 0; i < n; ++i) {
+#ifdef TRAPEZOIDAL_FSETS
+    F[i] = trapezoid(sigma, (u[i]-mu));
+#else
+    F[i] = sigmoid(sigma * (u[i]-mu));
+#endif
+  }
+}
+
+#ifdef SIMD_MEMBERSHIP
+/*
+ * The kernels reproduce sigmoid() lane by lane: the table index is
+ * computed in double precision like `(unsigned)(x * 285.71)', the
+ * tails beyond |x| > 7 are blended in afterwards.
+ */
+
+__attribute__((target("sse2"))) static void
+membership_sse2(Real mu, Real sigma, const Real* u, Real* F, size_t n)
+{
+  const __m128 vmu = _mm_set1_ps(mu);
+  const __m128 vsigma = _mm_set1_ps(sigma);
+  const __m128 vzero = _mm_setzero_ps();
+  const __m128 vone = _mm_set1_ps(1.0);
+  const __m128 vmax = _mm_set1_ps(7.0);
+  const __m128 vmin = _mm_set1_ps(-7.0);
+  const __m128d vscale = _mm_set1_pd(285.71);
+  int index[4];
+  size_t i = 0;
+  for (; i + 4 <= n; i += 4) {
+    __m128 x = _mm_mul_ps(vsigma, _mm_sub_ps(_mm_loadu_ps(u + i), vmu));
+    __m128 neg = _mm_cmplt_ps(x, vzero);
+    __m128 ax = _mm_min_ps(_mm_andnot_ps(_mm_set1_ps(-0.0), x), vmax);
+    __m128i lo = _mm_cvttpd_epi32(_mm_mul_pd(_mm_cvtps_pd(ax), vscale));
+    __m128i hi = _mm_cvttpd_epi32(_mm_mul_pd(_mm_cvtps_pd(
+					       _mm_movehl_ps(ax, ax)), vscale));
+    _mm_storeu_si128((__m128i*)index, _mm_unpacklo_epi64(lo, hi));
+    __m128 t = _mm_setr_ps(sigm_tab[index[0]], sigm_tab[index[1]], 
+			   sigm_tab[index[2]], sigm_tab[index[3]]);
+    __m128 y = _mm_or_ps(_mm_and_ps(neg, _mm_sub_ps(vone, t)), 
+			 _mm_andnot_ps(neg, t));
+    __m128 above = _mm_cmpgt_ps(x, vmax);
+    __m128 below = _mm_cmplt_ps(x, vmin);
+    y = _mm_or_ps(_mm_and_ps(above, _mm_set1_ps(real_min)),
+		  _mm_andnot_ps(above, y));
+    y = _mm_or_ps(_mm_and_ps(below, _mm_set1_ps(1.0 - real_min)),
+		  _mm_andnot_ps(below, y));
+    _mm_storeu_ps(F + i, y);
+  }
+  membership_scalar(mu, sigma, u + i, F + i, n - i);
+}
+
+__attribute__((target("avx2"))) static void
+membership_avx2(Real mu, Real sigma, const Real* u, Real* F, size_t n)
+{
+  const __m256 vmu = _mm256_set1_ps(mu);
+  const __m256 vsigma = _mm256_set1_ps(sigma);
+  const __m256 vzero = _mm256_setzero_ps();
+  const __m256 vone = _mm256_set1_ps(1.0);
+  const __m256 vmax = _mm256_set1_ps(7.0);
+  const __m256 vmin = _mm256_set1_ps(-7.0);
+  const __m256d vscale = _mm256_set1_pd(285.71);
+  size_t i = 0;
+  for (; i + 8 <= n; i += 8) {
+    __m256 x = _mm256_mul_ps(vsigma, 
+			     _mm256_sub_ps(_mm256_loadu_ps(u + i), vmu));
+    __m256 neg = _mm256_cmp_ps(x, vzero, _CMP_LT_OQ);
+    __m256 ax = _mm256_min_ps(_mm256_andnot_ps(_mm256_set1_ps(-0.0), x), 
+			      vmax);
+    __m128i lo = _mm256_cvttpd_epi32(_mm256_mul_pd(
+		   _mm256_cvtps_pd(_mm256_castps256_ps128(ax)), vscale));
+    __m128i hi = _mm256_cvttpd_epi32(_mm256_mul_pd(
+		   _mm256_cvtps_pd(_mm256_extractf128_ps(ax, 1)), vscale));
+    __m256i index = _mm256_insertf128_si256(_mm256_castsi128_si256(lo), 
+					    hi, 1);
+    __m256 t = _mm256_i32gather_ps(sigm_tab, index, sizeof(Real));
+    __m256 y = _mm256_blendv_ps(t, _mm256_sub_ps(vone, t), neg);
+    y = _mm256_blendv_ps(y, _mm256_set1_ps(real_min), 
+			 _mm256_cmp_ps(x, vmax, _CMP_GT_OQ));
+    y = _mm256_blendv_ps(y, _mm256_set1_ps(1.0 - real_min), 
+			 _mm256_cmp_ps(x, vmin, _CMP_LT_OQ));
+    _mm256_storeu_ps(F + i, y);
+  }
+  membership_scalar(mu, sigma, u + i, F + i, n - i);
+}
+
+/// the zero-masking forms of the AVX-512 intrinsics (also in place of 
+/// _mm512_castps512_ps256()): GCC implements the plain ones with an 
+/// _mm512_undefined_*() source, which GCC 12 reports as maybe 
+/// uninitialized once inlined (-Wmaybe-uninitialized)
+__attribute__((target("avx512f"))) static void
+membership_avx512(Real mu, Real sigma, const Real* u, Real* F, size_t n)
+{
+  const __m512 vmu = _mm512_set1_ps(mu);
+  const __m512 vsigma = _mm512_set1_ps(sigma);
+  const __m512 vzero = _mm512_setzero_ps();
+  const __m512 vone = _mm512_set1_ps(1.0);
+  const __m512 vmax = _mm512_set1_ps(7.0);
+  const __m512 vmin = _mm512_set1_ps(-7.0);
+  const __m512d vscale = _mm512_set1_pd(285.71);
+  size_t i = 0;
+  for (; i + 16 <= n; i += 16) {
+    __m512 x = _mm512_mul_ps(vsigma, 
+			     _mm512_sub_ps(_mm512_loadu_ps(u + i), vmu));
+    __m512 ax = _mm512_maskz_min_ps(0xffff, _mm512_abs_ps(x), vmax);
+    __m256i lo = _mm512_maskz_cvttpd_epi32(0xff, _mm512_mul_pd(
+		   _mm512_maskz_cvtps_pd(0xff, _mm256_castpd_ps(
+		     _mm512_maskz_extractf64x4_pd(0xf, _mm512_castps_pd(ax), 0))),
+		   vscale));
+    __m256i hi = _mm512_maskz_cvttpd_epi32(0xff, _mm512_mul_pd(
+		   _mm512_maskz_cvtps_pd(0xff, _mm256_castpd_ps(
+		     _mm512_maskz_extractf64x4_pd(0xf, _mm512_castps_pd(ax), 1))),
+		   vscale));
+    __m512i index = _mm512_maskz_inserti64x4(0xff, 
+					     _mm512_castsi256_si512(lo), hi, 1);
+    __m512 t = _mm512_mask_i32gather_ps(vzero, 0xffff, index, sigm_tab, 
+					sizeof(Real));
+    __m512 y = _mm512_mask_sub_ps(t, _mm512_cmp_ps_mask(x, vzero, _CMP_LT_OQ),
+				  vone, t);
+    y = _mm512_mask_mov_ps(y, _mm512_cmp_ps_mask(x, vmax, _CMP_GT_OQ), 
+			   _mm512_set1_ps(real_min));
+    y = _mm512_mask_mov_ps(y, _mm512_cmp_ps_mask(x, vmin, _CMP_LT_OQ), 
+			   _mm512_set1_ps(1.0 - real_min));
+    _mm512_storeu_ps(F + i, y);
+  }
+  membership_scalar(mu, sigma, u + i, F + i, n - i);
+}
+
+#endif /// #ifdef SIMD_MEMBERSHIP
+
+static const char* membership_kernel_name = "scalar";
+
+/// the membership kernels, widest first, and whether the CPU has them
+static size_t
+membership_kernels(const char** name, MembershipKernel* kernel,
+		   bool* supported)
+{
+  size_t n = 0;
+#ifdef SIMD_MEMBERSHIP
+  __builtin_cpu_init();
+  name[n] = "avx512f";
+  kernel[n] = membership_avx512;
+  supported[n++] = (__builtin_cpu_supports("avx512f") != 0);
+  name[n] = "avx2";
+  kernel[n] = membership_avx2;
+  supported[n++] = (__builtin_cpu_supports("avx2") != 0);
+  name[n] = "sse2";
+  kernel[n] = membership_sse2;
+  supported[n++] = (__builtin_cpu_supports("sse2") != 0);
+#endif /// #ifdef SIMD_MEMBERSHIP
+  name[n] = "scalar";
+  kernel[n] = membership_scalar;
+  supported[n++] = true;
+  return n;
+}
+
+/// choose the widest kernel this CPU supports
+static MembershipKernel
+membership_select(void)
+{
+  const char* name[4];
+  MembershipKernel kernel[4];
+  bool supported[4];
+  size_t n = membership_kernels(name, kernel, supported);
+  for (size_t k = 0; k < n; ++k) {
+    if (supported[k]) {
+      membership_kernel_name = name[k];
+      return kernel[k];
+    }
+  }
+  return membership_scalar;
+}
+
+/// the kernel in use, selected on first call
+static MembershipKernel
+membership_dispatch(void)
+{
+  static const MembershipKernel kernel = membership_select();
+  return kernel;
+}
+
+void
+membership(Real mu, Real sigma, const Real* u, Real* F, size_t n)
+{
+  membership_dispatch()(mu, sigma, u, F, n);
+}
+
+const char*
+membership_kernel(void)
+{
+  membership_dispatch();
+  return membership_kernel_name;
+}
+
+MembershipKernel
+membership_kernel(const char* name)
+{
+  const char* names[4];
+  MembershipKernel kernel[4];
+  bool supported[4];
+  size_t n = membership_kernels(names, kernel, supported);
+  for (size_t k = 0; k < n; ++k) {
+    if (strcmp(names[k], name) == 0) {
+      return supported[k] ? kernel[k] : NULL;
+    }
+  }
+  return NULL;
+}
@@ -31,6 +31,7 @@
 #ifndef WIN2017
 #include <vector.h>  // STL vectors
 #include <vec.h>     // TNT vectors
+#include <cmat.h>    // TNT matrices
 #else
 #include <vector>    // STL vectors
 #include <tnt.h>     // TNT vectors
@@ -71,6 +72,46 @@ inline Real trapezoid(Real sigma, Real u) {
  */
 Real sigmoid(Real x);
 
+#if defined(FLOAT) && !defined(EXACT_SIGMOID) && !defined(TRAPEZOIDAL_FSETS) \
+  && defined(__GNUC__) && (__GNUC__ >= 5) \
+  && (defined(__x86_64__) || (defined(__i386__) && defined(__SSE2__)))
+/// vectorized membership kernels with runtime CPU dispatch
+#define SIMD_MEMBERSHIP
+#endif
+
+/** Membership values of a fuzzy set for a column of inputs.
+ *
+ * Computes #F[i] = sigmoid(sigma * (u[i] - mu))# (or the trapezoid)
+ * for #i < n#. On x86-64, and on 32 bit x86 built with SSE2 (see 
+ * SIMD_MEMBERSHIP), the widest of the AVX-512, AVX2 and SSE2
+ * kernels the CPU supports is chosen at the first call. The kernels
+ * agree with the scalar sigmoid() up to rounding (see the check program
+ * tests/check_membership.cc, #make check#).
+ *
+ * @memo
+ * @param mu center of the fuzzy set
+ * @param sigma steepness of the fuzzy set
+ * @param u input column
+ * @param F output column
+ * @param n column length
+ */
+void membership(Real mu, Real sigma, const Real* u, Real* F, size_t n);
+
+/** Name of the membership kernel in use.
+ * @memo
+ */
+const char* membership_kernel(void);
+
+/// signature of a membership kernel, see membership()
+typedef void (*MembershipKernel)(Real, Real, const Real*, Real*, size_t);
+
+/** Membership kernel by name: "avx512f", "avx2", "sse2", or "scalar".
+ * @memo
+ * @return the kernel, or NULL if it is not compiled in or the CPU
+ * does not support it
+ */
+MembershipKernel membership_kernel(const char* name);
+
 /** Product t-norm.
  * @memo
  */
@@ -248,11 +289,11 @@ public:
   /// copy a Fuzzy Rule by value
   void copy(const FRule& r, FSet* fset_begin, const FSet* r_fset_begin);
   /// compute a Fuzzy Rule's consequence value for a given input vector
-  Real consvalue(const Uvector& u) const {
+  Real consvalue(const Urow& u) const {
     assert(cons_.size() > 0);
     assert(cons_.size() <= u.size()+1);
     Consequence::const_iterator pcons = cons_.begin();
-    Uvector::const_iterator pu = u.begin();
+    Urow::const_iterator pu = u.begin();
     assert(pcons != NULL);
     register Real consvalue = *(pcons++);
     while (pcons != cons_.end()) {
@@ -262,11 +303,11 @@ public:
     return consvalue;
   }
   /// compute a Fuzzy Rule's premise value for a given input vector
-  Real premvalue(const Uvector& u) const {
+  Real premvalue(const Urow& u) const {
     assert(prem_.size() == 2U * u.size());
     assert(prem_.size() > 0);
     Premise::const_iterator pprem = prem_.begin();
-    Uvector::const_iterator pu = u.begin();
+    Urow::const_iterator pu = u.begin();
     register Real premvalue = 1.0;
     assert(pprem != prem_.end());
     do {
@@ -284,6 +325,21 @@ public:
     } while (pprem != prem_.end());
     return premvalue;
   }
+  /// compute a Fuzzy Rule's premise value from the membership values
+  /// F of all fsets (see FModel::fset_values())
+  Real premvalue(const vector<Real>& F, const FSet* fset_begin) const {
+    assert(prem_.size() > 0);
+    Premise::const_iterator pprem = prem_.begin();
+    register Real premvalue = 1.0;
+    do {
+      if (*pprem != NULL) {
+	assert((size_t)(*pprem - fset_begin) < F.size());
+	premvalue *= F[*pprem - fset_begin];
+      }
+      ++pprem;
+    } while (pprem != prem_.end());
+    return premvalue;
+  }
   /// refine a Fuzzy Rule in uindex u; save additional new rule under FRule* r
   void refine(FRule* r, size_t u, FSet* newleftfset, FSet* newrightfset);
 };
@@ -308,6 +364,98 @@ typedef vector<FSet> FSetContainer;
  */
 typedef vector<FRule> FRuleContainer;
 
+/** The last outputs $\hat{y}(t-1), \ldots, \hat{y}(t-order)$ of a 
+ * simulation, newest first, in a ring buffer of 2 order Reals that holds 
+ * each output twice: the window window()[0], ..., window()[order-1] is 
+ * contiguous, and a step writes two Reals instead of shifting all.
+ * @memo output history of a simulation
+ */
+class OutputHistory
+{
+  vector<Real> ring_;
+  size_t order_;
+  /// position of the newest output
+  size_t head_;
+public:
+  OutputHistory() : order_(0), head_(0) { }
+  /// no history yet
+  bool empty() const { return order_ == 0; }
+  size_t order() const { return order_; }
+  /// start with the outputs y[0], ..., y[order-1], newest first
+  template <class Iterator>
+  void assign(Iterator y, size_t order) {
+    assert(order > 0);
+    order_ = order;
+    ring_.resize(2 * order);
+    head_ = 0;
+    for (size_t j = 0; j < order; ++j) {
+      ring_[j] = ring_[j + order] = y[j];
+    }
+  }
+  /// add the newest output y; the oldest one drops out
+  void push(Real y) {
+    assert(order_ > 0);
+    head_ = ((head_ == 0) ? order_ : head_) - 1;
+    ring_[head_] = ring_[head_ + order_] = y;
+  }
+  /// the outputs, newest first (order Reals)
+  const Real* window() const { return &ring_[head_]; }
+};
+
+/** State of an estimation or simulation that runs over the rows of a
+ * data file chunk by chunk (see FModel::estimation(const Data&, 
+ * std::ostream*, PredictionState&)).
+ * @memo state of a chunked estimation or simulation
+ */
+struct PredictionState 
+{
+  /// sum of the squared (scaled) errors
+  Real sum_error;
+  /// rows printed since the last blank line
+  size_t blockline;
+  /// Page-Hinkley test
+  Real U_t;
+  Real T_t;
+  Real m_t;
+  Real M_t;
+  /// simulation: the last $\hat{y}$ and the outputs before (empty before
+  /// the first row)
+  Real yhat;
+  OutputHistory history;
+  PredictionState() 
+    : sum_error(0.0), blockline(0), U_t(0.0), T_t(0.0), m_t(0.0), M_t(0.0),
+      yhat(0.0) { }
+};
+
+/** State of an optimization with early stopping (see
+ * FModel::optimize_RPROP()) that continues over several calls, as the
+ * rounds of a race of candidate models do: the iterations so far and
+ * the fitness sums the next validation window is compared with.
+ * @memo state of a continued optimization
+ */
+struct OptimizationState
+{
+  /// iterations of all calls so far
+  size_t iteration;
+  /// fitness on the learning and validation data after the last
+  /// successful validation window
+  Real a_fitness;
+  Real b_fitness;
+  /// sums of the fitness over the last successful validation window
+  Real sum_a_fitness;
+  Real sum_b_fitness;
+  /// the validation error stopped improving: the model is at its
+  /// validation minimum and further calls leave it unchanged
+  bool stopped;
+  OptimizationState()
+    : iteration(0), a_fitness(REAL_MAX), b_fitness(REAL_MAX),
+      sum_a_fitness(REAL_MAX), sum_b_fitness(REAL_MAX), stopped(false) { }
+};
+
+
+class StreamingLeastSquares;
+class SplitLeastSquares;
+
 /** Fuzzy Model.
  * @memo
  */
@@ -328,6 +476,12 @@ protected:
   vector<size_t> history_;
   /// the model's Fuzzy Sets
   FSetContainer fsets_;
+  /// input index of each Fuzzy Set
+  vector<size_t> fset_uindex_;
+  /// rules with Fuzzy Set s in their premise, in ascending order: 
+  /// fset_rules_[fset_rules_begin_[s]] ... fset_rules_[fset_rules_begin_[s+1]-1]
+  vector<size_t> fset_rules_begin_;
+  vector<size_t> fset_rules_;
   /// the models Fuzzy Rules
   FRuleContainer frules_;
   /// name of the learning/training data file 
@@ -340,6 +494,45 @@ protected:
   vector<SigmaParam> sigma_;
   Data *learn_data_;
   Data *valid_data_;
+  /// rebuild fset_uindex_ and the fset-to-rule index from the premises
+  void index_fsets(void);
+  /// add the gradients of the samples [begin, end) to d_cons (rdim x cdim),
+  /// d_mu and d_sigma (sdim); returns $\sum (y - \hat{y})^2$
+  Real gradients(const Data& d, size_t begin, size_t end, Real* d_cons, 
+		 Real* d_mu, Real* d_sigma, const string& caller) throw (Error);
+  /// add the gradients of all samples to the model's, in 
+  /// GLOBAL::n_gradient_threads shards; returns $\sum (y - \hat{y})^2$
+  Real accumulate_gradients(const Data& d, const string& caller) 
+    throw (Error);
+  /// least squares consequence parameters of the problem y = A * p
+  void solve_SVD(const Matrix<Real>& A, const Vector<Real>& y) 
+    throw (Error);
+  /// matrix A and right hand side y of the consequences' least squares
+  /// problem y = A * p for the premise values w of all samples of d
+  void build_LS(const Data& d, const vector<Real>& w, Matrix<Real>& A, 
+		Vector<Real>& y) throw (Error);
+  /// the consequences' least squares problem y = A * p of the samples 
+  /// of d, with the rows of A still to be set (see set_LS_rows())
+  void new_LS(const Data& d, Matrix<Real>& A, Vector<Real>& y);
+  /// set the rows of A of the samples d[first..] with premise values w
+  /// (rdim per sample)
+  void set_LS_rows(Matrix<Real>& A, const Data& d, size_t first,
+		   const vector<Real>& w) throw (Error);
+  /// write the least squares solution p to the consequence parameters
+  void set_consequences(const Vector<Real>& p);
+  /// add the samples d[first..] with premise values w (rdim per sample)
+  /// to the consequences' least squares problem ls
+  void add_LS_rows(StreamingLeastSquares& ls, const Data& d, size_t first,
+		   const vector<Real>& w) throw (Error);
+  /// solve ls and write the solution to the consequence parameters
+  void solve_LS(const StreamingLeastSquares& ls);
+  /// add the samples d[first..] with premise values w (rdim per sample),
+  /// weighted by the normalized premise values, to the local least 
+  /// squares problem ls[r] of each rule r (cdim columns)
+  void add_local_LS_rows(vector<StreamingLeastSquares>& ls, const Data& d,
+			 size_t first, const vector<Real>& w) throw (Error);
+  /// solve ls[r] and write the solution to the consequence of rule r
+  void solve_local_LS(const vector<StreamingLeastSquares>& ls);
   /// check border of $\Delta$ c
   inline void limit_delta_cons(Consequence::iterator& p) {
     if (*p > max_delta_cons)
@@ -393,9 +586,23 @@ public:
   FModel(const FModel& oldmodel, size_t ruleindex, size_t uindex);
   /// load a model from file
   void load(char* filename) throw (Error);
+  /// load a model from an open file, named filename in error messages
+  void load(FILE* file, const string& filename) throw (Error);
 
+  /// first Fuzzy Set (NULL for a model without fsets)
+  const FSet* fset_begin() const { 
+    return fsets_.empty() ? NULL : &fsets_[0]; 
+  }
+  /// compute the membership values of all fsets, each once
+  void fset_values(const Urow& u, vector<Real>& F) {
+    assert(fset_uindex_.size() == sdim_);
+    F.resize(sdim_);
+    for (size_t s = 0; s < sdim_; ++s) {
+      F[s] = fsets_[s].F(u[fset_uindex_[s]]);
+    }
+  }
   /// w = sum(premise values)
-  Real sum_w(const Uvector& u) {
+  Real sum_w(const Urow& u) {
     assert(frules_.size() > 0);
     FRuleContainer::const_iterator pfrule = frules_.begin();
     register Real sum_premvalues = 0.0;
@@ -405,10 +612,27 @@ public:
     return sum_premvalues;
   }
   /// feedforward step; returns $\hat{y}$
-  Real y_hat(const Uvector& u) throw (Error);
+  Real y_hat(const Urow& u) throw (Error) {
+    vector<Real> F;
+    return y_hat(u, F);
+  }
+  /// feedforward step using F as scratch for the fset values
+  Real y_hat(const Urow& u, vector<Real>& F) throw (Error);
 
+  /// premise values of all rules for all samples of d, row by row
+  void premvalues(const Data& d, vector<Real>& w);
   /// optimize consequence parameters using SVD
   void optimize_SVD(const Data& d) throw (Error);
+  /// optimize consequence parameters using SVD; the model refines rule r
+  /// of a parent model with premise values parent_w on d; parent_ls, if
+  /// not NULL, is the parent's decomposed problem (see split_LS())
+  void optimize_SVD(const Data& d, const vector<Real>& parent_w, size_t r,
+		    const SplitLeastSquares* parent_ls = NULL) throw (Error);
+  /// decomposed least squares problem of the consequences on d with
+  /// premise values w, for the models refining this one; NULL if it is 
+  /// rank deficient. The caller deletes it.
+  SplitLeastSquares* split_LS(const Data& d, const vector<Real>& w) 
+    throw (Error);
   /// reset consequence parameters
   void reset_consequences(void);
   /// initialize model for RPROP
@@ -420,6 +644,11 @@ public:
   /// optimize model by cross validation; returns last error
   Real optimize_RPROP(const Data& a, const Data& b, 
 		      size_t min_iterations, size_t max_iterations);
+  /// optimize model by cross validation, continuing state;
+  /// max_iterations counts the iterations of all calls
+  Real optimize_RPROP(const Data& a, const Data& b,
+		      size_t min_iterations, size_t max_iterations,
+		      OptimizationState& state);
 
   /// initialize model for GRAD_DESCENT
   void GRAD_DESCENT_init(void);
@@ -430,9 +659,18 @@ public:
   /// optimize model by cross validation; returns last error
   Real optimize_GRAD_DESCENT(const Data& a, const Data& b,
 			     size_t min_iterations, size_t max_iterations);
+  /// optimize model by cross validation, continuing state (see
+  /// optimize_RPROP())
+  Real optimize_GRAD_DESCENT(const Data& a, const Data& b,
+			     size_t min_iterations, size_t max_iterations,
+			     OptimizationState& state);
 
   /// estimation error; returns R2
   Real R2(const Data& d);
+  /// R2 from the variances of the estimation errors and of y
+  static Real R2(Real variance_error, Real variance_y);
+  /// the estimation errors $y - \hat{y}$ of all rows of d, as used by R2()
+  void estimation_errors(const Data& d, vector<Real>& error_vect);
   /// determine index of rule with biggest approximation error
   size_t worst_rule_index(const Data& d) throw (Error);
   /// estimation error; returns $\varepsilon = (y - \hat{y})^2$
@@ -441,12 +679,30 @@ public:
   }
   /// write estimation into a file; returns estimation error
   Real estimation(const Data& d, const char* outfilename) throw (Error);
+  /** Estimation of the rows of d, one chunk of a data file: continues
+   *  state and writes into file (unless NULL) as the rows of the whole 
+   *  file.
+   * @memo estimation of a chunk of a data file
+   */
+  void estimation(const Data& d, std::ostream* file, PredictionState& state)
+    throw (Error);
+  /// estimation error of a model that refines rule r of a parent model
+  /// with premise values parent_w on d; only the two new rules are
+  /// evaluated
+  Real estimation(const Data& d, const vector<Real>& parent_w, size_t r)
+    throw (Error);
   /// simulation error; returns simulation error
   Real simulation(const Data& d) throw (Error) {
     return simulation(d, NULL);
   }
   /// write simulation into a file; returns simulation error
   Real simulation(const Data& d, const char* outfilename) throw (Error);
+  /// simulation of the rows of d, one chunk of a data file (see 
+  /// estimation(const Data&, std::ostream*, PredictionState&))
+  void simulation(const Data& d, std::ostream* file, PredictionState& state)
+    throw (Error);
+  /// print the whole model to an output stream, with precision digits
+  void write(std::ostream& strm, int precision) const;
   /// print the whole model to an output stream
   friend std::ostream& operator << (std::ostream& strm, const FModel& fmodel);
 
@@ -122,6 +122,10 @@ init: rdim udim cdim sdim worst_rule {
   history.resize(sdim);
   fsetvect.resize(8);
   consvect.resize(4 * cdim);
+  /* reset the counters of a previously parsed model */
+  fsetindex = 0;
+  consindex = 0;
+  ruleindex = 0;
   ((FModel*)fmodel)->worst_rule() = worst_rule; 
 };
 
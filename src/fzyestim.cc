@@ -26,20 +26,484 @@
 
 
 #include <time.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <errno.h>
+#ifndef WIN2017
+#include <signal.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#endif
 
 #include "global.hh"
 #include "fmodel.hh"
+#include "cmodel.hh"
 #include "data.hh"
 
 #include "fzyestim.hh"
 
 
+/// throws an Error unless the data (n_rows rows of udim inputs) fit to 
+/// fmodel
+static void
+check_data(const FModel& fmodel, size_t n_rows, size_t udim) throw (Error) {
+  if (n_rows < 1) {
+    string msg = "loaded data file contains no values!";
+    throw(Error(msg));
+  }
+
+  // check if model fits to data
+  if (GLOBAL::consequence_dimension > 1 + udim) {
+    throw(ConsdimError(itos(GLOBAL::consequence_dimension), 
+		       itos(1 + udim)));
+  }
+  if (fmodel.udim() != udim) {
+    string msg = "loded model has another udim than loaded data";
+    throw(Error(msg));
+  }
+}
+
+
+/** Estimation (or simulation) of the data file datafilename, read and 
+ * written chunk by chunk, i.e., in the memory of one chunk.
+ *
+ * The results are those of FModel::estimation() (or simulation()) and
+ * FModel::R2() for the whole file: the chunks are whole blocks of the
+ * CModel kernels, the PredictionState carries the error sum, the 
+ * Page-Hinkley test and the recurrency over from chunk to chunk, and 
+ * all sums are accumulated in the same order. The data file is read 
+ * twice (the scan of the DataReader and the estimation); the errors
+ * for R2 go through a temporary file.
+ * @return R2; error is the RMS error
+ * @memo estimation of a data file chunk by chunk
+ */
+static Real
+fzyestim_stream(FModel& fmodel, char* datafilename, 
+		const string& outfilename, Real& error) throw (Error) {
+  DataReader reader(datafilename);
+  check_data(fmodel, reader.n_rows(), reader.udim());
+  size_t chunk_rows = (GLOBAL::stream_rows + CModel::block - 1) 
+    / CModel::block * CModel::block;
+  bool simulation = (GLOBAL::mode == SIMULATION);
+  // /// no simulation for an invalid order (see FModel::simulation())
+  bool run = (! simulation) 
+    || ((GLOBAL::order > 0) && (GLOBAL::order < (int)reader.udim()));
+  ofstream file;
+  if (run) {
+    file.open(outfilename.c_str());
+    if (!file) {
+      throw FileOpenError(outfilename);
+    }
+    file << "### data file: \"" << reader.filename() << "\"\n" << flush;
+  }
+  FILE* error_file = tmpfile();
+  if (error_file == NULL) {
+    throw Error("cannot create a temporary file for the errors!");
+  }
+  size_t n_rows = reader.n_rows();
+  Real mean_y = reader.mean_y();
+  Real variance_y = 0.0;
+  Real mean_error = 0.0;
+  Real variance_error = 0.0;
+  PredictionState state;
+  try {
+    Data chunk;
+    vector<Real> errors;
+    while (reader.read(chunk, chunk_rows)) {
+      if (run && simulation) {
+	fmodel.simulation(chunk, &file, state);
+      }
+      else if (run) {
+	fmodel.estimation(chunk, &file, state);
+      }
+      // /// variance of y (as Data::load()) and errors (as R2())
+      vector<Real>::const_iterator py = chunk.y().begin();
+      while (py != chunk.y().end()) {
+	Real difference = *(py++) - mean_y;
+	variance_y += difference * difference;
+      }
+      fmodel.estimation_errors(chunk, errors);
+      vector<Real>::const_iterator perror = errors.begin();
+      while (perror != errors.end()) {
+	mean_error += *(perror++);
+      }
+      if (fwrite(&errors[0], sizeof(Real), errors.size(), error_file) 
+	  != errors.size()) {
+	throw Error("error writing the temporary file for the errors!");
+      }
+    }
+    variance_y /= (Real)n_rows;
+    mean_error /= n_rows;
+    rewind(error_file);
+    errors.resize(chunk_rows);
+    size_t n;
+    while ((n = fread(&errors[0], sizeof(Real), errors.size(), error_file))
+	   > 0) {
+      for (size_t i = 0; i < n; ++i) {
+	Real difference = errors[i] - mean_error;
+	variance_error += difference * difference;
+      }
+    }
+    variance_error /= n_rows;
+  }
+  catch(...) {
+    fclose(error_file);
+    throw;
+  }
+  fclose(error_file);
+  if (run) {
+    file.close();
+    error = sqrt(state.sum_error / n_rows);
+  }
+  else {
+    error = REAL_MAX;
+  }
+  return FModel::R2(variance_error, variance_y);
+}
+
+
+/** Histogram of latencies on a logarithmic scale: 16 buckets per power 
+ * of two nanoseconds, i.e., quantiles to within 2^(1/16) - 1 = 4.4 %, in
+ * a fixed array (no allocation per sample).
+ * @memo latency histogram
+ */
+class LatencyHistogram
+{
+  static const int per_octave = 16;
+  static const int n_octaves = 48;
+  size_t count_[per_octave * n_octaves];
+  size_t n_;
+  double sum_;
+  double max_;
+public:
+  LatencyHistogram() : n_(0), sum_(0.0), max_(0.0) {
+    memset(count_, 0, sizeof(count_));
+  }
+  size_t n() const { return n_; }
+  double mean() const { return (n_ > 0) ? sum_ / n_ : 0.0; }
+  double max() const { return max_; }
+  /// add a latency of ns nanoseconds
+  void add(double ns) {
+    int octave;
+    double m = frexp((ns < 1.0) ? 1.0 : ns, &octave); // ns = m 2^octave
+    int k = (octave - 1) * per_octave + (int)((2.0 * m - 1.0) * per_octave);
+    if (k >= per_octave * n_octaves) {
+      k = per_octave * n_octaves - 1;
+    }
+    ++count_[k];
+    ++n_;
+    sum_ += ns;
+    if (max_ < ns) {
+      max_ = ns;
+    }
+  }
+  /// q-quantile (0 < q <= 1): the center of its bucket
+  double quantile(double q) const {
+    size_t rank = (size_t)ceil(q * n_);
+    size_t sum = 0;
+    for (int k = 0; k < per_octave * n_octaves; ++k) {
+      sum += count_[k];
+      if ((sum >= rank) && (sum > 0)) {
+	double lower = ldexp(1.0 + (k % per_octave) / (double)per_octave, 
+			     k / per_octave);
+	return lower * (1.0 + 0.5 / per_octave);
+      }
+    }
+    return 0.0;
+  }
+};
+
+
+#ifndef WIN2017
+/// set by SIGINT and SIGTERM: stop serving
+static volatile sig_atomic_t serve_stop = 0;
+
+static void
+serve_signal(int) {
+  serve_stop = 1;
+}
+
+
+static double
+nanoseconds(const struct timespec& t) {
+  return t.tv_sec * 1e9 + t.tv_nsec;
+}
+
+
+/** Answer the patterns read from in_fd on out_fd, line by line, until 
+ *  the end of the input or serve_stop (see fzyestim_serve()); a last 
+ *  line without a newline is answered at the end of the input.
+ *  Input and output go through fixed buffers, the model is evaluated 
+ *  by CModel::y_hat(const Urow&, vector<Real>&) on preallocated scratch,
+ *  i.e., no memory is allocated per pattern.
+ * @return false if the output failed (e.g., the client has gone)
+ * @memo serve one client
+ */
+static bool
+serve_patterns(const CModel& cmodel, const vector<Real>& factor, 
+	       const vector<Real>& shift, int in_fd, int out_fd, 
+	       LatencyHistogram& latency) {
+  const size_t udim = cmodel.udim();
+  const bool scale = GLOBAL::denormalize;
+  vector<Real> u(udim);
+  vector<Real> F;
+  F.reserve(cmodel.sdim() + 2 * cmodel.rdim());
+  Urow urow(&u[0], udim);
+  const size_t buffer_size = 1 << 16;
+  vector<char> in(buffer_size + 1);
+  char out[256];
+  size_t n_in = 0;       // bytes in in
+  bool skip = false;     // skip the rest of an overlong line
+  while (! serve_stop) {
+    ssize_t n_read = read(in_fd, &in[n_in], buffer_size - n_in);
+    if (n_read < 0) {
+      if (errno == EINTR) {
+	continue;
+      }
+      return true;
+    }
+    bool at_end = (n_read == 0);
+    if (at_end) {
+      if ((n_in == 0) && ! skip) {
+	return true;
+      }
+      // /// end the last line
+      in[n_in] = '\n';
+      n_read = 1;
+    }
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    n_in += n_read;
+    char* line = &in[0];
+    char* end = &in[0] + n_in;
+    char* newline;
+    while ((newline = (char*)memchr(line, '\n', end - line)) != NULL) {
+      *newline = '\0';
+      int n_out = 0;
+      if (skip) {
+	skip = false;
+	n_out = snprintf(out, sizeof(out), "error: line too long\n");
+      }
+      else {
+	// /// parse the inputs (and an optional y, which is ignored)
+	char* p = line;
+	while ((*p == ' ') || (*p == '\t') || (*p == '\r')) {
+	  ++p;
+	}
+	if ((*p == '\0') || (*p == '#')) {
+	  line = newline + 1;
+	  continue;
+	}
+	size_t n_values = 0;
+	bool valid = true;
+	while (valid) {
+	  char* next;
+	  double x = strtod(p, &next);
+	  if (next == p) {
+	    while ((*p == ' ') || (*p == '\t') || (*p == '\r')) {
+	      ++p;
+	    }
+	    valid = (*p == '\0');
+	    break;
+	  }
+	  if (n_values < udim) {
+	    u[n_values] = scale 
+	      ? normalization(x, factor[n_values], shift[n_values]) : x;
+	  }
+	  ++n_values;
+	  p = next;
+	}
+	if (! valid || (n_values < udim) || (n_values > udim + 1)) {
+	  n_out = snprintf(out, sizeof(out), 
+			   "error: expected %lu input values\n", 
+			   (unsigned long)udim);
+	}
+	else {
+	  try {
+	    Real yhat = cmodel.y_hat(urow, F);
+	    if (scale) {
+	      yhat = denormalization(yhat, factor[udim], shift[udim]);
+	    }
+	    n_out = snprintf(out, sizeof(out), "%g\n", (double)yhat);
+	  }
+	  catch (IncompleteCoverageError&) {
+	    n_out = snprintf(out, sizeof(out), 
+			     "error: input not covered by the model\n");
+	  }
+	}
+      }
+      if (write(out_fd, out, n_out) != n_out) {
+	return false;
+      }
+      struct timespec stop;
+      clock_gettime(CLOCK_MONOTONIC, &stop);
+      latency.add(nanoseconds(stop) - nanoseconds(start));
+      start = stop;
+      line = newline + 1;
+    }
+    if (at_end) {
+      return true;
+    }
+    // /// keep the incomplete line
+    n_in = end - line;
+    if (n_in == buffer_size) {
+      skip = true;
+      n_in = 0;
+    }
+    else {
+      memmove(&in[0], line, n_in);
+    }
+  }
+  return true;
+}
+#endif
+
+
+/** Serve one-step estimations of fmodel: read input vectors, one per 
+ * line, from stdin (or from the clients of the Unix domain socket 
+ * GLOBAL::serve_socket, one after the other), and answer each with 
+ * $\hat{y}$ on a line of its own, or with a line "error: ...".
+ * With GLOBAL::denormalize, the inputs are normalized and $\hat{y}$ is 
+ * denormalized by the scale of the data file datafilename, of which 
+ * only the head and the first row are read.
+ * A socket left by a server that has gone is replaced, the socket of a 
+ * running server is not.
+ * Serving ends at the end of stdin, or with SIGINT or SIGTERM; then the
+ * number of patterns and the mean, 50 %, 99 % and maximal latency 
+ * (from reading a pattern to writing its answer) are reported on 
+ * stderr and in the logfile.
+ * The WIN2017 build has no Unix sockets and signals: it does not serve.
+ * @memo estimation server
+ */
+static void
+fzyestim_serve(const FModel& fmodel, char* datafilename) throw (Error) {
+#ifdef WIN2017
+  throw Error("option --serve is not supported on Windows!");
+#else
+  vector<Real> factor;
+  vector<Real> shift;
+  if (datafilename != NULL) {
+    DataReader reader(datafilename, false);
+    Data first_row;
+    if (! reader.read(first_row, 1)) {
+      throw Error((string)"no data in file `" + datafilename + "'!");
+    }
+    if (reader.udim() != fmodel.udim()) {
+      string msg = "loded model has another udim than loaded data";
+      throw(Error(msg));
+    }
+    factor = reader.scale_factor();
+    shift = reader.scale_shift();
+  }
+  else if (GLOBAL::denormalize) {
+    throw Error("no data file for the scale of option -n given!");
+  }
+  CModel cmodel(fmodel);
+
+  struct sigaction action;
+  memset(&action, 0, sizeof(action));
+  action.sa_handler = serve_signal;
+  sigemptyset(&action.sa_mask);
+  sigaction(SIGINT, &action, NULL);
+  sigaction(SIGTERM, &action, NULL);
+  signal(SIGPIPE, SIG_IGN);
+
+  LatencyHistogram latency;
+  if (GLOBAL::serve_socket == NULL) {
+    serve_patterns(cmodel, factor, shift, 0, 1, latency);
+  }
+  else {
+    struct sockaddr_un address;
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    if (strlen(GLOBAL::serve_socket) >= sizeof(address.sun_path)) {
+      throw Error((string)"socket name `" + GLOBAL::serve_socket 
+		  + "' too long!");
+    }
+    strcpy(address.sun_path, GLOBAL::serve_socket);
+    // /// replace a socket left by a former server, but no other file, 
+    // /// and not the socket of a server still accepting clients
+    struct stat status;
+    if ((stat(GLOBAL::serve_socket, &status) == 0) 
+	&& S_ISSOCK(status.st_mode)) {
+      int probe_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+      if (probe_fd < 0) {
+	throw Error((string)"cannot probe socket `" + GLOBAL::serve_socket 
+		    + "': " + strerror(errno));
+      }
+      int connected = connect(probe_fd, (struct sockaddr*)&address, 
+			      sizeof(address));
+      int connect_errno = errno;
+      close(probe_fd);
+      if (connected == 0) {
+	throw Error((string)"socket `" + GLOBAL::serve_socket 
+		    + "' is in use by another server!");
+      }
+      if (connect_errno == ECONNREFUSED) {
+	unlink(GLOBAL::serve_socket);
+      }
+    }
+    int socket_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if ((socket_fd < 0) 
+	|| (bind(socket_fd, (struct sockaddr*)&address, sizeof(address)) < 0)
+	|| (listen(socket_fd, 8) < 0)) {
+      string msg = (string)"cannot listen on socket `" 
+	+ GLOBAL::serve_socket + "': " + strerror(errno);
+      if (socket_fd >= 0) {
+	close(socket_fd);
+      }
+      throw Error(msg);
+    }
+    verbose(1, "serving on socket", GLOBAL::serve_socket);
+    string accept_error;
+    while (! serve_stop) {
+      int client_fd = accept(socket_fd, NULL, NULL);
+      if (client_fd < 0) {
+	if ((errno == EINTR) || (errno == ECONNABORTED)) {
+	  continue; // interrupted, or the client has gone
+	}
+	accept_error = (string)"cannot accept clients on socket `" 
+	  + GLOBAL::serve_socket + "': " + strerror(errno);
+	break;
+      }
+      serve_patterns(cmodel, factor, shift, client_fd, client_fd, latency);
+      close(client_fd);
+    }
+    close(socket_fd);
+    unlink(GLOBAL::serve_socket);
+    if (! accept_error.empty()) {
+      throw Error(accept_error);
+    }
+  }
+
+  // /// report the latencies (not to stdout, which may be the answers)
+  string msg = (string)"served patterns: " + itos(latency.n()) + "\n";
+  if (latency.n() > 0) {
+    msg += (string)"latency [us]: mean " + dtos(latency.mean() / 1e3)
+      + ", p50 " + dtos(latency.quantile(0.5) / 1e3)
+      + ", p99 " + dtos(latency.quantile(0.99) / 1e3)
+      + ", max " + dtos(latency.max() / 1e3) + "\n";
+  }
+  cerr << msg << flush;
+  if (GLOBAL::logfile) {
+    GLOBAL::logfile << msg;
+  }
+  return;
+#endif
+}
+
+
 void fzyestim(char* fzyfilename, char* datafilename) throw (Error) {
 
   // load fuzzy model
   FModel fmodel;
   fmodel.load(fzyfilename);
-  if ( (GLOBAL::verbose > 1) && (! GLOBAL::quiet)) {
+  if ( (GLOBAL::verbose > 1) && (! GLOBAL::quiet) && (! GLOBAL::serve)) {
     cout << "loaded model:\n\n" << fmodel << endl;
   }
   if (fmodel.rdim() < 1) {
@@ -63,22 +527,16 @@ void fzyestim(char* fzyfilename, char* datafilename) throw (Error) {
     throw(Error(msg));
   }
 
-  // load data
-  Data data;
-  data.load(datafilename);
-  if (data.U().size() < 1) {
-    string msg = "loaded data file contains no values!";
-    throw(Error(msg));
+  if (GLOBAL::serve) {
+    fzyestim_serve(fmodel, datafilename);
+    return;
   }
 
-  // check if model fits to data
-  if (GLOBAL::consequence_dimension > 1 + data.udim()) {
-    throw(ConsdimError(itos(GLOBAL::consequence_dimension), 
-		       itos(1 + data.udim())));
-  }
-  if (fmodel.udim() != data.udim()) {
-    string msg = "loded model has another udim than loaded data";
-    throw(Error(msg));
+  // load data (unless streamed, see fzyestim_stream())
+  Data data;
+  if (GLOBAL::stream_rows == 0) {
+    data.load(datafilename);
+    check_data(fmodel, data.U().size(), data.udim());
   }
 
 
@@ -152,13 +610,19 @@ void fzyestim(char* fzyfilename, char* datafilename) throw (Error) {
     throw FileOpenError(errfilename);
   }
   Real error = -1.0;
-  if (GLOBAL::mode == ESTIMATION) {
-    error = fmodel.estimation(data, outfilename.c_str());
+  Real R2 = 0.0;
+  if (GLOBAL::stream_rows > 0) {
+    R2 = fzyestim_stream(fmodel, datafilename, outfilename, error);
   }
-  else if (GLOBAL::mode == SIMULATION) {
-    error = fmodel.simulation(data, outfilename.c_str());
+  else {
+    if (GLOBAL::mode == ESTIMATION) {
+      error = fmodel.estimation(data, outfilename.c_str());
+    }
+    else if (GLOBAL::mode == SIMULATION) {
+      error = fmodel.simulation(data, outfilename.c_str());
+    }
+    R2 = fmodel.R2(data);
   }
-  Real R2 = fmodel.R2(data);
   verbose(1, "error", error);
   verbose(1, "R2", R2);
   if (GLOBAL::mode == ESTIMATION) {
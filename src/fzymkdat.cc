@@ -30,7 +30,7 @@
 #include <algo.h>
 #else
 #include <fstream>
-//#include <numeric>
+#include <numeric>
 #include <algorithm>
 #endif
 
@@ -68,31 +68,200 @@ fzymkdat(char* normfilename, char* infilename, char* outfilename)
   if (n_columns < 1) {
     return;
   }
+  fzymkdat(normalization.scale_factor(), normalization.scale_shift(), a,
+	   infilename, outfilename, ! GLOBAL::denormalize, NULL);
+  return;
+}
+
+
+MakeDataConfig::MakeDataConfig(const char* outfilename_)
+  : dynamic_orders(GLOBAL::dynamic_orders), 
+    n_training_data(GLOBAL::n_training_data), 
+    n_skip_data(GLOBAL::n_skip_data), ut_regressor(GLOBAL::ut_regressor),
+    outfilename((outfilename_ != NULL) ? outfilename_ : "") {
+}
+
+
+/** Read the configurations of the file configfilename: one per line,
+ *  <output_data> [-d <d1 d2 ... dn>] [-Np <n>] [-Ns <n>] [-rt];
+ *  missing options are those of the command line, empty lines and 
+ *  lines starting with `#' are skipped; each <output_data> may be given
+ *  once only.
+ * @memo
+ */
+static void
+read_configs(const char* configfilename, vector<MakeDataConfig>& configs)
+  throw (Error) {
+  ifstream file(configfilename);
+  if (!file) {
+    throw FileOpenError(configfilename);
+  }
+  string line;
+  size_t line_number = 0;
+  while (getline(file, line)) {
+    ++line_number;
+    // /// split the line into words
+    vector<string> words;
+    size_t begin = line.find_first_not_of(" \t\r");
+    while (begin != string::npos) {
+      size_t end = line.find_first_of(" \t\r", begin);
+      words.push_back(line.substr(begin, end - begin));
+      begin = line.find_first_not_of(" \t\r", end);
+    }
+    if (words.empty() || (words[0][0] == '#')) {
+      continue;
+    }
+    string where = (string)configfilename + ", line " + itos(line_number);
+    MakeDataConfig config(words[0].c_str());
+    size_t i = 1;
+    while (i < words.size()) {
+      const string& word = words[i++];
+      if (! word.compare("-d")) {
+	config.dynamic_orders.clear();
+	while ((i < words.size()) && (words[i][0] != '-')) {
+	  config.dynamic_orders.push_back(atoi(words[i++].c_str()));
+	}
+      }
+      else if (! word.compare("-Np") || ! word.compare("-Ns")) {
+	if (i == words.size()) {
+	  throw Error(where + ": no argument for option " + word + " given!");
+	}
+	int n = atoi(words[i++].c_str());
+	if (! word.compare("-Np")) {
+	  config.n_training_data = n;
+	}
+	else {
+	  config.n_skip_data = n;
+	}
+      }
+      else if (! word.compare("-rt")) {
+	config.ut_regressor = 1;
+      }
+      else {
+	throw Error(where + ": unknown option `" + word + "'!");
+      }
+    }
+    if (config.dynamic_orders.empty()) {
+      throw Error(where + ": no data dynamics given (with -d option)!");
+    }
+    if ((config.n_training_data < 0) || (config.n_skip_data < 0)) {
+      throw Error(where + ": no. of patterns < 0!");
+    }
+    // /// the data sets are written in parallel: no two may share files
+    for (size_t k = 0; k < configs.size(); ++k) {
+      if (configs[k].outfilename == config.outfilename) {
+	throw Error(where + ": output data `" + config.outfilename 
+		    + "' already made by an earlier line!");
+      }
+    }
+    configs.push_back(config);
+  }
+  if (configs.empty()) {
+    throw Error((string)"no configuration in file `" + configfilename + "'!");
+  }
+  return;
+}
+
+
+void 
+fzymkdat_configs(char* normfilename, char* infilename, char* configfilename)
+  throw (Error) {
+  vector<MakeDataConfig> configs;
+  read_configs(configfilename, configs);
+  // /// load and normalize the data once
+  Data normalization;
+  normalization.load(normfilename);
+  Data a;
+  a.load(infilename);
+  if (a.U().size() < 1) {
+    throw Error((string)"no data in file `" + infilename + "'!");
+  }
+  a.normalize(normalization.scale_factor(), normalization.scale_shift());
+  // /// the data sets are independent; errors are thrown after all 
+  // /// threads have finished, first configuration first
+  vector<string> errors(configs.size());
+  int n_configs = (int)configs.size();
+#pragma omp parallel for schedule(dynamic, 1) num_threads(GLOBAL::n_threads)
+  for (int k = 0; k < n_configs; ++k) {
+    try {
+      fzymkdat(a, infilename, configs[k], ! GLOBAL::denormalize, NULL);
+    }
+    catch (Error& error) {
+      errors[k] = configs[k].outfilename + ": " + error.msg();
+    }
+    catch (...) {
+      errors[k] = configs[k].outfilename + ": unknown error in fzymkdat()";
+    }
+  }
+  for (size_t k = 0; k < errors.size(); ++k) {
+    if (! errors[k].empty()) {
+      throw Error(errors[k]);
+    }
+  }
+  return;
+}
+
+
+void 
+fzymkdat(const vector<Real>& scale_factor, const vector<Real>& scale_shift,
+	 Data& a, const char* infilename, const char* outfilename, 
+	 bool original, Data* result)
+  throw (Error) {
+  a.normalize(scale_factor, scale_shift);
+  fzymkdat(a, infilename, MakeDataConfig(outfilename), original, result);
+  return;
+}
+
+
+void 
+fzymkdat(const Data& a, const char* infilename, const MakeDataConfig& config,
+	 bool original, Data* result)
+  throw (Error) {
+  const char* outfilename = 
+    config.outfilename.empty() ? NULL : config.outfilename.c_str();
+  // /// flag: generate dynamic (or static) data
+  int dynamic = 1;
+  if (config.dynamic_orders.size() < 1) {
+    throw Error("no data dynamics given (with -d option)!");
+  }
+  if (*(config.dynamic_orders.begin()) == 0) {
+    // /// build static data
+    dynamic = 0;
+  }
+  size_t n_rows = a.U().size();
+  if (n_rows < 1) {
+    throw Error((string)"no data in file `" + infilename + "'!");
+  }
+  size_t n_columns = a.udim() + 1;
+  // /// the files to write
+  bool write_text = (outfilename != NULL) && ! GLOBAL::binary_data;
+  bool write_binary = (outfilename != NULL) && GLOBAL::binary_data;
+  bool write_original = (outfilename != NULL) && original;
 
   // /// check orders
-  if (dynamic && (GLOBAL::dynamic_orders.size() != 1+a.udim())) {
+  if (dynamic && (config.dynamic_orders.size() != 1+a.udim())) {
     throw Error("no. of dynamic orders != columns in input data file!");
   }
-  int min_order =  *min_element(GLOBAL::dynamic_orders.begin(), 
-				GLOBAL::dynamic_orders.end());
+  int min_order =  *min_element(config.dynamic_orders.begin(), 
+				config.dynamic_orders.end());
 //   if (dynamic && (min_order < 1)) {
 //     throw Error("dynamic order < 1 at -d option!");
 //   }
   if (dynamic && (min_order < 0)) {
     throw Error("dynamic order < 0 at -d option!");
   }
-  size_t n_columns_dynamic = accumulate(GLOBAL::dynamic_orders.begin(), 
-					GLOBAL::dynamic_orders.end(), 1);
+  size_t n_columns_dynamic = accumulate(config.dynamic_orders.begin(), 
+					config.dynamic_orders.end(), 1);
   if (dynamic && (n_columns_dynamic < 2)) {
     throw Error("no input variable columns < 1 at -d option!");
   }
-  size_t max_order =  *max_element(GLOBAL::dynamic_orders.begin(), 
-				   GLOBAL::dynamic_orders.end());
+  size_t max_order =  *max_element(config.dynamic_orders.begin(), 
+				   config.dynamic_orders.end());
 
 
-  size_t n_skip_data = GLOBAL::n_skip_data;
-  size_t n_patterns_net = GLOBAL::n_training_data;
-  if (GLOBAL::n_training_data == 0) {
+  size_t n_skip_data = config.n_skip_data;
+  size_t n_patterns_net = config.n_training_data;
+  if (config.n_training_data == 0) {
     n_patterns_net = n_rows;
     if (n_patterns_net > n_skip_data) {
       n_patterns_net -= n_skip_data;
@@ -111,11 +280,11 @@ fzymkdat(char* normfilename, char* infilename, char* outfilename)
   }
   
   size_t n_patterns_gross = n_patterns_net + max_order;
-  if (n_patterns_gross + GLOBAL::n_skip_data > n_rows) {
+  if (n_patterns_gross + config.n_skip_data > n_rows) {
     throw Error("not enough patterns in input data file!");
   }
-  if (n_patterns_gross + GLOBAL::n_skip_data < n_rows) {
-    string msg = itos(n_rows - n_patterns_gross - GLOBAL::n_skip_data);
+  if (n_patterns_gross + config.n_skip_data < n_rows) {
+    string msg = itos(n_rows - n_patterns_gross - config.n_skip_data);
     msg += " unused patterns in input data file!";
     verbose(0, "warning", msg);
   }
@@ -124,12 +293,15 @@ fzymkdat(char* normfilename, char* infilename, char* outfilename)
 
   ofstream trainingfile_norm;
   ofstream trainingfile_orig;
-  string trainingfilename_norm = (string)outfilename + ".nrm";
-  trainingfile_norm.open(trainingfilename_norm.c_str());
-  if (!trainingfile_norm) {
-    throw FileOpenError(trainingfilename_norm);
+  string trainingfilename_norm = 
+    (outfilename != NULL) ? (string)outfilename + ".nrm" : "";
+  if (write_text) {
+    trainingfile_norm.open(trainingfilename_norm.c_str());
+    if (!trainingfile_norm) {
+      throw FileOpenError(trainingfilename_norm);
+    }
   }
-  if (! GLOBAL::denormalize) {
+  if (write_original) {
     string trainingfilename_orig = (string)outfilename + ".ogl";
     trainingfile_orig.open(trainingfilename_orig.c_str());
     if (!trainingfile_orig) {
@@ -137,24 +309,31 @@ fzymkdat(char* normfilename, char* infilename, char* outfilename)
     }
   }
 
-  // /// normalize a
-  a.normalize(normalization.scale_factor(),
-	      normalization.scale_shift());
-
   // /// write static data
   if (! dynamic) {
     for (size_t col = 0; col < a.udim(); ++ col) {
       column_names += (string)" u" + itos(col+1);
     }
     column_names += (string)" y";
-    trainingfile_norm << "##source: \"" << infilename << "\"\n";
-    trainingfile_norm << "##rows: " << n_patterns_net << "\n";
-    trainingfile_norm << "##columns: " << n_columns << "\n";
-    trainingfile_norm << "##dynamics: 0\n";
-    trainingfile_norm << "##factor: " << a.scale_factor() << "\n";
-    trainingfile_norm << "##shift: " << a.scale_shift() << "\n";
-    trainingfile_norm << "##names:" << column_names << "\n";
-    if (! GLOBAL::denormalize) {
+    if (result != NULL) {
+      result->assign(infilename, a.U(), a.y(), n_skip_data, n_patterns_net,
+		     a.blocksize(), a.scale_factor(), a.scale_shift());
+    }
+    if (write_binary) {
+      write_binary_data(trainingfilename_norm, a.U(), a.y(), n_skip_data, 
+			n_patterns_net, a.blocksize(), a.scale_factor(), 
+			a.scale_shift());
+    }
+    else {
+      trainingfile_norm << "##source: \"" << infilename << "\"\n";
+      trainingfile_norm << "##rows: " << n_patterns_net << "\n";
+      trainingfile_norm << "##columns: " << n_columns << "\n";
+      trainingfile_norm << "##dynamics: 0\n";
+      trainingfile_norm << "##factor: " << a.scale_factor() << "\n";
+      trainingfile_norm << "##shift: " << a.scale_shift() << "\n";
+      trainingfile_norm << "##names:" << column_names << "\n";
+    }
+    if (write_original) {
       vector<Real> zeros(n_columns, 0.0);
       vector<Real> ones(n_columns, 1.0);
       trainingfile_orig << "##source: \"" << infilename << "\"\n";
@@ -165,20 +344,22 @@ fzymkdat(char* normfilename, char* infilename, char* outfilename)
       trainingfile_orig << "##shift: " << zeros << "\n";
       trainingfile_orig << "##names:" << column_names << "\n";
     }
-    vector<Uvector>::const_iterator paU = a.U().begin();  
+    Umatrix::const_iterator paU = a.U().begin();  
     vector<Real>::const_iterator pay = a.y().begin();
     for (size_t row = 0; row < n_skip_data; ++row) {
       ++paU;
       ++pay;
     }
     for (size_t row = 0; row < n_patterns_net; ++row) {
-      trainingfile_norm << *paU << *pay << endl;
-      if ((a.blocksize() > 0) && ((row+1) % a.blocksize() == 0)) {
-	trainingfile_norm << endl;
+      if (write_text) {
+	trainingfile_norm << *paU << *pay << endl;
+	if ((a.blocksize() > 0) && ((row+1) % a.blocksize() == 0)) {
+	  trainingfile_norm << endl;
+	}
       }
-      if (! GLOBAL::denormalize) {
+      if (write_original) {
 	//#WIN2017 vector<Real>::const_iterator pau = paU->begin();
-	Uvector::const_iterator pau = paU->begin();
+	Urow::const_iterator pau = paU->begin();
 	vector<Real>::const_iterator pf = a.scale_factor().begin();
 	vector<Real>::const_iterator ps = a.scale_shift().begin();
 	while (pau != paU->end()) {
@@ -193,8 +374,10 @@ fzymkdat(char* normfilename, char* infilename, char* outfilename)
       ++paU;
       ++pay;
     }
-    trainingfile_norm.close();
-    if (! GLOBAL::denormalize) {
+    if (write_text) {
+      trainingfile_norm.close();
+    }
+    if (write_original) {
       trainingfile_orig.close();
     }
     return;
@@ -202,107 +385,46 @@ fzymkdat(char* normfilename, char* infilename, char* outfilename)
 
   // /// write dynamic data
 
-  // /// create matrix b containing shifted columns (dynamics) 
-  Data b(n_columns_dynamic-1, n_patterns_gross-1, 0.0);
-  vector<Uvector>::iterator pbU = b.U().begin();  
-  vector<Real>::iterator pby = b.y().begin();
-  vector<Uvector>::const_iterator paU = a.U().begin();  
-  vector<Real>::const_iterator pay = a.y().begin();
-  for (size_t row = 0; row < n_skip_data; ++row) {
-    ++paU;
-    ++pay;
-  }
-  if (GLOBAL::ut_regressor) {
-    ++paU;
-  }
-  vector<Real> last_row(n_columns_dynamic-1, 0.0); // last row of U
-  for (size_t row = 0; row < n_patterns_gross - 1; ++row) {
-    vector<int>::reverse_iterator prorder = GLOBAL::dynamic_orders.rbegin();
-    vector<Real>::reverse_iterator prlast_row = last_row.rbegin();
-    if (*prorder > 0) {
-      // save y-2, y-3, ...
-      for (int col = 1; col < *prorder; ++col) {
-	*prlast_row = *(++prlast_row);
-      }
-      // save y-1
-      *(prlast_row++) = *pay;
-    }
-    ++prorder;
-    // unfortunately, no reverse iterators for Uvector
-    Uvector::iterator prau = paU->end() - 1;
-    while (prorder != GLOBAL::dynamic_orders.rend()) {
-      if (*prorder > 0) {
-	// save x-2, x-3, ...
-	for (int col = 1; col < *prorder; ++col) {
-	  *prlast_row = *(++prlast_row);
-	}
-	// save x-1
-	*(prlast_row++) = *prau;
-      }
-      --prau;
-      ++prorder;
-    }
-    // save last_row to b
-    Uvector::iterator pbu = pbU->begin();
-    vector<Real>::iterator plast_row = last_row.begin();
-    while (plast_row != last_row.end()) {
-      *(pbu++) = *(plast_row++);
-    }
-    // save y
-    *pby = *(pay + 1);
-    ++pbU;
-    ++paU;
-    ++pay;
-    ++pby;
-  }
-
-  // /// create factor and shift vector (containing columns due to dynamics)
-  vector<Real> scale_factor_dynamic;
-  vector<Real> scale_shift_dynamic;
-  scale_factor_dynamic.resize(n_columns_dynamic);
-  scale_shift_dynamic.resize(n_columns_dynamic);
-  vector<Real>::iterator pf = scale_factor_dynamic.begin();
-  vector<Real>::iterator ps = scale_shift_dynamic.begin();
-  vector<Real>::const_iterator pfactor = a.scale_factor().begin();
-  vector<Real>::const_iterator pshift = a.scale_shift().begin();
-  vector<int>::const_iterator porder = GLOBAL::dynamic_orders.begin();
-  while (porder != GLOBAL::dynamic_orders.end()) {
-    for (int k = 0; k < *porder; ++k) {
-      *(pf++) = *pfactor;
-      *(ps++) = *pshift;
-    }
-    ++pfactor;
-    ++pshift;
-    ++porder;
-  }
-  // save scale of y
-  *pf = *(a.scale_factor().end() - 1);
-  *ps = *(a.scale_shift().end() - 1);
+  // /// the lagged regressors, as views of one copy of each signal 
+  // /// (into result, if given); read only, so the rows stay views
+  Data lags;
+  Data& lagged = (result != NULL) ? *result : lags;
+  lagged.assign_lags(infilename, a, config.dynamic_orders, 
+		     config.ut_regressor, n_skip_data, n_patterns_net);
+  const Data& b = lagged;
+  const vector<Real>& scale_factor_dynamic = b.scale_factor();
+  const vector<Real>& scale_shift_dynamic = b.scale_shift();
 
   // /// write output files
   for (size_t col = 0; col < a.udim(); ++ col) {
-    for (int order = 0; order < GLOBAL::dynamic_orders[col]; ++order) {
+    for (int order = 0; order < config.dynamic_orders[col]; ++order) {
       column_names += (string)" u" + itos(col+1) + "(t-";
       column_names += itos(order+1) + ")";
     }
   }
-  for (int order = 0; order < *(GLOBAL::dynamic_orders.end()-1); ++order) {
+  for (int order = 0; order < *(config.dynamic_orders.end()-1); ++order) {
     column_names += (string)" y(t-" + itos(order+1) + ")";
   }
   column_names += (string)" y(t)";
-  for (vector<int>::iterator porder = GLOBAL::dynamic_orders.begin();
-       porder != GLOBAL::dynamic_orders.end();
+  for (vector<int>::const_iterator porder = config.dynamic_orders.begin();
+       porder != config.dynamic_orders.end();
        ++porder) {
     dynamics_names += (string)" " + itos(*porder);
   }
-  trainingfile_norm << "##source: \"" << infilename << "\"\n";
-  trainingfile_norm << "##rows: " << n_patterns_net << "\n";
-  trainingfile_norm << "##columns: " << n_columns_dynamic << "\n";
-  trainingfile_norm << "##dynamics:" << dynamics_names << "\n";
-  trainingfile_norm << "##factor: " << scale_factor_dynamic << "\n";
-  trainingfile_norm << "##shift: " << scale_shift_dynamic << "\n";
-  trainingfile_norm << "##names:" << column_names << "\n";
-  if (! GLOBAL::denormalize) {
+  if (write_binary) {
+    write_binary_data(trainingfilename_norm, b.U(), b.y(), 0, n_patterns_net,
+		      a.blocksize(), scale_factor_dynamic, scale_shift_dynamic);
+  }
+  else {
+    trainingfile_norm << "##source: \"" << infilename << "\"\n";
+    trainingfile_norm << "##rows: " << n_patterns_net << "\n";
+    trainingfile_norm << "##columns: " << n_columns_dynamic << "\n";
+    trainingfile_norm << "##dynamics:" << dynamics_names << "\n";
+    trainingfile_norm << "##factor: " << scale_factor_dynamic << "\n";
+    trainingfile_norm << "##shift: " << scale_shift_dynamic << "\n";
+    trainingfile_norm << "##names:" << column_names << "\n";
+  }
+  if (write_original) {
     vector<Real> zeros(n_columns_dynamic, 0.0);
     vector<Real> ones(n_columns_dynamic, 1.0);
     trainingfile_orig << "##source: \"" << infilename << "\"\n";
@@ -313,21 +435,18 @@ fzymkdat(char* normfilename, char* infilename, char* outfilename)
     trainingfile_orig << "##shift: " << zeros << "\n";
     trainingfile_orig << "##names:" << column_names << "\n";
   }
-  pbU = b.U().begin();  
-  pby = b.y().begin();
-  // skip first uncomplete patterns
-  for (size_t row = 0; row < (max_order - 1); ++row) {
-    ++pbU;
-    ++pby;
-  }
+  Umatrix::const_iterator pbU = b.U().begin();  
+  vector<Real>::const_iterator pby = b.y().begin();
   for (size_t row = 0; row < n_patterns_net; ++row) {
-    trainingfile_norm << *pbU << *pby << endl;
-    if ((a.blocksize() > 0) && ((row+1) % a.blocksize() == 0)) {
-      trainingfile_norm << endl;
+    if (write_text) {
+      trainingfile_norm << *pbU << *pby << endl;
+      if ((a.blocksize() > 0) && ((row+1) % a.blocksize() == 0)) {
+	trainingfile_norm << endl;
+      }
     }
-    if (! GLOBAL::denormalize) {
+    if (write_original) {
       //#WIN2017 vector<Real>::const_iterator pbu = pbU->begin();
-      Uvector::const_iterator pbu = pbU->begin();
+      Urow::const_iterator pbu = pbU->begin();
       vector<Real>::const_iterator pf = scale_factor_dynamic.begin();
       vector<Real>::const_iterator ps = scale_shift_dynamic.begin();
       while (pbu != pbU->end()) {
@@ -342,8 +461,10 @@ fzymkdat(char* normfilename, char* infilename, char* outfilename)
     ++pbU;
     ++pby;
   }
-  trainingfile_norm.close();
-  if (! GLOBAL::denormalize) {
+  if (write_text) {
+    trainingfile_norm.close();
+  }
+  if (write_original) {
     trainingfile_orig.close();
   }
   return;
@@ -33,11 +33,57 @@
 
 
 
+/** Configuration of the data to create: dynamic orders, no. of patterns,
+ * patterns to skip, regressor with u(t), and the output file (none if 
+ * empty); by default the options of the command line.
+ * @memo
+ */
+class MakeDataConfig
+{
+public:
+  vector<int> dynamic_orders;
+  int n_training_data;
+  int n_skip_data;
+  int ut_regressor;
+  string outfilename;
+  MakeDataConfig(const char* outfilename_ = NULL);
+};
+
+
 /** Prepare data for fuzzy modeling (order shift and normalization).
  * @memo
  */
 void fzymkdat(char* normfilename, char* infilename, char* outfilename)
   throw (Error);
 
+/** Prepare the data of all configurations in the file configfilename 
+ * (see GLOBAL::make_data_configs): the normalization and the input data
+ * are loaded and normalized once, the configurations are written by 
+ * GLOBAL::n_threads threads.
+ * @memo
+ */
+void fzymkdat_configs(char* normfilename, char* infilename, 
+		      char* configfilename)
+  throw (Error);
+
+/** Normalize the data a, loaded from infilename, by scale_factor and 
+ * scale_shift, and create the data for fuzzy modeling from it: into 
+ * result (if not NULL), and into the files outfilename.nrm and, with 
+ * original, outfilename.ogl (if outfilename is not NULL).
+ * @memo
+ */
+void fzymkdat(const vector<Real>& scale_factor, const vector<Real>& scale_shift,
+	      Data& a, const char* infilename, const char* outfilename, 
+	      bool original, Data* result)
+  throw (Error);
+
+/** Create the data of configuration config from the normalized data a,
+ * loaded from infilename (see above).
+ * @memo
+ */
+void fzymkdat(const Data& a, const char* infilename, 
+	      const MakeDataConfig& config, bool original, Data* result)
+  throw (Error);
+
 
 #endif /// #ifndef FZYMKDAT_HH
@@ -30,22 +30,154 @@
 #else
 #include <fstream>
 #endif
+#include <algorithm>
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#ifndef WIN2017
+#include <fcntl.h>
+#include <unistd.h>
+#else
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#endif
 
 #include "global.hh"
 #include "data.hh"
 #include "fmodel.hh"
+#include "svd.hh"
 #include "minimize.hh"
 #include "main.hh"
+#include "fzynorml.hh"
+#include "fzymkdat.hh"
 
 #include "fzymodel.hh"
 
 
+/*
+ * ********** local functions
+ */
+
+Real train_candidate(FModel& candidate_model, const Data& a, const Data& b,
+		     bool init, size_t max_iterations,
+		     OptimizationState& state) throw (Error);
+vector<size_t>
+race_survivors(const vector< pair<size_t, size_t> >& candidates,
+	       const vector<size_t>& racing, 
+	       vector<FModel*>& candidate_models, 
+	       vector<Real>& candidate_errors, size_t epoch, size_t budget);
+bool continue_search(size_t epoch, Real epoch_R2, Real global_R2);
+void write_checkpoint(const FModel& epoch_model, const FModel& best_model,
+		      size_t epoch, size_t best_epoch, 
+		      Real epoch_error, Real epoch_R2, Real global_R2,
+		      Real best_error, Real best_R2,
+		      const vector<Real>& error_history, 
+		      const vector<Real>& R2_history) throw (Error);
+void read_checkpoint(FModel& epoch_model, FModel& best_model,
+		     size_t& epoch, size_t& best_epoch, 
+		     Real& epoch_error, Real& epoch_R2, Real& global_R2,
+		     Real& best_error, Real& best_R2,
+		     vector<Real>& error_history, 
+		     vector<Real>& R2_history) throw (Error);
+vector< pair<size_t, size_t> > 
+preselect_candidates(FModel& global_model, 
+		     const vector< pair<size_t, size_t> >& candidates,
+		     const Data& a, const Data& b, size_t epoch) throw (Error);
+
+
+/*
+ * ********** global and local functions
+ */
+
 void
-fzymodel(char* learnfilename, char* validationfilename) throw (Error) {
+fzymodel(char* learnfilename, char* validationfilename, char* modelfilename)
+  throw (Error) {
   Data a;
   Data b;
   a.load(learnfilename);
   b.load(validationfilename); 
+  fzymodel(a, b, modelfilename);
+  return;
+}
+
+
+/// the raw data file filename without its extension
+static string
+pipeline_basename(const char* filename) {
+  string name = filename;
+  string::size_type dot = name.rfind('.');
+  string::size_type separator = name.rfind(file_separator);
+  if ((dot != string::npos) && (dot > 0)
+      && ((separator == string::npos) || (dot > separator + 1))) {
+    name.erase(dot);
+  }
+  return name;
+}
+
+
+void
+fzypipeline(char* normfilename, char* learnfilename, 
+	    char* validationfilename, char* modelfilename) throw (Error) {
+  string norfilename = (string)normfilename + ".nor";
+  string learnbasename = pipeline_basename(learnfilename);
+  string validationbasename = pipeline_basename(validationfilename);
+  const char* norfile = GLOBAL::pipeline_files ? norfilename.c_str() : NULL;
+  const char* learnfile = 
+    GLOBAL::pipeline_files ? learnbasename.c_str() : NULL;
+  const char* validationfile = 
+    GLOBAL::pipeline_files ? validationbasename.c_str() : NULL;
+  Data a;
+  Data b;
+  {
+    Data raw;
+    raw.load(learnfilename);
+    // /// the normalization, as by fzynorml
+    vector<Real> scale_factor;
+    vector<Real> scale_shift;
+    if (strcmp(normfilename, learnfilename) == 0) {
+      fzynorml(raw, normfilename, norfile, scale_factor, scale_shift);
+    }
+    else {
+      Data normalization;
+      normalization.load(normfilename);
+      fzynorml(normalization, normfilename, norfile, 
+	       scale_factor, scale_shift);
+    }
+    // /// the learn and validation data, as by fzymkdat
+    fzymkdat(scale_factor, scale_shift, raw, learnfilename, learnfile, 
+	     GLOBAL::pipeline_original, &a);
+    if (strcmp(validationfilename, learnfilename) == 0) {
+      b = a;
+    }
+    else {
+      Data raw_validation;
+      raw_validation.load(validationfilename);
+      fzymkdat(scale_factor, scale_shift, raw_validation, validationfilename,
+	       validationfile, GLOBAL::pipeline_original, &b);
+    }
+  }
+  fzymodel(a, b, modelfilename);
+  return;
+}
+
+
+void
+fzymodel(Data& a, Data& b, char* modelfilename) throw (Error) {
+  const string& learnfilename = a.filename();
+  const string& validationfilename = b.filename();
+  // /// with -Mc, the block kernels (see CModel) read the inputs column by
+  // /// column instead of transposing each block; data stored by columns
+  // /// (a loaded binary data file, the lags of the pipeline) have their
+  // /// columns already
+  if (GLOBAL::mirror_columns) {
+    if (! a.U().has_columns()) {
+      a.U().mirror_columns();
+    }
+    if (! b.U().has_columns()) {
+      b.U().mirror_columns();
+    }
+  }
   assert(a.U().size() > 0);
   assert(b.U().size() > 0);
   assert(a.udim() == b.udim());
@@ -72,8 +204,10 @@ fzymodel(char* learnfilename, char* validationfilename) throw (Error) {
   //#WIN2017 Real global_error;
   Real best_error = FLT_MAX;
   Real epoch_R2;
-  Real global_R2;
+  Real global_R2 = 0.0;
   Real best_R2 = 0.0;
+  vector<Real> error_history;
+  vector<Real> R2_history;
 
   string r2filename = GLOBAL::basefilename + "_rr" + r2_suffix;
   string errfilename = GLOBAL::basefilename + "_rr" + error_suffix;
@@ -89,19 +223,43 @@ fzymodel(char* learnfilename, char* validationfilename) throw (Error) {
     throw FileOpenError(errfilename);
   }
 
-  // initial one-rule model; not optimized
-  outfilename = GLOBAL::basefilename + "_r" + itos(epoch) + output_suffix;
-  modfilename = GLOBAL::basefilename + "_r" + itos(epoch) + model_suffix;
-  modfile.open(modfilename.c_str());
-  if (!modfile) {
-    throw FileOpenError(modfilename);
+  if (GLOBAL::resume) {
+    // /// continue after the last epoch of the checkpoint
+    read_checkpoint(epoch_model, best_model, epoch, best_epoch, 
+		    epoch_error, epoch_R2, global_R2, best_error, best_R2,
+		    error_history, R2_history);
+    if (epoch_model.udim() != a.udim()) {
+      throw Error((string)"fzymodel(): checkpoint does not match the data!");
+    }
+    epoch_model.learnfilename() = (string)learnfilename;
+    epoch_model.validationfilename() = (string)validationfilename;
+    epoch_model.learn_data() = &a;
+    epoch_model.valid_data() = &b;
+    best_model.learn_data() = &a;
+    best_model.valid_data() = &b;
+    for(size_t k = 0; k < error_history.size(); ++k) {
+      errfile << error_history[k] << endl;
+      r2file << R2_history[k] << endl;
+    }
+    verbose(0, "#################### resumed after epoch", epoch);
   }
-  epoch_error = epoch_model.estimation(b, outfilename.c_str());
-  epoch_R2 = epoch_model.R2(b);
-  errfile << epoch_error << endl;
-  r2file << epoch_R2 << endl;
-  modfile << epoch_model; 
-  modfile.close();
+  else {
+    if (modelfilename == NULL) {
+      // initial one-rule model; not optimized
+      outfilename = GLOBAL::basefilename + "_r" + itos(epoch) + output_suffix;
+      modfilename = GLOBAL::basefilename + "_r" + itos(epoch) + model_suffix;
+      modfile.open(modfilename.c_str());
+      if (!modfile) {
+	throw FileOpenError(modfilename);
+      }
+      epoch_error = epoch_model.estimation(b, outfilename.c_str());
+      epoch_R2 = epoch_model.R2(b);
+      errfile << epoch_error << endl;
+      r2file << epoch_R2 << endl;
+      error_history.push_back(epoch_error);
+      R2_history.push_back(epoch_R2);
+      modfile << epoch_model; 
+      modfile.close();
 
 // ////////////////////////////////////////////////////////////////////
 
@@ -127,45 +285,68 @@ fzymodel(char* learnfilename, char* validationfilename) throw (Error) {
 
 // ////////////////////////////////////////////////////////////////////
 
-  // initial one-rule model; consequences optimized using SVD
-  ++epoch;
-  outfilename = GLOBAL::basefilename + "_r" + itos(epoch) + output_suffix;
-  modfilename = GLOBAL::basefilename + "_r" + itos(epoch) + model_suffix;
-  modfile.open(modfilename.c_str());
-  if (!modfile) {
-    throw FileOpenError(modfilename);
-  }
-  epoch_model.optimize_SVD(a);
-  epoch_error = epoch_model.estimation(b, outfilename.c_str());
-  epoch_R2 = epoch_model.R2(b);
-  errfile << epoch_error << endl;
-  r2file << epoch_R2 << endl;
-  modfile << epoch_model; 
-  modfile.close();
-  best_model.copy(epoch_model);
-  best_error = epoch_error;
-  best_R2 = epoch_R2;
-  best_epoch = epoch;
-  // /// print currently best model
-  {
-    string bestmodfilename = GLOBAL::basefilename + "_ro" + model_suffix;
-    ofstream bestmodfile(bestmodfilename.c_str());
-    if (!bestmodfile) {
-      throw FileOpenError(bestmodfilename);
+      // initial one-rule model; consequences optimized using SVD
+      ++epoch;
+      epoch_model.optimize_SVD(a);
     }
-    bestmodfile << "### only currently best model!\n";
-    bestmodfile << "### (i.e. uncaught exception later on)\n";
-    bestmodfile << best_model;
-    bestmodfile.close();
+    else {
+      // /// grow a given model: its epoch is its number of rules
+      epoch_model.load(modelfilename);
+      if ((epoch_model.udim() != a.udim()) 
+	  || (epoch_model.cdim() != GLOBAL::consequence_dimension)) {
+	throw Error((string)"fzymodel(): model `" + modelfilename 
+		    + "' does not match the data or option -c!");
+      }
+      epoch_model.learnfilename() = (string)learnfilename;
+      epoch_model.validationfilename() = (string)validationfilename;
+      epoch_model.learn_data() = &a;
+      epoch_model.valid_data() = &b;
+      epoch = epoch_model.rdim();
+    }
+    outfilename = GLOBAL::basefilename + "_r" + itos(epoch) + output_suffix;
+    modfilename = GLOBAL::basefilename + "_r" + itos(epoch) + model_suffix;
+    modfile.open(modfilename.c_str());
+    if (!modfile) {
+      throw FileOpenError(modfilename);
+    }
+    epoch_error = epoch_model.estimation(b, outfilename.c_str());
+    epoch_R2 = epoch_model.R2(b);
+    errfile << epoch_error << endl;
+    r2file << epoch_R2 << endl;
+    error_history.push_back(epoch_error);
+    R2_history.push_back(epoch_R2);
+    modfile << epoch_model; 
+    modfile.close();
+    best_model.copy(epoch_model);
+    best_error = epoch_error;
+    best_R2 = epoch_R2;
+    best_epoch = epoch;
+    // /// print currently best model
+    {
+      string bestmodfilename = GLOBAL::basefilename + "_ro" + model_suffix;
+      ofstream bestmodfile(bestmodfilename.c_str());
+      if (!bestmodfile) {
+	throw FileOpenError(bestmodfilename);
+      }
+      bestmodfile << "### only currently best model!\n";
+      bestmodfile << "### (i.e. uncaught exception later on)\n";
+      bestmodfile << best_model;
+      bestmodfile.close();
+    }
+    verbose(0, "#################### epoch", epoch);
+    verbose(0, "cdim", GLOBAL::consequence_dimension);
+    verbose(0, "epoch_model", epoch_model);
+    verbose(0, "epoch_error", epoch_error);
+    verbose(0, "epoch_R2", epoch_R2);
+    write_checkpoint(epoch_model, best_model, epoch, best_epoch, 
+		     epoch_error, epoch_R2, global_R2, best_error, best_R2,
+		     error_history, R2_history);
   }
-  verbose(0, "#################### epoch", epoch);
-  verbose(0, "cdim", GLOBAL::consequence_dimension);
-  verbose(0, "epoch_model", epoch_model);
-  verbose(0, "epoch_error", epoch_error);
-  verbose(0, "epoch_R2", epoch_R2);
 
   // /// Sugeno's heuristic search
-  do { // next epoch
+  bool search = (! GLOBAL::resume) 
+    || continue_search(epoch, epoch_R2, global_R2);
+  while (search) { // next epoch
     global_model.copy(epoch_model);
     //#WIN2017 global_error = epoch_error;
     global_R2 = epoch_R2;
@@ -185,52 +366,126 @@ fzymodel(char* learnfilename, char* validationfilename) throw (Error) {
       first_rule = global_model.worst_rule_index(a);
       last_rule = first_rule + 1;
     }
+    // /// candidates: split each rule along each variable
+    vector< pair<size_t, size_t> > candidates;
     for(size_t rule = first_rule; rule < last_rule; ++rule) { 
-      // for all variables
       for(size_t variable = 0; variable < a.udim(); ++variable) { 
-	FModel candidate_model(global_model, rule, variable);
-	Real candidate_error = REAL_MAX;
-	if (GLOBAL::reset_cons) {
-	  candidate_model.reset_consequences();
+	candidates.push_back(pair<size_t, size_t>(rule, variable));
+      }
+    }
+    if ((GLOBAL::preselect > 0) 
+	&& (candidates.size() > (size_t)GLOBAL::preselect)) {
+      candidates = preselect_candidates(global_model, candidates, a, b, epoch);
+    }
+    // /// train the candidates, GLOBAL::n_threads of them at the same time;
+    // /// the candidates share only global_model, a, and b (read only)
+    vector<FModel*> candidate_models(candidates.size(), (FModel*)NULL);
+    vector<Real> candidate_errors(candidates.size(), REAL_MAX);
+    vector<int> candidate_failed(candidates.size(), 0);
+    vector<string> candidate_msgs(candidates.size());
+    vector<OptimizationState> candidate_states(candidates.size());
+    // /// without a race, all candidates are trained in one round with the
+    // /// full budget; a race (successive halving) trains the racing 
+    // /// candidates up to GLOBAL::race_budget iterations, drops the worse
+    // /// half, doubles the budget, and continues the survivors' training
+    // /// up to it, until one is left; the budgets count the iterations of
+    // /// all rounds, and a candidate whose validation error stopped
+    // /// improving, within a round or from one round to the next, keeps
+    // /// its best model
+    vector<size_t> racing;
+    for(size_t c = 0; c < candidates.size(); ++c) {
+      racing.push_back(c);
+    }
+    size_t budget = GLOBAL::max_opt_iterations;
+    if ((GLOBAL::race_budget > 0) 
+	&& ((size_t)GLOBAL::race_budget < budget)) {
+      budget = GLOBAL::race_budget;
+    }
+    size_t round = 0;
+    while (true) { // /// for all rounds
+      int n_racing = (int)racing.size();
+      bool init = (round == 0);
+#pragma omp parallel for schedule(dynamic) num_threads(GLOBAL::n_threads)
+      for(int k = 0; k < n_racing; ++k) {
+	size_t c = racing[k];
+	if (candidate_states[c].stopped) {
+	  // /// at its validation minimum already
+	  continue;
 	}
-	if (GLOBAL::optimization == RPROP) {
-	  candidate_model.RPROP_init();
-	  candidate_error = 
-	    candidate_model.optimize_RPROP(a, b, 
-					   GLOBAL::min_opt_iterations,
-					   GLOBAL::max_opt_iterations);
+	try {
+	  if (init) {
+	    candidate_models[c] = new FModel(global_model, candidates[c].first,
+					     candidates[c].second);
+	  }
+	  // /// a continued candidate keeps its best model of all rounds
+	  FModel previous_model;
+	  Real previous_error = candidate_errors[c];
+	  if (!init) {
+	    previous_model.copy(*(candidate_models[c]));
+	  }
+	  candidate_errors[c] = train_candidate(*(candidate_models[c]), a, b,
+						init, budget,
+						candidate_states[c]);
+	  if (!init && !(candidate_errors[c] < previous_error)) {
+	    candidate_models[c]->copy(previous_model);
+	    candidate_errors[c] = previous_error;
+	    candidate_states[c].stopped = true;
+	  }
 	}
-	else if (GLOBAL::optimization == GRAD_DESCENT) {
-	  candidate_model.GRAD_DESCENT_init();
-	  candidate_error = 
-	    candidate_model.optimize_GRAD_DESCENT(a, b, 
-						  GLOBAL::min_opt_iterations,
-						  GLOBAL::max_opt_iterations);
+	catch(Error& error) {
+	  candidate_failed[c] = 1;
+	  candidate_msgs[c] = error.msg();
 	}
-	else {
-	  throw Error((string)"fzymodel(): invalid optimization algorithm!");
+	catch(...) {
+	  candidate_failed[c] = 1;
+	  candidate_msgs[c] = "fzymodel(): unknown error in candidate training";
 	}
-	candidate_error = candidate_model.estimation(b);
-	if (GLOBAL::verbose > 1) {
-	  string output=(string)"cdim = "+itos(GLOBAL::consequence_dimension);
-	  output += (string)", epoch = " + itos(epoch);
-	  output += (string)", rule = " + itos(rule);
-	  output += (string)", variable = " + itos(variable);
-	  output += (string)", candidate error = " + dtos(candidate_error);
-	  output += "\n";
-	  if (! GLOBAL::quiet) {
-	    cout << output; 
-	  }
-	  if (GLOBAL::logfile) {
-	    GLOBAL::logfile << output;
-	  }
+      }
+      if ((GLOBAL::race_budget <= 0) || (racing.size() <= 1)
+	  || (find(candidate_failed.begin(), candidate_failed.end(), 1)
+	      != candidate_failed.end())) {
+	break;
+      }
+      racing = race_survivors(candidates, racing, candidate_models, 
+			      candidate_errors, epoch, budget);
+      budget *= 2;
+      if (budget > GLOBAL::max_opt_iterations) {
+	budget = GLOBAL::max_opt_iterations;
+      }
+      ++round;
+    } // /// end for all rounds
+    // /// choose the best candidate in the order of the serial search, 
+    // /// i.e. the result does not depend on GLOBAL::n_threads
+    for(size_t c = 0; c < candidates.size(); ++c) {
+      if (candidate_failed[c]) {
+	string msg = candidate_msgs[c];
+	for(c = 0; c < candidates.size(); ++c) {
+	  delete candidate_models[c];
+	}
+	throw Error(msg);
+      }
+      if ((GLOBAL::verbose > 1) && (candidate_models[c] != NULL)) {
+	string output=(string)"cdim = "+itos(GLOBAL::consequence_dimension);
+	output += (string)", epoch = " + itos(epoch);
+	output += (string)", rule = " + itos(candidates[c].first);
+	output += (string)", variable = " + itos(candidates[c].second);
+	output += (string)", candidate error = " + dtos(candidate_errors[c]);
+	output += "\n";
+	if (! GLOBAL::quiet) {
+	  cout << output; 
 	}
-	if (candidate_error < epoch_error) {
-	  epoch_model.copy(candidate_model);
-	  epoch_error = candidate_error;
+	if (GLOBAL::logfile) {
+	  GLOBAL::logfile << output;
 	}
-      } // end for all variables
-    } // end for all rules
+      }
+      if (candidate_errors[c] < epoch_error) {
+	epoch_model.copy(*(candidate_models[c]));
+	epoch_error = candidate_errors[c];
+      }
+    }
+    for(size_t c = 0; c < candidates.size(); ++c) {
+      delete candidate_models[c];
+    }
     // additional training of best epoch model
     if (GLOBAL::optimize_epoch_best > 0) {
 	if (GLOBAL::optimization == RPROP) {
@@ -252,6 +507,8 @@ fzymodel(char* learnfilename, char* validationfilename) throw (Error) {
     epoch_R2 = epoch_model.R2(b);
     r2file << epoch_R2 << endl;
     errfile << epoch_error << endl;
+    error_history.push_back(epoch_error);
+    R2_history.push_back(epoch_R2);
     modfile << epoch_model;
     modfile.close();
     verbose(0, "epoch_model", epoch_model);
@@ -274,9 +531,11 @@ fzymodel(char* learnfilename, char* validationfilename) throw (Error) {
       bestmodfile << best_model;
       bestmodfile.close();
     }
-  } while( ((epoch_R2 > global_R2 + GLOBAL::R2_improvement)
-	    && (epoch < GLOBAL::max_n_rules))
-	   || (epoch < GLOBAL::min_n_rules) );
+    write_checkpoint(epoch_model, best_model, epoch, best_epoch, 
+		     epoch_error, epoch_R2, global_R2, best_error, best_R2,
+		     error_history, R2_history);
+    search = continue_search(epoch, epoch_R2, global_R2);
+  }
   // /// end of Sugeno's heuristic search
   r2file.close();
   errfile.close();
@@ -416,3 +675,389 @@ fzymodel(char* learnfilename, char* validationfilename) throw (Error) {
   bestoutfile.close();
   return;
 }
+
+
+// //////////////////////////////////////////////////////////////////////
+
+Real 
+train_candidate(FModel& candidate_model, const Data& a, const Data& b,
+		bool init, size_t max_iterations, OptimizationState& state)
+  throw (Error) {
+  if (init && GLOBAL::reset_cons) {
+    candidate_model.reset_consequences();
+  }
+  if (GLOBAL::optimization == RPROP) {
+    if (init) {
+      candidate_model.RPROP_init();
+    }
+    candidate_model.optimize_RPROP(a, b, GLOBAL::min_opt_iterations,
+				   max_iterations, state);
+  }
+  else if (GLOBAL::optimization == GRAD_DESCENT) {
+    if (init) {
+      candidate_model.GRAD_DESCENT_init();
+    }
+    candidate_model.optimize_GRAD_DESCENT(a, b, GLOBAL::min_opt_iterations,
+					  max_iterations, state);
+  }
+  else {
+    throw Error((string)"fzymodel(): invalid optimization algorithm!");
+  }
+  return candidate_model.estimation(b);
+}
+
+
+// //////////////////////////////////////////////////////////////////////
+
+vector< pair<size_t, size_t> > 
+preselect_candidates(FModel& global_model, 
+		     const vector< pair<size_t, size_t> >& candidates,
+		     const Data& a, const Data& b, size_t epoch) throw (Error) {
+  // /// premise values of global_model, once for all candidates: each
+  // /// candidate evaluates only its two new rules
+  vector<Real> w_a;
+  vector<Real> w_b;
+  global_model.premvalues(a, w_a);
+  global_model.premvalues(b, w_b);
+  // /// the least squares problem of global_model on a, decomposed once
+  // /// for all candidates: it preconditions each candidate's CGLS
+  SplitLeastSquares* parent_ls = NULL;
+  if (GLOBAL::consequence_update) {
+    parent_ls = global_model.split_LS(a, w_a);
+  }
+  // /// initial error of each candidate: SVD of the consequences on a, 
+  // /// estimation on b
+  vector<Real> candidate_errors(candidates.size(), REAL_MAX);
+  vector<int> candidate_failed(candidates.size(), 0);
+  vector<string> candidate_msgs(candidates.size());
+  int n_candidates = (int)candidates.size();
+#pragma omp parallel for schedule(dynamic) num_threads(GLOBAL::n_threads)
+  for(int c = 0; c < n_candidates; ++c) {
+    try {
+      FModel candidate_model(global_model, candidates[c].first,
+			     candidates[c].second);
+      candidate_model.optimize_SVD(a, w_a, candidates[c].first, parent_ls);
+      candidate_errors[c] = 
+	candidate_model.estimation(b, w_b, candidates[c].first);
+    }
+    catch(Error& error) {
+      candidate_failed[c] = 1;
+      candidate_msgs[c] = error.msg();
+    }
+    catch(...) {
+      candidate_failed[c] = 1;
+      candidate_msgs[c] = "fzymodel(): unknown error in candidate preselection";
+    }
+  }
+  delete parent_ls;
+  // /// rank the candidates; equal errors keep the order of the search
+  vector< pair<Real, size_t> > ranking;
+  for(size_t c = 0; c < candidates.size(); ++c) {
+    if (candidate_failed[c]) {
+      throw Error(candidate_msgs[c]);
+    }
+    ranking.push_back(pair<Real, size_t>(candidate_errors[c], c));
+  }
+  sort(ranking.begin(), ranking.end());
+  vector<int> chosen(candidates.size(), 0);
+  for(size_t k = 0; k < (size_t)GLOBAL::preselect; ++k) {
+    chosen[ranking[k].second] = 1;
+  }
+  // /// the chosen candidates, in the order of the search
+  vector< pair<size_t, size_t> > preselected;
+  for(size_t c = 0; c < candidates.size(); ++c) {
+    if (GLOBAL::verbose > 1) {
+      string output=(string)"cdim = "+itos(GLOBAL::consequence_dimension);
+      output += (string)", epoch = " + itos(epoch);
+      output += (string)", rule = " + itos(candidates[c].first);
+      output += (string)", variable = " + itos(candidates[c].second);
+      output += (string)", initial error = " + dtos(candidate_errors[c]);
+      output += chosen[c] ? " (preselected)\n" : "\n";
+      if (! GLOBAL::quiet) {
+	cout << output; 
+      }
+      if (GLOBAL::logfile) {
+	GLOBAL::logfile << output;
+      }
+    }
+    if (chosen[c]) {
+      preselected.push_back(candidates[c]);
+    }
+  }
+  return preselected;
+}
+
+
+// //////////////////////////////////////////////////////////////////////
+
+vector<size_t>
+race_survivors(const vector< pair<size_t, size_t> >& candidates,
+	       const vector<size_t>& racing, 
+	       vector<FModel*>& candidate_models, 
+	       vector<Real>& candidate_errors, size_t epoch, size_t budget) {
+  // /// rank the racing candidates; equal errors keep the search order
+  vector< pair<Real, size_t> > ranking;
+  for(size_t k = 0; k < racing.size(); ++k) {
+    ranking.push_back(pair<Real, size_t>(candidate_errors[racing[k]], 
+					 racing[k]));
+  }
+  sort(ranking.begin(), ranking.end());
+  // /// the better half (rounded up) survives
+  size_t n_survivors = (racing.size() + 1) / 2;
+  vector<size_t> survivors;
+  for(size_t k = 0; k < ranking.size(); ++k) {
+    size_t c = ranking[k].second;
+    if (GLOBAL::verbose > 1) {
+      string output=(string)"cdim = "+itos(GLOBAL::consequence_dimension);
+      output += (string)", epoch = " + itos(epoch);
+      output += (string)", rule = " + itos(candidates[c].first);
+      output += (string)", variable = " + itos(candidates[c].second);
+      output += (string)", race budget = " + itos(budget);
+      output += (string)", race error = " + dtos(candidate_errors[c]);
+      output += (k < n_survivors) ? "\n" : " (dropped)\n";
+      if (! GLOBAL::quiet) {
+	cout << output; 
+      }
+      if (GLOBAL::logfile) {
+	GLOBAL::logfile << output;
+      }
+    }
+    if (k < n_survivors) {
+      survivors.push_back(c);
+    }
+    else {
+      delete candidate_models[c];
+      candidate_models[c] = NULL;
+      candidate_errors[c] = REAL_MAX;
+    }
+  }
+  // /// the survivors, in the order of the search
+  sort(survivors.begin(), survivors.end());
+  return survivors;
+}
+
+// //////////////////////////////////////////////////////////////////////
+
+bool
+continue_search(size_t epoch, Real epoch_R2, Real global_R2) {
+  return ( ((epoch_R2 > global_R2 + GLOBAL::R2_improvement)
+	    && (epoch < GLOBAL::max_n_rules))
+	   || (epoch < GLOBAL::min_n_rules) );
+}
+
+// //////////////////////////////////////////////////////////////////////
+
+/// markers of the model sections of a checkpoint file
+static const char* checkpoint_epoch_marker = "### epoch model";
+static const char* checkpoint_best_marker = "### best model";
+static const char* checkpoint_end_marker = "### end of checkpoint";
+
+/// flush a written file (or, but not on Windows, directory) to the disk
+static void 
+sync_file(const string& filename) throw (Error) {
+#ifndef WIN2017
+  int fd = open(filename.c_str(), O_RDONLY);
+  if (fd < 0) {
+    throw FileOpenError(filename);
+  }
+  int status = fsync(fd);
+  int fsync_errno = errno;
+  close(fd);
+  // /// some file systems cannot sync directories
+  if ((status != 0) && (fsync_errno != EINVAL)) {
+    throw Error((string)"write_checkpoint(): cannot sync `" 
+		+ filename + "'");
+  }
+#else
+  HANDLE handle = CreateFileA(filename.c_str(), GENERIC_WRITE, 
+			      FILE_SHARE_READ | FILE_SHARE_WRITE, NULL, 
+			      OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+  if (handle == INVALID_HANDLE_VALUE) {
+    throw FileOpenError(filename);
+  }
+  BOOL flushed = FlushFileBuffers(handle);
+  CloseHandle(handle);
+  if (! flushed) {
+    throw Error((string)"write_checkpoint(): cannot sync `" 
+		+ filename + "'");
+  }
+#endif
+  return;
+}
+
+// //////////////////////////////////////////////////////////////////////
+
+void 
+write_checkpoint(const FModel& epoch_model, const FModel& best_model,
+		 size_t epoch, size_t best_epoch, 
+		 Real epoch_error, Real epoch_R2, Real global_R2,
+		 Real best_error, Real best_R2,
+		 const vector<Real>& error_history, 
+		 const vector<Real>& R2_history) throw (Error) {
+  assert(error_history.size() == R2_history.size());
+  string filename = GLOBAL::basefilename + "_rr" + checkpoint_suffix;
+  string tmpfilename = filename + ".tmp";
+  // /// enough digits to read back the same Real values
+  int precision = REAL_DIG + 3;
+  // /// the state and both models go into one file, which replaces the
+  // /// last checkpoint by a single rename once it is on the disk; an
+  // /// interrupted write therefore keeps the last checkpoint complete
+  ofstream file(tmpfilename.c_str());
+  if (!file) {
+    throw FileOpenError(tmpfilename);
+  }
+  file.precision(precision);
+  file << "### fzymodel checkpoint (see option --resume)\n";
+  file << "epoch = " << epoch << endl;
+  file << "best_epoch = " << best_epoch << endl;
+  file << "epoch_error = " << epoch_error << endl;
+  file << "epoch_R2 = " << epoch_R2 << endl;
+  file << "global_R2 = " << global_R2 << endl;
+  file << "best_error = " << best_error << endl;
+  file << "best_R2 = " << best_R2 << endl;
+  file << "history = " << error_history.size() << endl;
+  for(size_t i = 0; i < error_history.size(); ++i) {
+    file << error_history[i] << " " << R2_history[i] << endl;
+  }
+  file << checkpoint_epoch_marker << endl;
+  epoch_model.write(file, precision);
+  file << checkpoint_best_marker << endl;
+  best_model.write(file, precision);
+  file << checkpoint_end_marker << endl;
+  file.close();
+  if (!file) {
+    throw Error((string)"write_checkpoint(): cannot write `" 
+		+ tmpfilename + "'");
+  }
+  sync_file(tmpfilename);
+#ifndef WIN2017
+  bool renamed = (rename(tmpfilename.c_str(), filename.c_str()) == 0);
+#else
+  // /// rename() does not replace an existing file on Windows; the
+  // /// write through makes the rename durable (as on Unix the sync of
+  // /// the directory)
+  bool renamed = MoveFileExA(tmpfilename.c_str(), filename.c_str(),
+			     MOVEFILE_REPLACE_EXISTING 
+			     | MOVEFILE_WRITE_THROUGH);
+#endif
+  if (! renamed) {
+    throw Error((string)"write_checkpoint(): cannot rename `" 
+		+ tmpfilename + "'");
+  }
+#ifndef WIN2017
+  // /// make the rename itself durable
+  string::size_type separator = filename.rfind(file_separator);
+  sync_file((separator == string::npos)
+	    ? (string)"." : filename.substr(0, separator + 1));
+#endif
+  return;
+}
+
+// //////////////////////////////////////////////////////////////////////
+
+/// read `name = value' from a checkpoint file
+template <class T>
+void read_checkpoint_entry(istream& file, const string& filename, 
+			   const string& name, T& value) throw (Error) {
+  string key;
+  string assign;
+  file >> key >> assign >> value;
+  if ((!file) || (key != name) || (assign != "=")) {
+    throw Error((string)"read_checkpoint(): `" + name + "' expected in `" 
+		+ filename + "'");
+  }
+}
+
+// //////////////////////////////////////////////////////////////////////
+
+/// load the model section of a checkpoint file, up to end_marker
+static void 
+read_checkpoint_model(istream& file, const string& filename, 
+		      const char* end_marker, FModel& model) throw (Error) {
+  // /// the model parser reads a FILE, so the section is copied into a
+  // /// temporary one
+  FILE* section = tmpfile();
+  if (section == NULL) {
+    throw Error((string)"read_checkpoint(): cannot create a temporary file");
+  }
+  string line;
+  bool complete = false;
+  while (getline(file, line)) {
+    if (line == end_marker) {
+      complete = true;
+      break;
+    }
+    fputs(line.c_str(), section);
+    fputc('\n', section);
+  }
+  if (!complete) {
+    fclose(section);
+    throw Error((string)"read_checkpoint(): `" + end_marker
+		+ "' expected in `" + filename + "'");
+  }
+  rewind(section);
+  try {
+    model.load(section, filename);
+  }
+  catch(Error&) {
+    fclose(section);
+    throw;
+  }
+  fclose(section);
+  return;
+}
+
+// //////////////////////////////////////////////////////////////////////
+
+void 
+read_checkpoint(FModel& epoch_model, FModel& best_model,
+		size_t& epoch, size_t& best_epoch, 
+		Real& epoch_error, Real& epoch_R2, Real& global_R2,
+		Real& best_error, Real& best_R2,
+		vector<Real>& error_history, 
+		vector<Real>& R2_history) throw (Error) {
+  string filename = GLOBAL::basefilename + "_rr" + checkpoint_suffix;
+  ifstream file(filename.c_str());
+  if (!file) {
+    throw FileOpenError(filename);
+  }
+  // /// skip the comment line
+  string line;
+  getline(file, line);
+  size_t n_history = 0;
+  read_checkpoint_entry(file, filename, "epoch", epoch);
+  read_checkpoint_entry(file, filename, "best_epoch", best_epoch);
+  read_checkpoint_entry(file, filename, "epoch_error", epoch_error);
+  read_checkpoint_entry(file, filename, "epoch_R2", epoch_R2);
+  read_checkpoint_entry(file, filename, "global_R2", global_R2);
+  read_checkpoint_entry(file, filename, "best_error", best_error);
+  read_checkpoint_entry(file, filename, "best_R2", best_R2);
+  read_checkpoint_entry(file, filename, "history", n_history);
+  error_history.resize(n_history);
+  R2_history.resize(n_history);
+  for(size_t i = 0; i < n_history; ++i) {
+    file >> error_history[i] >> R2_history[i];
+  }
+  // /// the end of the last line before the models
+  getline(file, line);
+  if (!file) {
+    throw Error((string)"read_checkpoint(): history incomplete in `" 
+		+ filename + "'");
+  }
+  getline(file, line);
+  if (line != checkpoint_epoch_marker) {
+    throw Error((string)"read_checkpoint(): `" + checkpoint_epoch_marker
+		+ "' expected in `" + filename + "'");
+  }
+  read_checkpoint_model(file, filename, checkpoint_best_marker, epoch_model);
+  read_checkpoint_model(file, filename, checkpoint_end_marker, best_model);
+  file.close();
+  // /// the model of an epoch has as many rules as the epoch's number
+  if ((epoch_model.rdim() != epoch) || (best_model.rdim() != best_epoch)
+      || (epoch_model.cdim() != GLOBAL::consequence_dimension)
+      || (best_model.cdim() != GLOBAL::consequence_dimension)) {
+    throw Error((string)"read_checkpoint(): models in `" + filename
+		+ "' do not match its state");
+  }
+  return;
+}
@@ -28,6 +28,8 @@
  */
 
 
+#include "data.hh"
+
 
 /** Build a fuzzy model, based on learning and validation data.
  * 
@@ -37,9 +39,34 @@
  * best models to mod_[filename_extension]c[C]_r[R].mod,
  * R2 to mod_[filename_extension]c[C].r2,
  * and error to mod_[filename_extension]c[C].err
+ *
+ * The search starts from the one-rule model, or from the model in
+ * modelfilename (if not NULL).
+ * After each epoch, a checkpoint (the state, the epoch model, and the 
+ * best model) replaces mod_[filename_extension]c[C]_rr.ckp in one 
+ * rename; with GLOBAL::resume, the search continues from it.
+ * @memo
+ */
+void fzymodel(char* learnfilename, char* validationfilename, 
+	      char* modelfilename = NULL) throw (Error);
+
+/// build a fuzzy model, based on the loaded learning data a and 
+/// validation data b (see above)
+void fzymodel(Data& a, Data& b, char* modelfilename = NULL) throw (Error);
+
+/** Build a fuzzy model from raw data in one process: normalize by the 
+ * data in normfilename (as fzynorml), make the learning and validation 
+ * data of the raw data in learnfilename and validationfilename (as 
+ * fzymkdat, with GLOBAL::dynamic_orders), and model them (as above). 
+ * The data stays in memory; with GLOBAL::pipeline_files, the 
+ * intermediate files are written as well: [normfilename].nor, and 
+ * .nrm and .ogl files named by the raw data files without extension
+ * (the .ogl files unless GLOBAL::pipeline_original is 0).
  * @memo
  */
-void fzymodel(char* learnfilename, char* validationfilename) throw (Error);
+void fzypipeline(char* normfilename, char* learnfilename, 
+		 char* validationfilename, char* modelfilename = NULL) 
+  throw (Error);
 
 
 #endif /// #ifndef FZYMODEL_HH
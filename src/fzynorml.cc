@@ -33,6 +33,7 @@
 // #include <numeric>
 // #include <algorithm>
 #endif
+#include <stdint.h>
 
 #include "global.hh"
 #include "data.hh"
@@ -40,12 +41,153 @@
 
 #include "fzynorml.hh"
 
+/** Running statistics of the columns u_1, ..., u_n, y of a data file: 
+ * count, min, max, mean and the sum of squared deviations from the 
+ * mean, updated pattern by pattern (Welford). Two of them merge into 
+ * the statistics of both parts (Chan, Golub, LeVeque).
+ * The sums are kept in double, for files of many millions of rows.
+ * @memo column statistics in one pass
+ */
+class ColumnMoments
+{
+public:
+  double n_;
+  vector<Real> min_;
+  vector<Real> max_;
+  vector<double> mean_;
+  vector<double> m2_;
+  ColumnMoments(size_t n_columns = 0)
+    : n_(0.0), min_(n_columns, REAL_MAX), max_(n_columns, -REAL_MAX), 
+      mean_(n_columns, 0.0), m2_(n_columns, 0.0) { }
+  /// add the pattern (u, y)
+  void add(const Urow& u, Real y) {
+    n_ += 1.0;
+    size_t col = 0;
+    for (Urow::const_iterator p = u.begin(); p != u.end(); ++p, ++col) {
+      add(col, *p);
+    }
+    add(col, y);
+  }
+  /// merge the statistics b of further patterns
+  void merge(const ColumnMoments& b) {
+    if (b.n_ == 0.0) {
+      return;
+    }
+    double n = n_ + b.n_;
+    for (size_t col = 0; col < mean_.size(); ++col) {
+      double delta = b.mean_[col] - mean_[col];
+      mean_[col] += delta * b.n_ / n;
+      m2_[col] += b.m2_[col] + delta * delta * n_ * b.n_ / n;
+      if (min_[col] > b.min_[col]) min_[col] = b.min_[col];
+      if (max_[col] < b.max_[col]) max_[col] = b.max_[col];
+    }
+    n_ = n;
+  }
+private:
+  void add(size_t col, Real x) {
+    if (min_[col] > x) min_[col] = x;
+    if (max_[col] < x) max_[col] = x;
+    double delta = x - mean_[col];
+    mean_[col] += delta / n_;
+    m2_[col] += delta * (x - mean_[col]);
+  }
+};
+
+
+static void
+write_normalization(const char* infilename, const char* outfilename,
+		    size_t n_rows, const vector<Real>& min, 
+		    const vector<Real>& max, const vector<Real>& mean, 
+		    const vector<Real>& stddev, vector<Real>& scale_factor, 
+		    vector<Real>& scale_shift) throw (Error);
+
+
+/** Normalization of the data file infilename chunk by chunk of 
+ * GLOBAL::stream_rows rows, i.e., in the memory of one chunk.
+ *
+ * Min, max, mean and standard deviation of all columns are computed in 
+ * one pass over the data (see ColumnMoments); each chunk is cut into 
+ * slices of a fixed number of rows, evaluated by GLOBAL::n_parse_threads 
+ * threads and merged in order, i.e., the result does not depend on the 
+ * number of threads. It may differ in the last digits from fzynorml() 
+ * on the loaded data, which sums in Real.
+ * The file is not scanned first, and with GLOBAL::scale_only_used_data 
+ * only its rows to normalize are read; the .nor file then gives their 
+ * number as the rows of the file.
+ * @memo normalization of a data file chunk by chunk
+ */
+static void
+fzynorml_stream(char* infilename, char* outfilename) throw (Error) {
+  DataReader reader(infilename, false);
+  // /// scale factor/shift are computed based on ALL input patterns
+  // /// (also on patterns not needed for training and validation data)
+  size_t n_patterns_normalize = SIZE_MAX;
+  if (GLOBAL::scale_only_used_data > 0) {
+    n_patterns_normalize = GLOBAL::scale_only_used_data;
+  }
+
+  const size_t slice_rows = 4096;
+  size_t n_columns = 0;
+  ColumnMoments moments;
+  vector<ColumnMoments> slices;
+  Data chunk;
+  size_t row = 0;
+  while ((row < n_patterns_normalize) 
+	 && reader.read(chunk, min((size_t)GLOBAL::stream_rows, 
+				   n_patterns_normalize - row))) {
+    if (row == 0) {
+      n_columns = reader.udim() + 1;
+      moments = ColumnMoments(n_columns);
+    }
+    size_t n_chunk = chunk.y().size();
+    row += n_chunk;
+    int n_slices = (int)((n_chunk + slice_rows - 1) / slice_rows);
+    slices.assign(n_slices, ColumnMoments(n_columns));
+    // /// the threads read the chunk through the const accessors only
+    const Umatrix& U = chunk.U();
+    const vector<Real>& y = chunk.y();
+#pragma omp parallel for schedule(static) num_threads(GLOBAL::n_parse_threads)
+    for (int s = 0; s < n_slices; ++s) {
+      size_t end = (s + 1) * slice_rows;
+      if (end > n_chunk) {
+	end = n_chunk;
+      }
+      for (size_t i = s * slice_rows; i < end; ++i) {
+	slices[s].add(U[i], y[i]);
+      }
+    }
+    for (int s = 0; s < n_slices; ++s) {
+      moments.merge(slices[s]);
+    }
+  }
+  if (row < 1) {
+    verbose(0, "warning: no data in file", infilename);
+    return;
+  }
+
+  vector<Real> mean(n_columns, 0.0);
+  vector<Real> stddev(n_columns, 1.0);
+  for (size_t col = 0; col < n_columns; ++col) {
+    mean[col] = moments.mean_[col];
+    if (moments.n_ > 1.0) {
+      stddev[col] = sqrt(moments.m2_[col] / moments.n_);
+    }
+  }
+  vector<Real> scale_factor;
+  vector<Real> scale_shift;
+  write_normalization(infilename, outfilename, row, moments.min_, 
+		      moments.max_, mean, stddev, scale_factor, scale_shift);
+  return;
+}
+
+
 void 
 fzynorml(char* infilename, char* outfilename)
   throw (Error) {
-  
-  const Real scale_interval_width = 1.25 * interval_width;
-
+  if (GLOBAL::stream_rows > 0) {
+    fzynorml_stream(infilename, outfilename);
+    return;
+  }
   Data a;
   a.load(infilename);
 
@@ -59,17 +201,29 @@ fzynorml(char* infilename, char* outfilename)
     verbose(0, "warning: no data in file", infilename);
     return;
   }
+  vector<Real> scale_factor;
+  vector<Real> scale_shift;
+  fzynorml(a, infilename, outfilename, scale_factor, scale_shift);
+  return;
+}
 
-  ofstream outfile;
-  outfile.open(outfilename);
-  if (!outfile) {
-    throw FileOpenError(outfilename);
+
+void 
+fzynorml(const Data& a, const char* infilename, const char* outfilename,
+	 vector<Real>& scale_factor, vector<Real>& scale_shift)
+  throw (Error) {
+  
+  size_t n_rows = a.U().size();
+  if (n_rows < 1) {
+    throw Error((string)"no data in file `" + infilename + "'!");
   }
+  size_t n_columns = a.udim() + 1;
 
   // /// scale factor/shift are computed based on ALL input patterns
   // /// (also on patterns not needed for training and validation data)
   int n_patterns_normalize = GLOBAL::scale_only_used_data;
-  if (GLOBAL::scale_only_used_data == 0) {
+  if ((GLOBAL::scale_only_used_data == 0) 
+      || ((size_t)GLOBAL::scale_only_used_data > n_rows)) {
     n_patterns_normalize = n_rows;
   }
 
@@ -80,9 +234,9 @@ fzynorml(char* infilename, char* outfilename)
   vector<Real>::iterator psum;
   vector<Real>::iterator pmin;
   vector<Real>::iterator pmax;
-  vector<Uvector>::iterator paU = a.U().begin();  
+  Umatrix::const_iterator paU = a.U().begin();  
   while (paU != a.U().begin() + n_patterns_normalize) {
-    Uvector::iterator p = paU->begin();  
+    Urow::const_iterator p = paU->begin();  
     psum = sum.begin();
     pmin = min.begin();
     pmax = max.begin();
@@ -98,7 +252,7 @@ fzynorml(char* infilename, char* outfilename)
   pmin = min.end() - 1;
   pmax = max.end() - 1;
   psum = sum.end() - 1;
-  vector<Real>::iterator pay = a.y().begin();
+  vector<Real>::const_iterator pay = a.y().begin();
   while (pay != a.y().begin() + n_patterns_normalize) {
     if (*pmin > *pay) *pmin = *pay;
     if (*pmax < *pay) *pmax = *pay;
@@ -121,7 +275,7 @@ fzynorml(char* infilename, char* outfilename)
   while (paU != a.U().begin() + n_patterns_normalize) {
     pmean = mean.begin();
     pstddev = stddev.begin();
-    Uvector::iterator p = paU->begin();  
+    Urow::const_iterator p = paU->begin();  
     while (p != paU->end()) {
       Real diff = *(p++) - *(pmean++);
       *(pstddev++) += diff * diff; // variance
@@ -152,20 +306,48 @@ fzynorml(char* infilename, char* outfilename)
     }
   }
 
+  write_normalization(infilename, outfilename, n_rows, min, max, mean, stddev,
+		      scale_factor, scale_shift);
+  return;
+}
+
+
+/** Compute scale_factor and scale_shift from the statistics of the 
+ * columns, and write them to outfilename (if not NULL).
+ * @memo
+ */
+static void
+write_normalization(const char* infilename, const char* outfilename,
+		    size_t n_rows, const vector<Real>& min, 
+		    const vector<Real>& max, const vector<Real>& mean, 
+		    const vector<Real>& stddev, vector<Real>& scale_factor, 
+		    vector<Real>& scale_shift) throw (Error) {
+
+  const Real scale_interval_width = 1.25 * interval_width;
+  size_t n_columns = mean.size();
+
+  ofstream outfile;
+  if ((outfilename != NULL) && ! GLOBAL::binary_data) {
+    outfile.open(outfilename);
+    if (!outfile) {
+      throw FileOpenError(outfilename);
+    }
+  }
+
   // /// calculate scale_shift ( = mean )
-  vector<Real> scale_shift(n_columns, 0.0);
+  scale_shift.assign(n_columns, 0.0);
   vector<Real>::iterator pshift = scale_shift.begin();
-  pmean = mean.begin();
+  vector<Real>::const_iterator pmean = mean.begin();
   while (pshift != scale_shift.end()) {
     *(pshift++) = *(pmean++);
   }
 
   // /// calculate scale_factor
-  vector<Real> scale_factor(n_columns, 0.0);
+  scale_factor.assign(n_columns, 0.0);
   vector<Real>::iterator pfactor = scale_factor.begin();
   if (GLOBAL::scale_by_standard_deviation) {
     // normalization factor
-    pstddev = stddev.begin();
+    vector<Real>::const_iterator pstddev = stddev.begin();
     while (pfactor != scale_factor.end()) {
       *pfactor = 0.5 * interval_width / (GLOBAL::sigma_factor * *pstddev);
       ++pfactor;
@@ -190,6 +372,22 @@ fzynorml(char* infilename, char* outfilename)
     throw Error("No scale method specified!"); 
   }
 
+  if (outfilename == NULL) {
+    return;
+  }
+  if (GLOBAL::binary_data) {
+    // /// the rows scale_shift and scale_factor, as in the text file
+    Umatrix U(2, n_columns - 1);
+    vector<Real> y(2);
+    for (size_t col = 0; col + 1 < n_columns; ++col) {
+      U[0][col] = scale_shift[col];
+      U[1][col] = scale_factor[col];
+    }
+    y[0] = scale_shift[n_columns - 1];
+    y[1] = scale_factor[n_columns - 1];
+    write_binary_data(outfilename, U, y, 0, 2, 0, scale_factor, scale_shift);
+    return;
+  }
   outfile << "##source: \"" << infilename << "\"\n";
   outfile << "##rows: " << n_rows << "\n";
   outfile << "##columns: " << n_columns << "\n";
@@ -48,5 +48,14 @@ const Real interval_width = 1.0 * (mu_left - mu_right);
 void fzynorml(char* infilename, char* outfilename)
   throw (Error);
 
+/** Compute the normalization of the data a, loaded from infilename, 
+ * into scale_factor and scale_shift, and write it to outfilename 
+ * (if not NULL).
+ * @memo
+ */
+void fzynorml(const Data& a, const char* infilename, const char* outfilename,
+	      vector<Real>& scale_factor, vector<Real>& scale_shift)
+  throw (Error);
+
 
 #endif /// #ifndef FZYNORML_HH
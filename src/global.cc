@@ -48,6 +48,7 @@ const char* model_suffix = ".fzy";
 const char* r2_suffix = ".r2";
 const char* error_suffix = ".err";
 const char* log_suffix = ".log";
+const char* checkpoint_suffix = ".ckp";
 const char* output_suffix = ".out";
 const char* pixl_suffix = ".pxl";
 const char* eps_suffix = ".eps";
@@ -80,6 +81,8 @@ ofstream GLOBAL::logfile;
 string GLOBAL::tracefilename = "tracefile.log";
 ofstream GLOBAL::tracefile;
 int GLOBAL::denormalize = 0;
+int GLOBAL::binary_data = 0;
+int GLOBAL::n_parse_threads = 1;
 
 // mode == MODELING
 algo_type GLOBAL::optimization = RPROP;
@@ -87,6 +90,8 @@ size_t GLOBAL::consequence_dimension = 1;
 int GLOBAL::norm = 2;
 int GLOBAL::local_cons_optimization = 0;
 int GLOBAL::shortcut = 0;
+int GLOBAL::preselect = 0;
+int GLOBAL::race_budget = 0;
 int GLOBAL::reset_cons = 0;
 int GLOBAL::update_premise = 1;
 size_t GLOBAL::min_n_rules = 2;
@@ -96,6 +101,11 @@ size_t GLOBAL::steps_per_validation = 4;
 //size_t GLOBAL::steps_per_validation = 1;
 int GLOBAL::consequence_optimize_SVD = 0;
 //int GLOBAL::consequence_optimize_SVD = 1;
+int GLOBAL::consequence_streaming = 0;
+int GLOBAL::svd_threads = 0;
+int GLOBAL::consequence_update = 0;
+int GLOBAL::consequence_local = 0;
+int GLOBAL::mirror_columns = 0;
 size_t GLOBAL::max_opt_iterations_parallel = 100000;
 size_t GLOBAL::min_opt_iterations = 12;
 size_t GLOBAL::max_opt_iterations = 250;
@@ -110,6 +120,12 @@ int GLOBAL::optimize_global_best = 10000;
 Real GLOBAL::alpha = 0.001;
 Real GLOBAL::beta = 0.9;
 algo_type GLOBAL::parallel_optimization = UNDEFD_ALGO;
+int GLOBAL::n_threads = 1;
+int GLOBAL::n_gradient_threads = 1;
+int GLOBAL::resume = 0;
+char* GLOBAL::pipeline_data = NULL;
+int GLOBAL::pipeline_files = 0;
+int GLOBAL::pipeline_original = 1;
 
 // mode == PRINT_SETS
 size_t GLOBAL::n_pixels = 100;
@@ -126,6 +142,10 @@ Real GLOBAL::page_hinkley_mu_0 = 0.0;
 Real GLOBAL::page_hinkley_nu_inc = 0.0;
 Real GLOBAL::page_hinkley_nu_dec = 0.0;
 Real GLOBAL::page_hinkley_lambda = 0.0;
+int GLOBAL::tree_premises = 0;
+int GLOBAL::stream_rows = 0;
+int GLOBAL::serve = 0;
+char* GLOBAL::serve_socket = NULL;
 
 // mode == SIMULATION
 int GLOBAL::order = 0;
@@ -135,6 +155,7 @@ int GLOBAL::n_training_data = 0;
 int GLOBAL::n_skip_data = 0;
 vector<int> GLOBAL::dynamic_orders;
 int GLOBAL::ut_regressor = 0;
+char* GLOBAL::make_data_configs = NULL;
 
 // mode == NORMALIZE
 int GLOBAL::scale_only_used_data = 0;
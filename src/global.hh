@@ -139,6 +139,8 @@ extern const char* r2_suffix;
 extern const char* error_suffix;
 /// suffix of logfile
 extern const char* log_suffix;
+/// suffix of checkpoint files (of the structure search)
+extern const char* checkpoint_suffix;
 /// suffix of output file
 extern const char* output_suffix;
 /// suffix of pixel file (for graphical description of a fuzzy set)
@@ -239,6 +241,10 @@ namespace GLOBAL {
   extern ofstream logfile;
   /// take back normalization 
   extern int denormalize;
+  /// write data files in the binary format (see write_binary_data())
+  extern int binary_data;
+  /// no. of threads parsing a text data file (see Data::load())
+  extern int n_parse_threads;
   //@}
 
   /** @name Options for #mode == MODELING#
@@ -254,6 +260,12 @@ namespace GLOBAL {
   extern int local_cons_optimization;
   /// use shortcut for Kang's heuristic search
   extern int shortcut;
+  /// no. of candidates per epoch that are trained, preselected by their
+  /// initial (SVD) error; 0 = train all candidates
+  extern int preselect;
+  /// optimization iterations of the first round of a candidate race
+  /// (successive halving); 0 = no race
+  extern int race_budget;
   /// reset consequence parameters 
   extern int reset_cons;
   /// update premise when optimizing 
@@ -268,6 +280,22 @@ namespace GLOBAL {
   extern size_t steps_per_validation;
   /// optimize the consequence of each new candidate model by SVD
   extern int consequence_optimize_SVD;
+  /// solve the consequences' least squares problem by a streaming QR
+  /// decomposition (O(n^2) memory) instead of the SVD of the whole matrix
+  extern int consequence_streaming;
+  /// threads of the blocked QR preceding the SVD of the consequences'
+  /// least squares problem; 0 for the plain Golub-Reinsch SVD
+  extern int svd_threads;
+  /// fit the consequences of the preselected candidates by CGLS, 
+  /// preconditioned by the QR factors of the parent model's least 
+  /// squares problem (see SplitLeastSquares), else by SVD
+  extern int consequence_update;
+  /// fit the consequence of each rule separately by least squares, 
+  /// weighted by the rule's normalized premise values
+  extern int consequence_local;
+  /// mirror the u-parts of the learn and validation data column by 
+  /// column for the block kernels (see Umatrix::mirror_columns())
+  extern int mirror_columns;
   /// maximal no. of optimization iterations for parallel tuning
   extern size_t max_opt_iterations_parallel;
   /// minimal no. of optimization iterations
@@ -292,6 +320,20 @@ namespace GLOBAL {
   extern Real beta;
   /// algorithm for parameter optimization (fine tuning) using parallel model
   extern algo_type parallel_optimization;
+  /// no. of threads training the candidate models of an epoch concurrently
+  extern int n_threads;
+  /// no. of threads (data shards) accumulating RPROP/GRAD_DESCENT gradients
+  extern int n_gradient_threads;
+  /// resume the structure search from its checkpoint
+  extern int resume;
+  /// raw data file to normalize by in the pipeline from raw data (see 
+  /// fzypipeline()); NULL if the learning and validation data are made
+  extern char* pipeline_data;
+  /// write the intermediate files of the pipeline
+  extern int pipeline_files;
+  /// with the intermediate files, write the original data (.ogl files;
+  /// fzymkdat option -o)
+  extern int pipeline_original;
   //@}
   
   /** @name Options for #mode == PRINT_SETS#
@@ -326,6 +368,14 @@ namespace GLOBAL {
   extern Real page_hinkley_nu_dec;
   /// sensitivity lambda
   extern Real page_hinkley_lambda;
+  /// evaluate rule premises along the refinement tree
+  extern int tree_premises;
+  /// stream the data file in chunks of this many rows (0: load it at once)
+  extern int stream_rows;
+  /// serve estimations of the patterns read from stdin or serve_socket
+  extern int serve;
+  /// Unix domain socket to serve on (NULL: stdin and stdout)
+  extern char* serve_socket;
   //@}
 
   /** @name Options for #mode == SIMULATION#.
@@ -346,6 +396,8 @@ namespace GLOBAL {
   extern vector<int> dynamic_orders;
   /// start with u(t) as regressor (instead of u(t-1))
   extern int ut_regressor;
+  /// file of configurations to create in one run (NULL for none)
+  extern char* make_data_configs;
   //@}
 
   /** @name Options for #mode == NORMALIZE#.
@@ -374,9 +426,12 @@ namespace GLOBAL {
 template <class T>
 void tracemsg(int level, const string& name, const T& object) {
   if (GLOBAL::tracelevel >= level) {
-	cerr << "*** " << name << " = `" << object << "'\n" << flush; 	
-    if (GLOBAL::tracefile) {
-      GLOBAL::tracefile << "***trace: " << name << " = `" << object << "'\n" << flush; 
+#pragma omp critical (fzy_output)
+    {
+      cerr << "*** " << name << " = `" << object << "'\n" << flush; 	
+      if (GLOBAL::tracefile) {
+	GLOBAL::tracefile << "***trace: " << name << " = `" << object << "'\n" << flush; 
+      }
     }
   }
 }
@@ -387,11 +442,14 @@ void tracemsg(int level, const string& name, const T& object) {
 template <class T>
 void verbose(int level, const string& name, const T& object) {
   if (GLOBAL::verbose > level) {
-    if (! GLOBAL::quiet) {
-      cout << name << " = `" << object << "'\n"; 
-    }
-    if (GLOBAL::logfile) {
-      GLOBAL::logfile << name << " = `" << object << "'\n"; 
+#pragma omp critical (fzy_output)
+    {
+      if (! GLOBAL::quiet) {
+	cout << name << " = `" << object << "'\n"; 
+      }
+      if (GLOBAL::logfile) {
+	GLOBAL::logfile << name << " = `" << object << "'\n"; 
+      }
     }
   }
 }
@@ -152,7 +152,8 @@ main(int argc, char* argv[], char* env[])
       }
     }
     else if (! arg.compare("-f3")) { 
-      if (GLOBAL::mode == MAKE_DATA) {
+      if ((GLOBAL::mode == MODELING)
+	  || (GLOBAL::mode == MAKE_DATA)) {
 	if (++i < argc) {
 	  infilename3 = argv[i]; 
 	}
@@ -273,6 +274,51 @@ main(int argc, char* argv[], char* env[])
 	exit_on_msg(cerr, "unknown option `" + arg + "'");
       }
     }
+    else if (! arg.compare("-Cs")) { 
+      if (GLOBAL::mode == MODELING) {
+	GLOBAL::consequence_streaming = 1;
+      }
+      else {
+	exit_on_msg(cerr, "unknown option `" + arg + "'");
+      }
+    }
+    else if (! arg.compare("-Cl")) { 
+      if (GLOBAL::mode == MODELING) {
+	GLOBAL::consequence_local = 1;
+      }
+      else {
+	exit_on_msg(cerr, "unknown option `" + arg + "'");
+      }
+    }
+    else if (! arg.compare("-Cu")) { 
+      if (GLOBAL::mode == MODELING) {
+	GLOBAL::consequence_update = 1;
+      }
+      else {
+	exit_on_msg(cerr, "unknown option `" + arg + "'");
+      }
+    }
+    else if (! arg.compare("-Mc")) { 
+      if (GLOBAL::mode == MODELING) {
+	GLOBAL::mirror_columns = 1;
+      }
+      else {
+	exit_on_msg(cerr, "unknown option `" + arg + "'");
+      }
+    }
+    else if (! arg.compare("-Cp")) { 
+      if (GLOBAL::mode == MODELING) {
+	if (++i < argc) {
+	  GLOBAL::svd_threads = atoi(argv[i]);
+	}
+	else {
+	  exit_on_msg(cerr, "error: no argument for option -Cp given!");
+	}
+      }
+      else {
+	exit_on_msg(cerr, "unknown option `" + arg + "'");
+      }
+    }
     else if (! arg.compare("-o")) { 
       if (GLOBAL::mode == MODELING) {
 	if (++i < argc) {
@@ -477,6 +523,119 @@ main(int argc, char* argv[], char* env[])
 	exit_on_msg(cerr, "unknown option `" + arg + "'");
       }
     }
+    else if (! arg.compare("-Sp")) { 
+      if (GLOBAL::mode == MODELING) {
+	if (++i < argc) {
+	  GLOBAL::preselect = atoi(argv[i]);
+	}
+	else {
+	  exit_on_msg(cerr, "error: no argument for option -Sp given!");
+	}
+      }
+      else {
+	exit_on_msg(cerr, "unknown option `" + arg + "'");
+      }
+    }
+    else if (! arg.compare("-Sr")) { 
+      if (GLOBAL::mode == MODELING) {
+	if (++i < argc) {
+	  GLOBAL::race_budget = atoi(argv[i]);
+	}
+	else {
+	  exit_on_msg(cerr, "error: no argument for option -Sr given!");
+	}
+      }
+      else {
+	exit_on_msg(cerr, "unknown option `" + arg + "'");
+      }
+    }
+    else if (! arg.compare("--resume")) { 
+      if (GLOBAL::mode == MODELING) {
+	GLOBAL::resume = 1;
+      }
+      else {
+	exit_on_msg(cerr, "unknown option `" + arg + "'");
+      }
+    }
+    else if (! arg.compare("--pipeline")) { 
+      if (GLOBAL::mode == MODELING) {
+	if (++i < argc) {
+	  GLOBAL::pipeline_data = argv[i];
+	}
+	else {
+	  exit_on_msg(cerr, "error: no argument for option --pipeline given!");
+	}
+      }
+      else {
+	exit_on_msg(cerr, "unknown option `" + arg + "'");
+      }
+    }
+    else if (! arg.compare("--pipeline-files")) { 
+      if (GLOBAL::mode == MODELING) {
+	GLOBAL::pipeline_files = 1;
+      }
+      else {
+	exit_on_msg(cerr, "unknown option `" + arg + "'");
+      }
+    }
+    else if (! arg.compare("--pipeline-no-original")) { 
+      if (GLOBAL::mode == MODELING) {
+	GLOBAL::pipeline_original = 0;
+      }
+      else {
+	exit_on_msg(cerr, "unknown option `" + arg + "'");
+      }
+    }
+    else if (! arg.compare("--serve")) { 
+      if (GLOBAL::mode == ESTIMATION) {
+	GLOBAL::serve = 1;
+	if ((i + 1 < argc) && (argv[i + 1][0] != '-')) {
+	  GLOBAL::serve_socket = argv[++i];
+	}
+      }
+      else {
+	exit_on_msg(cerr, "unknown option `" + arg + "'");
+      }
+    }
+    else if (! arg.compare("--configs")) { 
+      if (GLOBAL::mode == MAKE_DATA) {
+	if (++i < argc) {
+	  GLOBAL::make_data_configs = argv[i];
+	}
+	else {
+	  exit_on_msg(cerr, "error: no argument for option --configs given!");
+	}
+      }
+      else {
+	exit_on_msg(cerr, "unknown option `" + arg + "'");
+      }
+    }
+    else if (! arg.compare("-j")) { 
+      if ((GLOBAL::mode == MODELING) || (GLOBAL::mode == MAKE_DATA)) {
+	if (++i < argc) {
+	  GLOBAL::n_threads = atoi(argv[i]);
+	}
+	else {
+	  exit_on_msg(cerr, "error: no argument for option -j given!");
+	}
+      }
+      else {
+	exit_on_msg(cerr, "unknown option `" + arg + "'");
+      }
+    }
+    else if (! arg.compare("-J")) { 
+      if (GLOBAL::mode == MODELING) {
+	if (++i < argc) {
+	  GLOBAL::n_gradient_threads = atoi(argv[i]);
+	}
+	else {
+	  exit_on_msg(cerr, "error: no argument for option -J given!");
+	}
+      }
+      else {
+	exit_on_msg(cerr, "unknown option `" + arg + "'");
+      }
+    }
     else if (! arg.compare("-d")) { 
       if (GLOBAL::mode == SIMULATION) {
 	if (++i < argc) {
@@ -486,7 +645,7 @@ main(int argc, char* argv[], char* env[])
 	  exit_on_msg(cerr, "error: no argument for option -d given!");
 	}
       }
-      else if (GLOBAL::mode == MAKE_DATA) {
+      else if ((GLOBAL::mode == MAKE_DATA) || (GLOBAL::mode == MODELING)) {
 	while ( (++i < argc) && (argv[i][0] != '-') ) {
 	  GLOBAL::dynamic_orders.push_back(atoi(argv[i]));
 	}
@@ -527,6 +686,28 @@ main(int argc, char* argv[], char* env[])
 	exit_on_msg(cerr, "unknown option `" + arg + "'");
       }
     }
+    else if (! arg.compare("-Tp")) { 
+      if ((GLOBAL::mode == ESTIMATION) || (GLOBAL::mode == SIMULATION)) {
+	GLOBAL::tree_premises = 1;
+      }
+      else {
+	exit_on_msg(cerr, "unknown option `" + arg + "'");
+      }
+    }
+    else if (! arg.compare("-M")) { 
+      if ((GLOBAL::mode == ESTIMATION) || (GLOBAL::mode == SIMULATION)
+	  || (GLOBAL::mode == NORMALIZE)) {
+	if (++i < argc) {
+	  GLOBAL::stream_rows = atoi(argv[i]);
+	}
+	else {
+	  exit_on_msg(cerr, "error: no argument for option -M given!");
+	}
+      }
+      else {
+	exit_on_msg(cerr, "unknown option `" + arg + "'");
+      }
+    }
     else if (! arg.compare("-N")) { 
       if (GLOBAL::mode == PRINT_SETS) {
 	GLOBAL::global_fset_value = 1;
@@ -536,7 +717,7 @@ main(int argc, char* argv[], char* env[])
       }
     }
     else if (! arg.compare("-Np")) { 
-      if (GLOBAL::mode == MAKE_DATA) {
+      if ((GLOBAL::mode == MAKE_DATA) || (GLOBAL::mode == MODELING)) {
 	if (++i < argc) {
 	  GLOBAL::n_training_data = atoi(argv[i]);
 	}
@@ -549,7 +730,7 @@ main(int argc, char* argv[], char* env[])
       }
     }
     else if (! arg.compare("-Ns")) { 
-      if (GLOBAL::mode == MAKE_DATA) {
+      if ((GLOBAL::mode == MAKE_DATA) || (GLOBAL::mode == MODELING)) {
 	if (++i < argc) {
 	  GLOBAL::n_skip_data = atoi(argv[i]);
 	}
@@ -562,7 +743,7 @@ main(int argc, char* argv[], char* env[])
       }
     }
     else if (! arg.compare("-sr")) { 
-      if (GLOBAL::mode == NORMALIZE) {
+      if ((GLOBAL::mode == NORMALIZE) || (GLOBAL::mode == MODELING)) {
 	GLOBAL::scale_by_range = 1;
 	GLOBAL::scale_by_standard_deviation = 0;
       }
@@ -571,7 +752,7 @@ main(int argc, char* argv[], char* env[])
       }
     }
     else if (! arg.compare("-sd")) { 
-      if (GLOBAL::mode == NORMALIZE) {
+      if ((GLOBAL::mode == NORMALIZE) || (GLOBAL::mode == MODELING)) {
 	if (++i < argc) {
 	  GLOBAL::scale_by_range = 0;
 	  GLOBAL::scale_by_standard_deviation = 1;
@@ -586,7 +767,7 @@ main(int argc, char* argv[], char* env[])
       }
     }
     else if (! arg.compare("-u")) { 
-      if (GLOBAL::mode == NORMALIZE) {
+      if ((GLOBAL::mode == NORMALIZE) || (GLOBAL::mode == MODELING)) {
 	if (++i < argc) {
 	  GLOBAL::scale_only_used_data = atoi(argv[i]);
 	}
@@ -598,8 +779,33 @@ main(int argc, char* argv[], char* env[])
 	exit_on_msg(cerr, "unknown option `" + arg + "'");
       }
     }
+    else if (! arg.compare("-b")) { 
+      if ((GLOBAL::mode == MAKE_DATA) || (GLOBAL::mode == NORMALIZE)) {
+	GLOBAL::binary_data = 1;
+      }
+      else {
+	exit_on_msg(cerr, "unknown option `" + arg + "'");
+      }
+    }
+    else if (! arg.compare("-Lt")) { 
+      if ((GLOBAL::mode == MODELING) 
+	  || (GLOBAL::mode == ESTIMATION)
+	  || (GLOBAL::mode == SIMULATION)
+	  || (GLOBAL::mode == MAKE_DATA)
+	  || (GLOBAL::mode == NORMALIZE)) {
+	if (++i < argc) {
+	  GLOBAL::n_parse_threads = atoi(argv[i]);
+	}
+	else {
+	  exit_on_msg(cerr, "error: no argument for option -Lt given!");
+	}
+      }
+      else {
+	exit_on_msg(cerr, "unknown option `" + arg + "'");
+      }
+    }
     else if (! arg.compare("-rt")) { 
-      if (GLOBAL::mode == MAKE_DATA) {
+      if ((GLOBAL::mode == MAKE_DATA) || (GLOBAL::mode == MODELING)) {
 	GLOBAL::ut_regressor = 1;
       }
       else {
@@ -656,6 +862,62 @@ main(int argc, char* argv[], char* env[])
     if ( !(GLOBAL::norm < 4)) {
       exit_on_msg(cerr, "error: argument at `-L' must be < 4!");
     }
+    if ( !(GLOBAL::preselect >= 0)) {
+      exit_on_msg(cerr, "error: argument at `-Sp' must be >= 0!");
+    }
+    if (GLOBAL::resume && (infilename3 != NULL)) {
+      exit_on_msg(cerr, "error: options `-f3' and `--resume' exclude each other!");
+    }
+    if ( !(GLOBAL::race_budget >= 0)) {
+      exit_on_msg(cerr, "error: argument at `-Sr' must be >= 0!");
+    }
+    if (GLOBAL::consequence_update && (GLOBAL::preselect == 0)) {
+      exit_on_msg(cerr, "error: option `-Cu' requires option `-Sp'!");
+    }
+    if (GLOBAL::consequence_update && GLOBAL::consequence_local) {
+      exit_on_msg(cerr, "error: options `-Cu' and `-Cl' exclude each other!");
+    }
+    if (GLOBAL::consequence_update && GLOBAL::consequence_streaming) {
+      exit_on_msg(cerr, "error: options `-Cu' and `-Cs' exclude each other!");
+    }
+    if (GLOBAL::consequence_local && GLOBAL::consequence_streaming) {
+      exit_on_msg(cerr, "error: options `-Cl' and `-Cs' exclude each other!");
+    }
+    if ( !(GLOBAL::svd_threads >= 0)) {
+      exit_on_msg(cerr, "error: argument at `-Cp' must be >= 0!");
+    }
+    if ( !(GLOBAL::n_threads > 0)) {
+      exit_on_msg(cerr, "error: argument at `-j' must be > 0!");
+    }
+    if ( !(GLOBAL::n_gradient_threads > 0)) {
+      exit_on_msg(cerr, "error: argument at `-J' must be > 0!");
+    }
+    if (GLOBAL::pipeline_data != NULL) {
+      if (GLOBAL::dynamic_orders.empty()) {
+	exit_on_msg(cerr, "error: no data dynamics given (with -d option)!");
+      }
+      vector<int>::const_iterator p = GLOBAL::dynamic_orders.begin();
+      while (p != GLOBAL::dynamic_orders.end()) {
+	if (*p < 0) {
+	  exit_on_msg(cerr, "error: dynamic < 1 at -d option");
+	}
+	++p;
+      }
+      if (GLOBAL::n_training_data < 0) {
+	exit_on_msg(cerr, "error: no. of training patterns < 0!");
+      }
+      if (GLOBAL::n_skip_data < 0) {
+	exit_on_msg(cerr, "error: no. of patterns to skip < 0!");
+      }
+    }
+    else if ( ! GLOBAL::dynamic_orders.empty() || GLOBAL::pipeline_files) {
+      exit_on_msg(cerr, "error: options `-d' and `--pipeline-files' need"
+		  " `--pipeline'!");
+    }
+    if ( ! GLOBAL::pipeline_original && ! GLOBAL::pipeline_files) {
+      exit_on_msg(cerr, "error: option `--pipeline-no-original' needs"
+		  " `--pipeline-files'!");
+    }
   }
   else if (GLOBAL::mode == PRINT_SETS) {
     if (infilename1 == NULL) {
@@ -672,9 +934,16 @@ main(int argc, char* argv[], char* env[])
     if (infilename1 == NULL) {
       exit_on_msg(cerr, "error: no inputfile1 (fuzzy model) given!");
     }
-    if (infilename2 == NULL) {
+    if ((infilename2 == NULL) && ! GLOBAL::serve) {
       exit_on_msg(cerr, "error: no inputfile2 (data file) given!");
     }
+    if ((infilename2 == NULL) && GLOBAL::serve && GLOBAL::denormalize) {
+      exit_on_msg(cerr, "error: option `-n' with `--serve' needs"
+		  " inputfile2 (data file)!");
+    }
+    if ( !(GLOBAL::stream_rows >= 0)) {
+      exit_on_msg(cerr, "error: argument at `-M' must be >= 0!");
+    }
   }
   else if (GLOBAL::mode == SIMULATION) {
     if (infilename1 == NULL) {
@@ -686,6 +955,9 @@ main(int argc, char* argv[], char* env[])
     if ( !(GLOBAL::order > 0)) {
       exit_on_msg(cerr, "error: argument at `-o' must be > 0!");
     }
+    if ( !(GLOBAL::stream_rows >= 0)) {
+      exit_on_msg(cerr, "error: argument at `-M' must be >= 0!");
+    }
   }
   else if (GLOBAL::mode == MAKE_DATA) {
     if (infilename1 == NULL) {
@@ -694,17 +966,25 @@ main(int argc, char* argv[], char* env[])
     if (infilename2 == NULL) {
       exit_on_msg(cerr, "error: no inputfile2 (input data file) given!");
     }
-    if (infilename3 == NULL) {
+    if ((infilename3 == NULL) && (GLOBAL::make_data_configs == NULL)) {
       exit_on_msg(cerr, "error: no inputfile3 (output file) given!");
     }
+    if ((infilename3 != NULL) && (GLOBAL::make_data_configs != NULL)) {
+      exit_on_msg(cerr, "error: options `-f3' and `--configs' exclude each"
+		  " other!");
+    }
     if (GLOBAL::n_training_data < 0) {
       exit_on_msg(cerr, "error: no. of training patterns < 0!");
     }
     if (GLOBAL::n_skip_data < 0) {
       exit_on_msg(cerr, "error: no. of patterns to skip < 0!");
     }
+    if ( !(GLOBAL::n_threads > 0)) {
+      exit_on_msg(cerr, "error: argument at `-j' must be > 0!");
+    }
     vector<int>::const_iterator p = GLOBAL::dynamic_orders.begin();
-    if (p == GLOBAL::dynamic_orders.end()) {
+    if ((p == GLOBAL::dynamic_orders.end()) 
+	&& (GLOBAL::make_data_configs == NULL)) {
       exit_on_msg(cerr, "error: no data dynamics given (with -d option)!");
     }
     while (p != GLOBAL::dynamic_orders.end()) {
@@ -721,6 +1001,9 @@ main(int argc, char* argv[], char* env[])
     if (infilename2 == NULL) {
       exit_on_msg(cerr, "error: no inputfile2 (output file) given!");
     }
+    if ( !(GLOBAL::stream_rows >= 0)) {
+      exit_on_msg(cerr, "error: argument at `-M' must be >= 0!");
+    }
   }
   else {
     assert(1==0);
@@ -734,6 +1017,9 @@ main(int argc, char* argv[], char* env[])
       exit_on_msg(cerr, "error: mu, nu, or lambda <= 0 at -Dph option!");
     }
   }
+  if ( !(GLOBAL::n_parse_threads > 0)) {
+    exit_on_msg(cerr, "error: argument at `-Lt' must be > 0!");
+  }
 
   // /// ok, do the job
 
@@ -780,7 +1066,13 @@ main(int argc, char* argv[], char* env[])
 
 	tracemsg(10, "in main(): open log file", GLOBAL::logfilename.c_str());
     //GLOBAL::logfile.close();
-    GLOBAL::logfile.open(GLOBAL::logfilename.c_str());
+    if (GLOBAL::resume) {
+      // /// continue the log of the interrupted run
+      GLOBAL::logfile.open(GLOBAL::logfilename.c_str(), ios::app);
+    }
+    else {
+      GLOBAL::logfile.open(GLOBAL::logfilename.c_str());
+    }
     if (!GLOBAL::logfile) {
       throw FileOpenError(GLOBAL::logfilename);
     }
@@ -788,7 +1080,13 @@ main(int argc, char* argv[], char* env[])
 
     if (GLOBAL::mode == MODELING) {
 	  tracemsg(10, "in main(): enter mode ", "MODELING");	
-      fzymodel(infilename1, infilename2);
+      if (GLOBAL::pipeline_data != NULL) {
+	fzypipeline(GLOBAL::pipeline_data, infilename1, infilename2, 
+		    infilename3);
+      }
+      else {
+	fzymodel(infilename1, infilename2, infilename3);
+      }
     }
     else if (GLOBAL::mode == PRINT_SETS) {
       fzy2sets(infilename1, infilename2);
@@ -801,7 +1099,12 @@ main(int argc, char* argv[], char* env[])
       fzyestim(infilename1, infilename2); 
     }
     else if (GLOBAL::mode == MAKE_DATA) {
-      fzymkdat(infilename1, infilename2, infilename3);
+      if (GLOBAL::make_data_configs != NULL) {
+	fzymkdat_configs(infilename1, infilename2, GLOBAL::make_data_configs);
+      }
+      else {
+	fzymkdat(infilename1, infilename2, infilename3);
+      }
     }
     else if (GLOBAL::mode == NORMALIZE) {
       fzynorml(infilename1, infilename2);
@@ -867,6 +1170,19 @@ exit_with_help(std::ostream& s) {
       << "      -f1 <learn_data>       input file of learning patterns\n"
       << "      -f2 <validation_data>  input file of validation patterns\n\n"
       << "OPTIONS\n"
+      << "      -f3 <fuzzy_model>      grow a fuzzy model instead of the "
+      << "one-rule model\n"
+      << "      --resume               resume the search from its checkpoint\n"
+      << "      --pipeline <norm_data> -d <d1 d2 ... dn>\n"
+      << "                             -f1, -f2 are raw data: normalize by"
+      << " <norm_data>\n"
+      << "                             (as fzynorml, with -sr -sd -u), make"
+      << " the data\n"
+      << "                             (as fzymkdat, with -Np -Ns -rt) in"
+      << " memory\n"
+      << "      --pipeline-files       also write the pipeline's .nor .nrm"
+      << " .ogl files\n"
+      << "      --pipeline-no-original but no .ogl files (as fzymkdat -o)\n"
       << "      -c <cons_dim>          consequence dimension; default: "
       << GLOBAL::consequence_dimension << endl
       << "      -r <min_n_rules>       minimal number of rules; default: "
@@ -886,6 +1202,14 @@ exit_with_help(std::ostream& s) {
       << " default: " << GLOBAL::update_premise << " (1 = update)\n"
       << "      -C                     optimize consequence parameters with"
       << " SVD; default: " << GLOBAL::consequence_optimize_SVD << endl
+      << "      -Cs                    least squares by streaming QR;"
+      << " default: " << GLOBAL::consequence_streaming << endl
+      << "      -Cl                    local weighted LS for each rule;"
+      << " default: " << GLOBAL::consequence_local << endl
+      << "      -Cu                    preselection by CGLS on parent's QR;"
+      << " default: " << GLOBAL::consequence_update << endl
+      << "      -Cp <threads>          blocked QR before SVD; default: "
+      << GLOBAL::svd_threads << " (plain SVD)\n"
       << "      -o  <min_opt_iterat>   min optimization iterations; default: "
       << GLOBAL::min_opt_iterations << endl
       << "      -O  <max_opt_iterat>   max optimization iterations; default: "
@@ -894,6 +1218,18 @@ exit_with_help(std::ostream& s) {
       << GLOBAL::steps_per_validation << endl
       << "      -S  <shortcuts>        shortcuts when modeling; default: "
       << GLOBAL::shortcut << " (no shortcuts)\n"
+      << "      -Sp <candidates>       candidates trained per epoch; default: "
+      << GLOBAL::preselect << " (all)\n"
+      << "      -Sr <iterations>       race candidates, first budget; default: "
+      << GLOBAL::race_budget << " (no race)\n"
+      << "      -j  <threads>          threads training candidates; default: "
+      << GLOBAL::n_threads << endl
+      << "      -J  <threads>          threads computing gradients; default: "
+      << GLOBAL::n_gradient_threads << endl
+      << "      -Mc                    column mirror of the data for the block"
+      << "\n"
+      << "                             kernels; default: " 
+      << GLOBAL::mirror_columns << endl
       << "      -Fs <min_sigma>        minimal steepness of fuzzy sets;"
       << " default: " << GLOBAL::min_sigma << endl
       << "      -FS <max_sigma>        maximal steepness of fuzzy sets;"
@@ -910,6 +1246,8 @@ exit_with_help(std::ostream& s) {
       << GLOBAL::denormalize << "\n"
       << "      -t  <trace_level>      trace level (for SW tests); default: "
       << GLOBAL::tracelevel << endl
+      << "      -Lt <threads>          threads parsing text data files;"
+      << " default: " << GLOBAL::n_parse_threads << endl
       << "      -v  <verbose_level>    verbose level (for modelling); default: "
       << GLOBAL::verbose << endl
       << "      -e  <name_extension>   filename extension; default: `"
@@ -928,10 +1266,21 @@ exit_with_help(std::ostream& s) {
 #endif
       << "SYNOPSIS\n"
       << "      " << GLOBAL::prgname 
-      << " -f1 <fuzzy_model> -f2 <data> [OPTIONS]\n\n"
+      << " -f1 <fuzzy_model> -f2 <data> [OPTIONS]\n"
+      << "      " << GLOBAL::prgname 
+      << " -f1 <fuzzy_model> [-f2 <data>] --serve [<socket>] [OPTIONS]\n\n"
       << "PARAMETERS\n"
       << "      -f1 <fuzzy_model>      input file of fuzzy model\n"
-      << "      -f2 <data>             input file of data to estimate\n\n"
+      << "      -f2 <data>             input file of data to estimate\n"
+      << "      --serve [<socket>]     answer each line of inputs from stdin"
+      << " (or from the\n"
+      << "                             clients of the Unix domain socket)"
+      << " with y_hat;\n"
+      << "                             the scale of -n is the one of <data>;"
+      << " reports the\n"
+      << "                             latencies on stderr at the end of"
+      << " stdin, or at\n"
+      << "                             SIGINT/SIGTERM (not on Windows)\n\n"
       << "OPTIONS\n"
       << "      -Dph <mu> <inc> <dec> <l> Page-Hinkley Detector on error with"
       << " mean mu,\n"
@@ -945,6 +1294,14 @@ exit_with_help(std::ostream& s) {
       << GLOBAL::filename_extension << "'\n"
       << "      -E <error_offset>      offset when printing RMS; default: `"
       << GLOBAL::error_offset << "'\n"
+      << "      -Tp                    evaluate premises along the refinement"
+      << " tree; default: " << GLOBAL::tree_premises << "\n"
+      << "      -M <rows>              stream the data in chunks of <rows>"
+      << " rows (0: load\n"
+      << "                             all at once); default: "
+      << GLOBAL::stream_rows << "\n"
+      << "      -Lt <threads>          threads parsing text data files;"
+      << " default: " << GLOBAL::n_parse_threads << "\n"
       << "      -q                     quiet; no output on stdout and stderr\n"
       << "      -h                     print this help and exit\n\n";
   }
@@ -977,6 +1334,14 @@ exit_with_help(std::ostream& s) {
       << GLOBAL::filename_extension << "'\n"
       << "      -E <error_offset>      offset when printing RMS; default: `"
       << GLOBAL::error_offset << "'\n"
+      << "      -Tp                    evaluate premises along the refinement"
+      << " tree; default: " << GLOBAL::tree_premises << "\n"
+      << "      -M <rows>              stream the data in chunks of <rows>"
+      << " rows (0: load\n"
+      << "                             all at once); default: "
+      << GLOBAL::stream_rows << "\n"
+      << "      -Lt <threads>          threads parsing text data files;"
+      << " default: " << GLOBAL::n_parse_threads << "\n"
       << "      -q                     quiet; no output on stdout and stderr\n"
       << "      -h                     print this help and exit\n\n";
   }
@@ -1020,14 +1385,21 @@ exit_with_help(std::ostream& s) {
       << "SYNOPSIS\n"
       << "      " << GLOBAL::prgname 
       << " -f1 <norm_file> -f2 <input_data> -f3 <output_data>"
-      << " -d <d1 d2 ... dn> [OPTIONS]\n\n"
+      << " -d <d1 d2 ... dn> [OPTIONS]\n"
+      << "      " << GLOBAL::prgname 
+      << " -f1 <norm_file> -f2 <input_data> --configs <config_file>"
+      << " [OPTIONS]\n\n"
       << "PARAMETERS\n"
       << "      -f1 <norm_file>        filename of normalization specification"
       << "\n"
       << "      -f2 <input_data>       filename of input (source) data\n"
       << "      -f3 <output_data>      filename for output\n"
       << "      -d  <int_vector>       data dynamics specification (for "
-      << " x1, x2,...,y)\n\n"
+      << " x1, x2,...,y)\n"
+      << "      --configs <config_file> one data set per line:"
+      << " <output_data> [-d <d1 ...\n"
+      << "                             dn>] [-Np <n>] [-Ns <n>] [-rt];"
+      << " default: the options\n\n"
       << "OPTIONS\n"
       << "      -Np <n_patterns>       no. of training patterns to make"
       << " (0 = all); default: "
@@ -1039,6 +1411,12 @@ exit_with_help(std::ostream& s) {
       << " default: " << GLOBAL::ut_regressor << "\n"
       << "      -o                     do not print original data; default: "
       << GLOBAL::denormalize << "\n"
+      << "      -b                     write binary <output_data>.nrm;"
+      << " default: " << GLOBAL::binary_data << "\n"
+      << "      -j  <threads>          threads writing the --configs data"
+      << " sets; default: " << GLOBAL::n_threads << "\n"
+      << "      -Lt <threads>          threads parsing text data files;"
+      << " default: " << GLOBAL::n_parse_threads << "\n"
       << "      -v <verbose_level>     verbose level; default: "
       << GLOBAL::verbose << endl
       << "      -e <name_extension>    filename extension; default: `"
@@ -1063,6 +1441,16 @@ exit_with_help(std::ostream& s) {
       << " default: " << GLOBAL::sigma_factor << "\n"
       << "      -u  <n_pattern>        use only n patterns (0 = all);"
       << " default: " << GLOBAL::scale_only_used_data << "\n"
+      << "      -b                     write binary <norm_file>;"
+      << " default: " << GLOBAL::binary_data << "\n"
+      << "      -M <rows>              read the data in chunks of <rows>"
+      << " rows, in one pass\n"
+      << "                             (0: load all at once); default: "
+      << GLOBAL::stream_rows << "\n"
+      << "      -Lt <threads>          threads parsing text data files"
+      << " (with -M: threads\n"
+      << "                             of the statistics); default: " 
+      << GLOBAL::n_parse_threads << "\n"
       << "      -v <verbose_level>     verbose level; default: "
       << GLOBAL::verbose << endl
       << "      -e <name_extension>    filename extension; default: `"
@@ -1126,6 +1514,7 @@ print_options(ofstream& strm, int argc, char* argv[], char* env[]) {
 #else
   msg += (string)"  shape of membership funtions: sigmoidal\n";
 #endif
+  msg += (string)"  membership kernel: " + membership_kernel() + "\n";
   msg += (string)"  basic outfile name: \"" + GLOBAL::basefilename + "\"\n";
   msg += (string)"  name extension: \"" + GLOBAL::filename_extension + "\"\n";
   msg += (string)"  logfilename: " + GLOBAL::logfilename + "\n";
@@ -1135,6 +1524,8 @@ print_options(ofstream& strm, int argc, char* argv[], char* env[]) {
     msg += (string)"  tracefilename: " + GLOBAL::tracefilename + "\n";
   }
   msg += (string)"  take back normalization: "+itos(GLOBAL::denormalize)+"\n";
+  msg += (string)"  threads for parsing data files: " 
+    + itos(GLOBAL::n_parse_threads) + "\n";
   tracemsg(100, "print_options() of main.cc: printing OK for loop", "general program info");
   if (GLOBAL::mode == MODELING) {
     msg += (string)"  mode: MODELING\n";
@@ -1179,6 +1570,45 @@ print_options(ofstream& strm, int argc, char* argv[], char* env[]) {
       + itos(GLOBAL::norm) + "\n";
     msg += (string)"  shortcut: " 
       + itos(GLOBAL::shortcut) +"\n";
+    msg += (string)"  preselected candidates: " 
+      + itos(GLOBAL::preselect) +"\n";
+    msg += (string)"  candidate race budget: " 
+      + itos(GLOBAL::race_budget) +"\n";
+    msg += (string)"  threads for candidate training: " 
+      + itos(GLOBAL::n_threads) +"\n";
+    msg += (string)"  threads for gradient computation: " 
+      + itos(GLOBAL::n_gradient_threads) +"\n";
+    msg += (string)"  column mirror of the data: " 
+      + itos(GLOBAL::mirror_columns) +"\n";
+    msg += (string)"  resume from checkpoint: " 
+      + itos(GLOBAL::resume) +"\n";
+    if (GLOBAL::pipeline_data != NULL) {
+      msg += (string)"  pipeline normalization data: " 
+	+ GLOBAL::pipeline_data + "\n";
+      msg += (string)"  pipeline intermediate files: " 
+	+ itos(GLOBAL::pipeline_files) + "\n";
+      msg += (string)"  pipeline original data files: " 
+	+ itos(GLOBAL::pipeline_files && GLOBAL::pipeline_original) + "\n";
+      msg += (string)"  pipeline dynamic orders:";
+      for (vector<int>::iterator porder = GLOBAL::dynamic_orders.begin();
+	   porder != GLOBAL::dynamic_orders.end();
+	   ++porder) {
+	msg += (string)" " + itos(*porder);
+      }
+      msg += (string)"\n";
+      msg += (string)"  pipeline regressor starts with u(t): " 
+	+ itos(GLOBAL::ut_regressor) + "\n";
+      msg += (string)"  pipeline patterns (learning/skipped): "
+	+ itos(GLOBAL::n_training_data) + " " + itos(GLOBAL::n_skip_data) 
+	+ "\n";
+      msg += (string)"  pipeline scale by standard deviation/range: "
+	+ itos(GLOBAL::scale_by_standard_deviation) + " " 
+	+ itos(GLOBAL::scale_by_range) + "\n";
+      msg += (string)"  pipeline sigma factor: "
+	+ dtos(GLOBAL::sigma_factor) + "\n";
+      msg += (string)"  pipeline scale only used data: "
+	+ itos(GLOBAL::scale_only_used_data) + "\n";
+    }
     msg += (string)"  max number of fuzzy rules: " 
       + itos(GLOBAL::max_n_rules) + "\n";
     msg += (string)"  min number of fuzzy rules: "
@@ -1195,6 +1625,14 @@ print_options(ofstream& strm, int argc, char* argv[], char* env[]) {
       + itos(GLOBAL::update_premise) + "\n";
     msg += (string)"  optimize consequence with SVD: "
       + itos(GLOBAL::consequence_optimize_SVD) + "\n";
+    msg += (string)"  streaming least squares for consequences: " 
+      + itos(GLOBAL::consequence_streaming) + "\n";
+    msg += (string)"  local weighted least squares for consequences: " 
+      + itos(GLOBAL::consequence_local) + "\n";
+    msg += (string)"  CGLS on parent's QR for preselection: " 
+      + itos(GLOBAL::consequence_update) + "\n";
+    msg += (string)"  threads of blocked QR before SVD: " 
+      + itos(GLOBAL::svd_threads) + "\n";
     msg += (string)"  minimal sigma: "
       + dtos(GLOBAL::min_sigma) + "\n";
     msg += (string)"  maximal sigma: "
@@ -1223,10 +1661,21 @@ print_options(ofstream& strm, int argc, char* argv[], char* env[]) {
     msg += (string)"  mode: SIMULATION\n";
     msg += (string)"  order (of y): " + itos(GLOBAL::order) + "\n";
     msg += (string)"  error offset: " + dtos(GLOBAL::error_offset) + "\n";
+    msg += (string)"  tree premise evaluation: " 
+      + itos(GLOBAL::tree_premises) + "\n";
+    msg += (string)"  stream rows: " + itos(GLOBAL::stream_rows) + "\n";
   }
   else if (GLOBAL::mode == ESTIMATION) {
     msg += (string)"  mode: ESTIMATION\n";
     msg += (string)"  error offset: " + dtos(GLOBAL::error_offset) + "\n";
+    msg += (string)"  tree premise evaluation: " 
+      + itos(GLOBAL::tree_premises) + "\n";
+    msg += (string)"  stream rows: " + itos(GLOBAL::stream_rows) + "\n";
+    if (GLOBAL::serve) {
+      msg += (string)"  serve on: " 
+	+ ((GLOBAL::serve_socket != NULL) ? GLOBAL::serve_socket : "stdin")
+	+ "\n";
+    }
   }
   else if (GLOBAL::mode == MAKE_DATA) {
     msg += (string)"  mode: MAKE_DATA\n";
@@ -1241,6 +1690,12 @@ print_options(ofstream& strm, int argc, char* argv[], char* env[]) {
       msg += (string)" " + itos(*porder);
     }
     msg += (string)"\n";
+    msg += (string)"  binary data: " + itos(GLOBAL::binary_data) + "\n";
+    if (GLOBAL::make_data_configs != NULL) {
+      msg += (string)"  configurations: " + GLOBAL::make_data_configs + "\n";
+      msg += (string)"  threads for configurations: " 
+	+ itos(GLOBAL::n_threads) + "\n";
+    }
   }
   else if (GLOBAL::mode == NORMALIZE) {
     msg += (string)"  mode: NORMALIZE\n";
@@ -1252,6 +1707,8 @@ print_options(ofstream& strm, int argc, char* argv[], char* env[]) {
       + itos(GLOBAL::scale_by_range) + "\n";
     msg += (string)"  sigma factor: "
       + dtos(GLOBAL::sigma_factor) + "\n";
+    msg += (string)"  binary data: " + itos(GLOBAL::binary_data) + "\n";
+    msg += (string)"  stream rows: " + itos(GLOBAL::stream_rows) + "\n";
   }
   else {
 	tracemsg(200, "print_options() of main.cc: start printing for mode", "UNDEFINED");
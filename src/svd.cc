@@ -367,3 +367,699 @@ SVD(const Matrix<Real>& A, Matrix<Real>& Q, Matrix<Real>& U, Matrix<Real>& V)
   
   return;
 }
+
+// //////////////////////////////////////////////////////////////////////
+
+void 
+StreamingLeastSquares::add_row(const Real* a, Real y) {
+  Real* x = &a_[0];
+  for (int j = 0; j < n_; ++j) {
+    x[j] = a[j];
+  }
+  // /// rotate x into R, row by row of R
+  for (int k = 0; k < n_; ++k) {
+    if (x[k] == 0.0) {
+      continue;
+    }
+    Real* r = R_[k];
+    // /// h = sqrt(r[k]^2 + x[k]^2) without underflow of the squares
+    Real h;
+    if (fabs(r[k]) > fabs(x[k])) {
+      Real t = x[k] / r[k];
+      h = fabs(r[k]) * sqrt(1.0 + (t * t));
+    }
+    else {
+      Real t = r[k] / x[k];
+      h = fabs(x[k]) * sqrt(1.0 + (t * t));
+    }
+    Real c = r[k] / h;
+    Real s = x[k] / h;
+    r[k] = h;
+    for (int j = k + 1; j < n_; ++j) {
+      Real t = r[j];
+      r[j] = (c * t) + (s * x[j]);
+      x[j] = (-s * t) + (c * x[j]);
+    }
+    Real t = z_[k];
+    z_[k] = (c * t) + (s * y);
+    y = (-s * t) + (c * y);
+  }
+  ++m_;
+  return;
+}
+
+// //////////////////////////////////////////////////////////////////////
+
+void 
+StreamingLeastSquares::solve(Vector<Real>& p) const throw (SVDError) {
+  if (m_ < (size_t)n_) {
+    throw SVDError();
+  }
+  Matrix<Real> Q;
+  Matrix<Real> U;
+  Matrix<Real> V;
+  SVD(R_, Q, U, V);
+  // /// calculate inverse of Q
+  for (int i = 1; i <= n_; ++i) {
+    if (Q(i, i) != 0.0) {
+      Q(i, i) = 1.0 / Q(i, i);
+    }
+  }
+  // /// p is LMS solution of z = R * p, i.e. of y = A * p
+  p = V * (Q * (transpose(U) * z_)); 
+  return;
+}
+
+// //////////////////////////////////////////////////////////////////////
+
+/// apply the Householder reflection (I - tau v v^T) with v = (1, v[1..]) 
+/// to the column c (both of length n); v[0] is not read
+static inline void 
+reflect(const Real* v, Real tau, Real* c, int n) {
+  double s = c[0];
+  for (int i = 1; i < n; ++i) {
+    s += (double)v[i] * c[i];
+  }
+  Real f = (Real)(tau * s);
+  c[0] -= f;
+  for (int i = 1; i < n; ++i) {
+    c[i] -= f * v[i];
+  }
+}
+
+// //////////////////////////////////////////////////////////////////////
+
+/// number of columns of a panel of householder()
+static const int householder_panel = 16;
+
+/// the compact WY form H_p0 * ... * H_(p1-1) = I - V * T * V.transp() of
+/// the reflections p0, ..., p1 - 1 of householder(): V holds their 
+/// vectors (columns p0, ..., p1 - 1 of W), T is upper triangular, 
+/// (p1 - p0) x (p1 - p0), row by row
+static void 
+wy_factor(const vector<Real>& W, const vector<Real>& tau, int m, 
+	  int p0, int p1, vector<double>& T) {
+  int nb = p1 - p0;
+  T.assign((size_t)nb * nb, 0.0);
+  for (int i = 0; i < nb; ++i) {
+    int ri = p0 + i;
+    const Real* vi = &W[(size_t)ri * m];
+    // /// T(0..i-1, i) = V(:, 0..i-1).transp() * v_i; v_i is 0 above
+    // /// row ri and 1 in it
+    for (int j = 0; j < i; ++j) {
+      const Real* vj = &W[(size_t)(p0 + j) * m];
+      double s = vj[ri];
+      for (int r = ri + 1; r < m; ++r) {
+	s += (double)vj[r] * vi[r];
+      }
+      T[(size_t)j * nb + i] = s;
+    }
+    // /// T(0..i-1, i) = -tau_i * T(0..i-1, 0..i-1) * T(0..i-1, i)
+    for (int j = 0; j < i; ++j) {
+      double s = 0.0;
+      for (int l = j; l < i; ++l) {
+	s += T[(size_t)j * nb + l] * T[(size_t)l * nb + i];
+      }
+      T[(size_t)j * nb + i] = -tau[ri] * s;
+    }
+    T[(size_t)i * nb + i] = tau[ri];
+  }
+  return;
+}
+
+// //////////////////////////////////////////////////////////////////////
+
+/// C = (I - V * T * V.transp()) * C, or with T.transp() if transposed, 
+/// for the k_dim columns of the m x k_dim matrix C (column-major), V 
+/// and T of wy_factor(); rows p0, ..., m - 1 change.  The products are
+/// formed for blocks of columns by threads threads, over chunks of rows
+/// whose part of V stays in the cache
+static void 
+wy_apply(const vector<Real>& W, const vector<double>& T, int m, 
+	 int p0, int p1, bool transposed, Real* C, int k_dim, int threads) {
+  const int nb = p1 - p0;
+  /// columns of C per block and rows per chunk
+  const int block = 32;
+  const int chunk = 512;
+  int n_blocks = (k_dim + block - 1) / block;
+#pragma omp parallel for schedule(static) num_threads(threads)
+  for (int b = 0; b < n_blocks; ++b) {
+    int k0 = b * block;
+    int kb = (k0 + block < k_dim) ? block : k_dim - k0;
+    // /// Y = V.transp() * C
+    vector<double> Y((size_t)nb * kb, 0.0);
+    for (int r0 = p0; r0 < m; r0 += chunk) {
+      int r1 = (r0 + chunk < m) ? r0 + chunk : m;
+      for (int j = 0; (j < nb) && (p0 + j < r1); ++j) {
+	int rj = p0 + j;
+	const Real* v = &W[(size_t)rj * m];
+	int start = (r0 > rj) ? r0 : rj + 1;
+	for (int c = 0; c < kb; ++c) {
+	  const Real* x = C + (size_t)(k0 + c) * m;
+	  double s = (r0 <= rj) ? x[rj] : 0.0;
+	  for (int r = start; r < r1; ++r) {
+	    s += (double)v[r] * x[r];
+	  }
+	  Y[(size_t)j * kb + c] += s;
+	}
+      }
+    }
+    // /// Z = T * Y, or T.transp() * Y
+    vector<double> Z((size_t)nb * kb, 0.0);
+    for (int j = 0; j < nb; ++j) {
+      for (int l = 0; l < nb; ++l) {
+	double t = transposed ? T[(size_t)l * nb + j] : T[(size_t)j * nb + l];
+	if (t == 0.0) {
+	  continue;
+	}
+	for (int c = 0; c < kb; ++c) {
+	  Z[(size_t)j * kb + c] += t * Y[(size_t)l * kb + c];
+	}
+      }
+    }
+    // /// C = C - V * Z
+    for (int r0 = p0; r0 < m; r0 += chunk) {
+      int r1 = (r0 + chunk < m) ? r0 + chunk : m;
+      for (int c = 0; c < kb; ++c) {
+	Real* x = C + (size_t)(k0 + c) * m;
+	for (int j = 0; (j < nb) && (p0 + j < r1); ++j) {
+	  int rj = p0 + j;
+	  const Real* v = &W[(size_t)rj * m];
+	  Real z = (Real)Z[(size_t)j * kb + c];
+	  int start = (r0 > rj) ? r0 : rj + 1;
+	  if (r0 <= rj) {
+	    x[rj] -= z;
+	  }
+	  for (int r = start; r < r1; ++r) {
+	    x[r] -= z * v[r];
+	  }
+	}
+      }
+    }
+  }
+  return;
+}
+
+// //////////////////////////////////////////////////////////////////////
+
+/// Householder QR decomposition of the m x n matrix A (m >= n), a panel 
+/// of columns at a time: W is the column-major copy of A overwritten by
+/// R (upper part) and the Householder vectors (below the diagonal, 
+/// v[0] = 1 implicit); tau are the reflections' factors
+static void 
+householder(const Matrix<Real>& A, vector<Real>& W, vector<Real>& tau, 
+	    int threads) {
+  int m = A.num_rows();
+  int n = A.num_cols();
+  const int panel = householder_panel;
+  W.resize((size_t)m * n);
+  for (int i = 0; i < m; ++i) {
+    const Real* a = A[i];
+    for (int j = 0; j < n; ++j) {
+      W[(size_t)j * m + i] = a[j];
+    }
+  }
+  tau.assign(n, 0.0);
+  for (int p0 = 0; p0 < n; p0 += panel) {
+    int p1 = (p0 + panel < n) ? p0 + panel : n;
+    // /// factor the panel
+    for (int j = p0; j < p1; ++j) {
+      Real* x = &W[(size_t)j * m + j];
+      int len = m - j;
+      double sigma = 0.0;
+      for (int i = 1; i < len; ++i) {
+	sigma += (double)x[i] * x[i];
+      }
+      if (sigma == 0.0) {
+	tau[j] = 0.0;
+	continue;
+      }
+      double alpha = x[0];
+      double norm = sqrt(alpha * alpha + sigma);
+      double beta = (alpha <= 0.0) ? norm : -norm;
+      Real scale = (Real)(1.0 / (alpha - beta));
+      for (int i = 1; i < len; ++i) {
+	x[i] *= scale;
+      }
+      tau[j] = (Real)((beta - alpha) / beta);
+      x[0] = (Real)beta;
+      for (int k = j + 1; k < p1; ++k) {
+	reflect(x, tau[j], &W[(size_t)k * m + j], len);
+      }
+    }
+    // /// apply the panel's reflections H_(p1-1) * ... * H_p0 to the 
+    // /// remaining columns at once, in their compact WY form
+    if (p1 < n) {
+      vector<double> T;
+      wy_factor(W, tau, m, p0, p1, T);
+      wy_apply(W, T, m, p0, p1, true, &W[(size_t)p1 * m], n - p1, threads);
+    }
+  }
+  return;
+}
+
+// //////////////////////////////////////////////////////////////////////
+
+/// C = H_1 * ... * H_n * (X; 0) for the n x k matrix X, i.e. the m x k
+/// matrix C (column-major) of a factorization by householder()
+static void 
+apply_householder(const vector<Real>& W, const vector<Real>& tau, 
+		  int m, int n, const Matrix<Real>& X, vector<Real>& C,
+		  int threads) {
+  int k_dim = X.num_cols();
+  C.assign((size_t)m * k_dim, 0.0);
+  for (int k = 0; k < k_dim; ++k) {
+    Real* c = &C[(size_t)k * m];
+    for (int i = 0; i < n; ++i) {
+      c[i] = X[i][k];
+    }
+  }
+  // /// the panels of householder() from the last one, in their compact
+  // /// WY form
+  const int panel = householder_panel;
+  vector<double> T;
+  for (int p0 = ((n - 1) / panel) * panel; p0 >= 0; p0 -= panel) {
+    int p1 = (p0 + panel < n) ? p0 + panel : n;
+    wy_factor(W, tau, m, p0, p1, T);
+    wy_apply(W, T, m, p0, p1, false, &C[0], k_dim, threads);
+  }
+  return;
+}
+
+// //////////////////////////////////////////////////////////////////////
+
+void 
+SVD_QR(const Matrix<Real>& A, Matrix<Real>& Q, Matrix<Real>& U, 
+       Matrix<Real>& V, int threads)
+  throw (SVDError)
+{
+  int m = A.num_rows();
+  int n = A.num_cols();
+  if (m < n) {
+    throw SVDError();
+  }
+  vector<Real> W;
+  vector<Real> tau;
+  householder(A, W, tau, threads);
+  // /// SVD of R
+  Matrix<Real> R(n, n, (Real)0.0);
+  for (int j = 0; j < n; ++j) {
+    for (int i = 0; i <= j; ++i) {
+      R[i][j] = W[(size_t)j * m + i];
+    }
+  }
+  Matrix<Real> UR;
+  SVD(R, Q, UR, V);
+  // /// U = H_1 * ... * H_n * (UR; 0), column by column
+  vector<Real> C;
+  apply_householder(W, tau, m, n, UR, C, threads);
+  if (U.num_rows() != m || U.num_cols() != n) {
+    U.newsize(m, n);
+  }
+  for (int i = 0; i < m; ++i) {
+    Real* u = U[i];
+    for (int k = 0; k < n; ++k) {
+      u[k] = C[(size_t)k * m + i];
+    }
+  }
+  return;
+}
+
+// //////////////////////////////////////////////////////////////////////
+
+SplitLeastSquares::SplitLeastSquares(const Matrix<Real>& A, 
+				     const Vector<Real>& y, int threads)
+  throw (SVDError)
+  : m_(A.num_rows()), n_(A.num_cols()), y_(y.begin(), y.end()), 
+    full_rank_(true)
+{
+  if ((m_ < n_) || (y.dim() != m_)) {
+    throw SVDError();
+  }
+  vector<Real> W;
+  vector<Real> tau;
+  householder(A, W, tau, threads);
+  R_.assign((size_t)n_ * n_, 0.0);
+  double max_diagonal = 0.0;
+  for (int j = 0; j < n_; ++j) {
+    for (int i = 0; i <= j; ++i) {
+      R_[(size_t)i * n_ + j] = W[(size_t)j * m_ + i];
+    }
+    if (fabs(R_[(size_t)j * n_ + j]) > max_diagonal) {
+      max_diagonal = fabs(R_[(size_t)j * n_ + j]);
+    }
+  }
+  for (int j = 0; j < n_; ++j) {
+    if (fabs(R_[(size_t)j * n_ + j]) <= n_ * REAL_EPSILON * max_diagonal) {
+      full_rank_ = false;
+    }
+  }
+  // /// the thin Q = H_1 * ... * H_n * (I; 0), row by row
+  Matrix<Real> I(n_, n_, (Real)0.0);
+  for (int j = 0; j < n_; ++j) {
+    I[j][j] = 1.0;
+  }
+  vector<Real> C;
+  apply_householder(W, tau, m_, n_, I, C, threads);
+  Q_.resize((size_t)m_ * n_);
+  z_.assign(n_, 0.0);
+  for (int i = 0; i < m_; ++i) {
+    Real* q = &Q_[(size_t)i * n_];
+    for (int j = 0; j < n_; ++j) {
+      q[j] = C[(size_t)j * m_ + i];
+      z_[j] += (double)q[j] * y_[i];
+    }
+  }
+}
+
+// //////////////////////////////////////////////////////////////////////
+
+/// solve R * x = b for the upper triangular n x n matrix R (row-major)
+static void
+solve_upper(const vector<double>& R, int n, vector<double>& x, 
+	    const vector<double>& b) {
+  x.resize(n);
+  for (int i = n - 1; i >= 0; --i) {
+    double s = b[i];
+    const double* r = &R[(size_t)i * n];
+    for (int j = i + 1; j < n; ++j) {
+      s -= r[j] * x[j];
+    }
+    x[i] = s / r[i];
+  }
+}
+
+/// solve R.transp() * x = b for the upper triangular n x n matrix R
+static void
+solve_upper_transp(const vector<double>& R, int n, vector<double>& x, 
+		   const vector<double>& b) {
+  x.assign(b.begin(), b.end());
+  for (int i = 0; i < n; ++i) {
+    x[i] /= R[(size_t)i * n + i];
+    const double* r = &R[(size_t)i * n];
+    for (int j = i + 1; j < n; ++j) {
+      x[j] -= r[j] * x[i];
+    }
+  }
+}
+
+/// split coefficients p (columns of As) from coefficients q of the 
+/// parent's columns and the appended block (see solve_split())
+static void
+split_coefficients(const vector<double>& q, int parent_n, int first, int k,
+		   vector<double>& p) {
+  p.resize(parent_n + k);
+  for (int j = 0; j < first; ++j) {
+    p[j] = q[j];
+  }
+  for (int c = 0; c < k; ++c) {
+    p[first + c] = q[first + c] + q[parent_n + c];
+    p[first + k + c] = q[first + c];
+  }
+  for (int j = first + k; j < parent_n; ++j) {
+    p[j + k] = q[j];
+  }
+}
+
+/// transposed mapping of split_coefficients()
+static void
+split_coefficients_transp(const vector<double>& g, int parent_n, int first, 
+			  int k, vector<double>& h) {
+  h.resize(parent_n + k);
+  for (int j = 0; j < first; ++j) {
+    h[j] = g[j];
+  }
+  for (int c = 0; c < k; ++c) {
+    h[first + c] = g[first + c] + g[first + k + c];
+    h[parent_n + c] = g[first + c];
+  }
+  for (int j = first + k; j < parent_n; ++j) {
+    h[j] = g[j + k];
+  }
+}
+
+// //////////////////////////////////////////////////////////////////////
+
+bool 
+SplitLeastSquares::solve_split(const Matrix<Real>& As, int first, int k, 
+			       Vector<Real>& p) const {
+  const int n = n_ + k;
+  assert(As.num_rows() == m_);
+  assert(As.num_cols() == n);
+  assert((first >= 0) && (first + k <= n_));
+  if (! full_rank_) {
+    return false;
+  }
+  // /// H = Q.transp() * N and Z = N - Q * H for the block N of As at
+  // /// first (classical Gram-Schmidt, twice for orthogonality)
+  vector<double> H((size_t)n_ * k, 0.0);
+  vector<double> Z((size_t)m_ * k);
+  for (int i = 0; i < m_; ++i) {
+    for (int c = 0; c < k; ++c) {
+      Z[(size_t)i * k + c] = As[i][first + c];
+    }
+  }
+  vector<double> G((size_t)n_ * k);
+  for (int pass = 0; pass < 2; ++pass) {
+    G.assign((size_t)n_ * k, 0.0);
+    for (int i = 0; i < m_; ++i) {
+      const Real* q = &Q_[(size_t)i * n_];
+      const double* z = &Z[(size_t)i * k];
+      for (int j = 0; j < n_; ++j) {
+	double* g = &G[(size_t)j * k];
+	for (int c = 0; c < k; ++c) {
+	  g[c] += q[j] * z[c];
+	}
+      }
+    }
+    for (int i = 0; i < m_; ++i) {
+      const Real* q = &Q_[(size_t)i * n_];
+      double* z = &Z[(size_t)i * k];
+      for (int j = 0; j < n_; ++j) {
+	const double* g = &G[(size_t)j * k];
+	for (int c = 0; c < k; ++c) {
+	  z[c] -= q[j] * g[c];
+	}
+      }
+    }
+    for (size_t l = 0; l < H.size(); ++l) {
+      H[l] += G[l];
+    }
+  }
+  // /// R of the extended problem [A, N] = [Q, Q_Z] * R; Q_Z by modified
+  // /// Gram-Schmidt of Z
+  vector<double> R((size_t)n * n, 0.0);
+  double max_diagonal = 0.0;
+  for (int i = 0; i < n_; ++i) {
+    for (int j = i; j < n_; ++j) {
+      R[(size_t)i * n + j] = R_[(size_t)i * n_ + j];
+    }
+    for (int c = 0; c < k; ++c) {
+      R[(size_t)i * n + n_ + c] = H[(size_t)i * k + c];
+    }
+    if (fabs(R_[(size_t)i * n_ + i]) > max_diagonal) {
+      max_diagonal = fabs(R_[(size_t)i * n_ + i]);
+    }
+  }
+  vector<double> z(z_.begin(), z_.end());
+  z.resize(n, 0.0);
+  for (int c = 0; c < k; ++c) {
+    for (int c2 = 0; c2 < c; ++c2) {
+      double s = 0.0;
+      for (int i = 0; i < m_; ++i) {
+	s += Z[(size_t)i * k + c2] * Z[(size_t)i * k + c];
+      }
+      for (int i = 0; i < m_; ++i) {
+	Z[(size_t)i * k + c] -= s * Z[(size_t)i * k + c2];
+      }
+      R[(size_t)(n_ + c2) * n + n_ + c] = s;
+    }
+    double norm = 0.0;
+    for (int i = 0; i < m_; ++i) {
+      norm += Z[(size_t)i * k + c] * Z[(size_t)i * k + c];
+    }
+    norm = sqrt(norm);
+    if (norm <= n * REAL_EPSILON * max_diagonal) {
+      return false;
+    }
+    R[(size_t)(n_ + c) * n + n_ + c] = norm;
+    for (int i = 0; i < m_; ++i) {
+      Z[(size_t)i * k + c] /= norm;
+      z[n_ + c] += Z[(size_t)i * k + c] * y_[i];
+    }
+  }
+  // /// t = z solves the extended problem [A, N] * q = y exactly, and As 
+  // /// differs from [A, N] * T (see split_coefficients()) only by the 
+  // /// rescaling of the rows; CGLS on As * T * R.inverse() * t = y,
+  // /// starting at t = z, corrects that
+  const double tolerance = 1e-6;
+  const int max_iterations = 2 * n;
+  vector<double> t(z);
+  vector<double> q;
+  vector<double> x;
+  vector<double> g(n);
+  vector<double> h;
+  vector<double> r(m_);
+  vector<double> w(m_);
+  // /// r = y - As * T * R.inverse() * t
+  solve_upper(R, n, q, t);
+  split_coefficients(q, n_, first, k, x);
+  for (int i = 0; i < m_; ++i) {
+    const Real* a = As[i];
+    double s = y_[i];
+    for (int j = 0; j < n; ++j) {
+      s -= a[j] * x[j];
+    }
+    r[i] = s;
+  }
+  // /// s = R.inverse().transp() * T.transp() * As.transp() * r
+  vector<double> s;
+  vector<double> d;
+  bool converged = false;
+  double gamma = 0.0;
+  for (int iteration = 0; ; ++iteration) {
+    g.assign(n, 0.0);
+    double norm_r = 0.0;
+    for (int i = 0; i < m_; ++i) {
+      const Real* a = As[i];
+      for (int j = 0; j < n; ++j) {
+	g[j] += a[j] * r[i];
+      }
+      norm_r += r[i] * r[i];
+    }
+    split_coefficients_transp(g, n_, first, k, h);
+    solve_upper_transp(R, n, s, h);
+    double gamma_new = 0.0;
+    for (int j = 0; j < n; ++j) {
+      gamma_new += s[j] * s[j];
+    }
+    if (sqrt(gamma_new) <= tolerance * sqrt(norm_r)) {
+      converged = true;
+      break;
+    }
+    if (iteration == max_iterations) {
+      break;
+    }
+    if (iteration == 0) {
+      d = s;
+    }
+    else {
+      double beta = gamma_new / gamma;
+      for (int j = 0; j < n; ++j) {
+	d[j] = s[j] + beta * d[j];
+      }
+    }
+    gamma = gamma_new;
+    // /// w = As * T * R.inverse() * d
+    solve_upper(R, n, q, d);
+    split_coefficients(q, n_, first, k, x);
+    double delta = 0.0;
+    for (int i = 0; i < m_; ++i) {
+      const Real* a = As[i];
+      double v = 0.0;
+      for (int j = 0; j < n; ++j) {
+	v += a[j] * x[j];
+      }
+      w[i] = v;
+      delta += v * v;
+    }
+    if (delta == 0.0) {
+      break;
+    }
+    double alpha = gamma / delta;
+    for (int j = 0; j < n; ++j) {
+      t[j] += alpha * d[j];
+    }
+    for (int i = 0; i < m_; ++i) {
+      r[i] -= alpha * w[i];
+    }
+  }
+  if (! converged) {
+    return false;
+  }
+  solve_upper(R, n, q, t);
+  split_coefficients(q, n_, first, k, x);
+  if (p.dim() != n) {
+    p.newsize(n);
+  }
+  for (int j = 0; j < n; ++j) {
+    p[j] = (Real)x[j];
+  }
+  return true;
+}
+
+#ifdef SVD_BENCHMARK
+/*
+ * Benchmark of SVD() and SVD_QR() for tall-skinny matrices, the shape
+ * of the matrices built by FModel::optimize_SVD() (m samples, n = rules
+ * times consequence dimension).  Compile and run with
+ *   make benchmark
+ * or ./svdbench [threads] after make svdbench.
+ * It prints the time of both routines and max |A - U * Q * V.transp()|.
+ */
+
+#include <stdlib.h>
+#include <sys/time.h>
+#include <iostream>
+
+static double 
+wall_seconds(void) {
+  struct timeval t;
+  gettimeofday(&t, NULL);
+  return t.tv_sec + 1e-6 * t.tv_usec;
+}
+
+static Real
+residual(const Matrix<Real>& A, const Matrix<Real>& Q, 
+	 const Matrix<Real>& U, const Matrix<Real>& V) {
+  int m = A.num_rows();
+  int n = A.num_cols();
+  Real max_error = 0.0;
+  for (int i = 0; i < m; ++i) {
+    for (int j = 0; j < n; ++j) {
+      double s = 0.0;
+      for (int k = 0; k < n; ++k) {
+	s += (double)U[i][k] * Q[k][k] * V[j][k];
+      }
+      Real error = fabs(A[i][j] - (Real)s);
+      if (error > max_error) {
+	max_error = error;
+      }
+    }
+  }
+  return max_error;
+}
+
+int
+main(int argc, char* argv[]) {
+  int threads = (argc > 1) ? atoi(argv[1]) : 4;
+  const int shapes[][2] = { {10000, 12}, {100000, 24}, {100000, 60}, 
+			    {200000, 120} };
+  cout << "threads = " << threads << endl;
+  cout << "m n SVD[s] SVD_QR[s] residual(SVD) residual(SVD_QR)" << endl;
+  for (size_t s = 0; s < sizeof(shapes) / sizeof(shapes[0]); ++s) {
+    int m = shapes[s][0];
+    int n = shapes[s][1];
+    Matrix<Real> A(m, n);
+    srand(1);
+    for (int i = 0; i < m; ++i) {
+      for (int j = 0; j < n; ++j) {
+	A[i][j] = (Real)rand() / RAND_MAX - 0.5;
+      }
+    }
+    Matrix<Real> Q, U, V;
+    double t0 = wall_seconds();
+    SVD(A, Q, U, V);
+    double t1 = wall_seconds();
+    Real r1 = residual(A, Q, U, V);
+    double t2 = wall_seconds();
+    SVD_QR(A, Q, U, V, threads);
+    double t3 = wall_seconds();
+    Real r2 = residual(A, Q, U, V);
+    cout << m << " " << n << " " << (t1 - t0) << " " << (t3 - t2) << " "
+	 << r1 << " " << r2 << endl;
+  }
+  return 0;
+}
+
+#endif /* #ifdef SVD_BENCHMARK */
@@ -107,4 +107,125 @@ void
 SVD(const Matrix<Real>& A, Matrix<Real>& Q, Matrix<Real>& U, Matrix<Real>& V)
   throw (SVDError);
 
+
+/** Compute the SVD of a tall m x n matrix A via a blocked QR decomposition.
+ *
+ * Same contract as SVD(): A = U * Q * V.transp().
+ * A is first decomposed into A = H * R by Householder reflections
+ * H = H_1 * ... * H_n, a panel of 16 columns at a time (column-major 
+ * copy of A, i.e. unit stride in the inner loops).  The reflections of 
+ * a panel are applied to the remaining columns at once, in their 
+ * compact WY form I - V * T * V.transp(): two matrix products over 
+ * blocks of columns, computed by threads threads.
+ * Then the small n x n matrix R is decomposed by SVD(), R = U_R * Q * 
+ * V.transp(), and U = H * U_R is formed panel by panel the same way.
+ * For m >> n this needs about half the operations of SVD(), and the
+ * O(m n^2) part runs in parallel.
+ *
+ * @param threads number of threads (OpenMP)
+ * @exception SVDException  as SVD()
+ * @memo SVD of a tall matrix by a blocked, multithreaded QR decomposition
+ */
+void 
+SVD_QR(const Matrix<Real>& A, Matrix<Real>& Q, Matrix<Real>& U, 
+       Matrix<Real>& V, int threads = 1)
+  throw (SVDError);
+
+
+/** Solve a linear least squares problem y = A * p row by row.
+ *
+ * The rows of A (and the corresponding y) are given one at a time by
+ * add_row(). Each row is rotated into an upper triangular n x n matrix R
+ * (and z = Q.transp() * y) by Givens rotations, i.e. A = Q * R is never
+ * stored: the memory is O(n^2), independent of the number of rows m,
+ * and the data are read once.
+ *
+ * solve() computes the SVD of R (see SVD()) and, like for A itself,
+ *    p = V * Q.inverse() * U.transp() * z
+ * with the inverse of zero singular values set to zero.
+ *
+ * @memo least squares by a streaming QR decomposition
+ */
+class StreamingLeastSquares {
+protected:
+  /// number of columns
+  int n_;
+  /// number of rows added
+  size_t m_;
+  /// upper triangular factor
+  Matrix<Real> R_;
+  /// Q.transp() * y
+  Vector<Real> z_;
+  /// scratch for the row being rotated
+  Vector<Real> a_;
+public:
+  /// empty problem with n columns
+  StreamingLeastSquares(int n) 
+    : n_(n), m_(0), R_(n, n, (Real)0.0), z_(n, (Real)0.0), a_(n) { }
+  /// number of columns
+  int cols() const { return n_; }
+  /// number of rows added
+  size_t rows() const { return m_; }
+  /// add the row a[0..n-1] of A with right hand side y
+  void add_row(const Real* a, Real y);
+  /// least squares solution p (n values); precondition: rows() >= cols()
+  void solve(Vector<Real>& p) const throw (SVDError);
+};
+
+
+/** Solve least squares problems that split a block of columns of a 
+ *  factored problem y = A * p.
+ *
+ * The constructor computes the thin QR decomposition A = Q * R of the 
+ * m x n matrix A (as SVD_QR()) and z = Q.transp() * y once.
+ * solve_split() then solves y = As * p for a m x (n + k) matrix As whose
+ * block of columns first, ..., first + k - 1 of A is split into the two
+ * blocks first, ..., first + k - 1 and first + k, ..., first + 2k - 1
+ * of As; the remaining columns of A follow.  If the two blocks sum up
+ * to the block of A, As is A with k columns appended (up to the order 
+ * of the columns), and Q and R are extended by one Gram-Schmidt step 
+ * of the k new columns, O(m n k) operations.  Otherwise, e.g., if the 
+ * rows of As are scaled, the extended R is the preconditioner of CGLS 
+ * iterations of O(m n) operations each, starting at the solution of the
+ * extended problem.  At most 2 (n + k) iterations are done, so the worst
+ * case is O(m n^2) like a new decomposition.  The consequences of a 
+ * refined fuzzy model (FModel::optimize_SVD()) have scaled rows, i.e., 
+ * they take the CGLS path, which is not generally faster than solving 
+ * As anew.  As itself is built by the caller, m (n + k) values for 
+ * each split.
+ *
+ * @memo least squares of split columns, preconditioned by a parent QR
+ */
+class SplitLeastSquares {
+protected:
+  /// number of rows
+  int m_;
+  /// number of columns
+  int n_;
+  /// thin Q, m x n, row by row
+  vector<Real> Q_;
+  /// upper triangular factor, n x n, row by row
+  vector<double> R_;
+  /// Q.transp() * y
+  vector<double> z_;
+  /// right hand side
+  vector<Real> y_;
+  /// A has full rank
+  bool full_rank_;
+public:
+  /// decompose A (precondition: rows >= columns) with threads threads
+  SplitLeastSquares(const Matrix<Real>& A, const Vector<Real>& y, 
+		    int threads = 1) throw (SVDError);
+  /// number of rows
+  int rows() const { return m_; }
+  /// number of columns
+  int cols() const { return n_; }
+  /// A has full rank, i.e., solve_split() may succeed
+  bool full_rank() const { return full_rank_; }
+  /// least squares solution p (n + k values) of y = As * p; false if 
+  /// the extended problem is rank deficient or CGLS does not converge
+  bool solve_split(const Matrix<Real>& As, int first, int k, 
+		   Vector<Real>& p) const;
+};
+
 #endif /* #ifndef SVD_HH */
@@ -0,0 +1,207 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 1999, 2020 Manfred Maennle
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * $Id$
+ */
+
+
+/*
+ * Check program for the compiled model (see CModel): the y_hat() of an
+ * input vector must be identical to FModel::y_hat(), the block kernels
+ * must agree with it up to the deviation of the membership kernels, and
+ * so must the premises evaluated along the refinement tree (see 
+ * GLOBAL::tree_premises). The tree's node activations must agree with
+ * the full premise products up to a few roundings per level, also for
+ * membership values that are zero, subnormal, or so small that the 
+ * parent's activation underflows.
+ *
+ * usage: check_cmodel; exit status 0 if all checks pass
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+
+#include "global.hh"
+#include "cmodel.hh"
+
+
+/// input space dimension of the test model
+const size_t udim = 4;
+/// refinements of the test model (rules - 1)
+const size_t n_refinements = 12;
+/// input vectors; leaves a remainder to the block kernels
+const size_t n_rows = 1000;
+/// largest relative deviation of the block kernels and of the tree 
+/// evaluation from FModel::y_hat()
+const Real yhat_tolerance = 1.0e-4;
+/// largest relative deviation of a node activation from its premise
+const Real activation_tolerance = 1.0e-5;
+
+
+static Real
+random_real(void)
+{
+  return (Real)rand() / RAND_MAX;
+}
+
+
+/// CModel with access to its refinement tree
+class TreeCModel : public CModel
+{
+public:
+  TreeCModel(const FModel& m) : CModel(m) { }
+  /// number of failed checks of the activations of the fset values F
+  /// (n values per fset) against the full premise products
+  int check_activations(const vector<Real>& F, size_t n) const {
+    vector<Real> act(node_parent_.size() * n);
+    tree_values(&F[0], &act[0], n, n);
+    int n_failed = 0;
+    for (size_t node = 0; node < node_parent_.size(); ++node) {
+      for (size_t i = 0; i < n; ++i) {
+	Real product = 1.0;
+	for (size_t p = node_prem_begin_[node]; p < node_prem_begin_[node+1];
+	     ++p) {
+	  product *= F[node_prem_[p] * n + i];
+	}
+	Real a = act[node * n + i];
+	if (!(fabs(a - product) <= activation_tolerance * product + REAL_MIN)) {
+	  printf("  node %lu, vector %lu: activation %g instead of %g\n",
+		 (unsigned long)node, (unsigned long)i, (double)a, 
+		 (double)product);
+	  ++n_failed;
+	  break;
+	}
+      }
+    }
+    return n_failed;
+  }
+};
+
+
+/// fset values: ordinary ones, zeros, subnormals, and small ones whose 
+/// products underflow
+static void
+make_fset_values(vector<Real>& F, size_t sdim, size_t n)
+{
+  F.resize(sdim * n);
+  for (size_t k = 0; k < F.size(); ++k) {
+    Real x = random_real();
+    if (x < 0.1) {
+      F[k] = 0.0;
+    }
+    else if (x < 0.2) {
+      F[k] = 0.25 * REAL_MIN;
+    }
+    else if (x < 0.5) {
+      F[k] = pow(REAL_MIN, (Real)(0.1 + 0.4 * random_real()));
+    }
+    else {
+      F[k] = 1.0 - random_real();
+    }
+  }
+}
+
+
+/// number of failed checks of the compiled model against m on U
+static int
+check_y_hat(FModel& m, const Umatrix& U, bool tree)
+{
+  GLOBAL::tree_premises = tree;
+  CModel cmodel(m);
+  if (cmodel.tree() != tree) {
+    printf("  no refinement tree compiled\n");
+    return 1;
+  }
+  vector<Real> yhat;
+  vector<bool> covered;
+  cmodel.y_hat(U, yhat, covered);
+  vector<Real> F;
+  int n_failed = 0;
+  for (size_t i = 0; i < U.size(); ++i) {
+    Real y = m.y_hat(U[i], F);
+    Real y_single = cmodel.y_hat(U[i], F);
+    Real tolerance = yhat_tolerance * (fabs(y) + 1.0);
+    if (tree ? !(fabs(y_single - y) <= tolerance) : (y_single != y)) {
+      printf("  vector %lu: y_hat %g instead of %g\n", (unsigned long)i, 
+	     (double)y_single, (double)y);
+      ++n_failed;
+    }
+    if (!covered[i] || !(fabs(yhat[i] - y) <= tolerance)) {
+      printf("  vector %lu: block y_hat %g instead of %g\n", 
+	     (unsigned long)i, (double)yhat[i], (double)y);
+      ++n_failed;
+    }
+  }
+  return n_failed;
+}
+
+
+int
+main(int, char*[])
+{
+  Data d(udim, n_rows, 0.0);
+  for (size_t i = 0; i < n_rows; ++i) {
+    for (size_t k = 0; k < udim; ++k) {
+      d.U()[i][k] = random_real();
+    }
+  }
+  /// refine the last rule along the inputs in turn, so that its later
+  /// refinements replace fsets, and now and then another rule
+  FModel m(d, udim + 1);
+  for (size_t k = 0; k < n_refinements; ++k) {
+    size_t r = (k % 3 == 2) ? k % m.rdim() : m.rdim() - 1;
+    FModel refined(m, r, k % udim);
+    m.copy(refined);
+  }
+  for (size_t s = 0; s < m.sdim(); ++s) {
+    m.fsets(s).mu() = 0.2 + 0.6 * random_real();
+    m.fsets(s).sigma() = (m.fsets(s).sigma() < 0.0 ? -1.0 : 1.0) 
+      * (2.0 + 18.0 * random_real());
+  }
+  for (size_t r = 0; r < m.rdim(); ++r) {
+    for (size_t c = 0; c < m.cdim(); ++c) {
+      m.frules(r).cons()[c] = 2.0 * random_real() - 1.0;
+    }
+  }
+  int n_failed = 0;
+  for (int tree = 0; tree < 2; ++tree) {
+    for (int mirror = 0; mirror < 2; ++mirror) {
+      if (mirror) {
+	d.U().mirror_columns();
+      }
+      int n = check_y_hat(m, d.U(), tree);
+      printf("y_hat%s%s: %s\n", tree ? ", tree" : "", 
+	     mirror ? ", column mirror" : "", (n == 0) ? "ok" : "FAILED");
+      n_failed += n;
+    }
+  }
+  GLOBAL::tree_premises = 1;
+  TreeCModel cmodel(m);
+  vector<Real> F;
+  make_fset_values(F, m.sdim(), n_rows);
+  int n = cmodel.check_activations(F, n_rows);
+  printf("tree activations: %s\n", (n == 0) ? "ok" : "FAILED");
+  n_failed += n;
+  return (n_failed == 0) ? 0 : 1;
+}
@@ -0,0 +1,169 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 1999, 2020 Manfred Maennle
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * $Id$
+ */
+
+
+/*
+ * Check program for the data scanner (see DataScanner): on the same
+ * input, the scanner of data_lex.l (flex) and DataScanner, reading the
+ * file or a range in memory, must return the same tokens, the same
+ * numbers and error texts, and the same line numbers; numbers with and
+ * without exponents, comments and directives, names, strings, and stray
+ * characters.
+ *
+ * usage: check_data_scanner; exit status 0 if all checks pass
+ */
+
+#ifndef WIN2017
+#include <fstream.h>
+#else
+#include <fstream>
+#endif
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "global.hh"
+#include "data_scan.hh"
+
+#include "data_lex.h"
+#undef yyFlexLexer
+#define yyFlexLexer data_FlexLexer
+#include <FlexLexer.h>
+
+
+/// scratch file of the inputs
+const char* filename = "check_data_scanner.tmp";
+
+/// inputs; each one a file
+const char* inputs[] = {
+  // numbers
+  "1 -1 +1 0 007\n",
+  "1. -1. .5 -.5 +.5 1.5 -0.25\n",
+  "1e5 1E5 1e+5 1e-5 -1.5e3 .5e-3 1.e2 +2.5E+02\n",
+  "123456789012345678901234567890 1e300 1e-300 4.9e-324 1e400\n",
+  "0.1 0.2 0.30000000000000004 3.14159265358979323846\n",
+  // malformed numbers and names
+  "1e 1e+ 1e- 1.5.2 1..2 .e5 . - +\n",
+  "1abc 1e5x abc a_b.c-d/e $x 1-2 1+2 --1 +-1 0x10\n",
+  // strings, stray characters
+  "\"a string\" \"\" \"unterminated\n",
+  "1,2;3 @ ! ( ) * =\n",
+  // comments and directives
+  "# a comment 1 2 3\n#\n# \n#x\n",
+  "##comment: text 1 2\n##source: \"file\"\n##dynamics: 1 1\n",
+  "##rows: 3\n##columns: 2\n##names: a b\n",
+  "##shift: 1 -2.5e1\n##factor: 0.5 2\n",
+  "##unknown: 1\n##shift 1\n##factor:1\n### x\n## x\n",
+  "1 2 # a comment behind data\n",
+  // blanks, empty lines, line ends
+  "1\t2  3 \t 4\t\n\n\n5\n",
+  "1 2\r\n3 4\r\n",
+  "1 2\n3 4",
+  "",
+  "\n",
+  NULL
+};
+
+
+/// name of a token
+const char* 
+token_name(int token) {
+  switch (token) {
+  case T_DATA_COMMENT: return "COMMENT";
+  case T_DATA_NUMBER: return "NUMBER";
+  case T_DATA_NEWLINE: return "NEWLINE";
+  case T_DATA_ERROR: return "ERROR";
+  case T_DATA_EOF: return "EOF";
+  case T_DATA_SCALE_SHIFT: return "SHIFT";
+  case T_DATA_SCALE_FACTOR: return "FACTOR";
+  }
+  return "?";
+}
+
+
+/// compare the tokens of DataScanner with the flex scanner's;
+/// number of deviations
+int
+compare(const char* input, DataScanner& scanner, const char* name) {
+  ifstream file(filename);
+  data_FlexLexer lexer(&file);
+  int token;
+  int n = 0;
+  do {
+    token = lexer.yylex();
+    int scanned = scanner.next();
+    const char* error = NULL;
+    if (scanned != token) {
+      error = "token";
+    }
+    else if ((token == T_DATA_NUMBER) 
+	     && (scanner.value() != (Real)atof(lexer.YYText()))) {
+      error = "value";
+    }
+    else if ((token == T_DATA_ERROR) && (scanner.text() != lexer.YYText())) {
+      error = "text";
+    }
+    else if (scanner.lineno() != lexer.lineno()) {
+      error = "line number";
+    }
+    if (error != NULL) {
+      fprintf(stderr, "%s: input \"%s\": line %d: %s differs: flex %s `%s'"
+	      ", DataScanner %s `%s'\n", name, input, lexer.lineno(), error, 
+	      token_name(token), lexer.YYText(), token_name(scanned), 
+	      scanner.text().c_str());
+      ++n;
+      break;
+    }
+  } while ((token != T_DATA_EOF) && (token != 0));
+  return n;
+}
+
+
+int
+main(int, char*[])
+{
+  int failures = 0;
+  for (size_t i = 0; inputs[i] != NULL; ++i) {
+    FILE* file = fopen(filename, "w");
+    if ((file == NULL) || (fputs(inputs[i], file) < 0) || fclose(file)) {
+      fprintf(stderr, "check_data_scanner: cannot write %s\n", filename);
+      return 1;
+    }
+    file = fopen(filename, "r");
+    DataScanner file_scanner(file);
+    failures += compare(inputs[i], file_scanner, "file");
+    fclose(file);
+    DataScanner memory_scanner(inputs[i], inputs[i] + strlen(inputs[i]));
+    failures += compare(inputs[i], memory_scanner, "memory");
+  }
+  remove(filename);
+  if (failures > 0) {
+    fprintf(stderr, "check_data_scanner: %d failures\n", failures);
+    return 1;
+  }
+  printf("check_data_scanner: all checks passed\n");
+  return 0;
+}
@@ -0,0 +1,208 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 1999, 2020 Manfred Maennle
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * $Id$
+ */
+
+
+
+/*
+ * Check program for the lagged regressors of Data::assign_lags(): every
+ * row must hold u_s(t-1), ..., u_s(t-d_s), ..., y(t-1), ..., y(t-d_y)
+ * and y(t), as fzymkdat writes them; the lags of a signal must be views
+ * into one copy of it, each column one Real before the previous lag, 
+ * with lag 1 aligned to 64 bytes; copies must keep the views, and 
+ * changing a row must copy the data into rows first.  Also checks the 
+ * column-major mirror of rows (see Umatrix::mirror_columns()).
+ *
+ * usage: check_lag_columns; exit status 0 if all checks pass
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+
+#include "global.hh"
+#include "data.hh"
+
+
+/// u_1, u_2, u_3 and y; u_2 has no lags
+const int orders[] = { 3, 0, 2, 1 };
+const size_t n_signals = sizeof(orders) / sizeof(orders[0]);
+const size_t max_order = 3;
+/// rows of the signals skipped
+const size_t first = 2;
+
+
+/// n_rows random rows of the signals, with a scale per signal
+static void
+make_signals(Data& a, size_t n_rows)
+{
+  a = Data(n_signals - 1, n_rows, 0.0);
+  for (size_t t = 0; t < n_rows; ++t) {
+    RowView<Real> u = a.U()[t];
+    for (size_t s = 0; s + 1 < n_signals; ++s) {
+      u[s] = (Real)rand() / RAND_MAX;
+    }
+    a.y()[t] = (Real)rand() / RAND_MAX;
+  }
+  vector<Real> factor(n_signals);
+  vector<Real> shift(n_signals);
+  for (size_t s = 0; s < n_signals; ++s) {
+    factor[s] = 1.0 + s;
+    shift[s] = 0.5 * s;
+  }
+  /// sets the scale (and normalizes the random values)
+  a.normalize(factor, shift);
+}
+
+
+/// signal s of a at time t
+static Real
+signal(const Data& a, size_t s, size_t t)
+{
+  return (s + 1 < n_signals) ? a.U()[t][s] : a.y()[t];
+}
+
+
+/// number of failed checks of the lags b of a
+static int
+check_lags(const Data& a, const Data& b, bool ut_regressor, bool views)
+{
+  int n_failed = 0;
+  size_t n_rows = b.U().size();
+  Subscript k = 0;
+  for (size_t s = 0; s < n_signals; ++s) {
+    for (int l = 1; l <= orders[s]; ++l, ++k) {
+      size_t shift = (ut_regressor && (s + 1 < n_signals)) ? 1 : 0;
+      for (size_t i = 0; i < n_rows; ++i) {
+	Real value = signal(a, s, first + max_order + i + shift - l);
+	if (b.U()[i][k] != value) {
+	  printf("  signal %lu, lag %d, row %lu: %g instead of %g\n", 
+		 (unsigned long)s, l, (unsigned long)i, 
+		 (double)b.U()[i][k], (double)value);
+	  ++n_failed;
+	  break;
+	}
+      }
+      if (! views) {
+	continue;
+      }
+      if ((l == 1) && ((uintptr_t)b.U().column(k) % 64 != 0)) {
+	printf("  lag 1 of signal %lu not aligned\n", (unsigned long)s);
+	++n_failed;
+      }
+      if ((l > 1) && (b.U().column(k) != b.U().column(k - 1) - 1)) {
+	printf("  lag %d of signal %lu is no view of lag %d\n", l, 
+	       (unsigned long)s, l - 1);
+	++n_failed;
+      }
+      if ((b.scale_factor()[k] != a.scale_factor()[s])
+	  || (b.scale_shift()[k] != a.scale_shift()[s])) {
+	printf("  scale of lag %d of signal %lu\n", l, (unsigned long)s);
+	++n_failed;
+      }
+    }
+  }
+  if (k != b.udim()) {
+    printf("  %d columns instead of %d\n", (int)b.udim(), (int)k);
+    ++n_failed;
+  }
+  for (size_t i = 0; i < n_rows; ++i) {
+    if (b.y()[i] != a.y()[first + max_order + i]) {
+      printf("  y of row %lu\n", (unsigned long)i);
+      ++n_failed;
+      break;
+    }
+  }
+  return n_failed;
+}
+
+
+/// number of failed checks of the mirror of U
+static int
+check_mirror(const Umatrix& U)
+{
+  int n_failed = 0;
+  for (Subscript k = 0; k < U.udim(); ++k) {
+    const Real* column = U.column(k);
+    if ((uintptr_t)column % 64 != 0) {
+      printf("  column %d not aligned\n", (int)k);
+      ++n_failed;
+    }
+    for (size_t i = 0; i < U.size(); ++i) {
+      if (column[i] != U[i][k]) {
+	printf("  column %d, row %lu: %g instead of %g\n", (int)k, 
+	       (unsigned long)i, (double)column[i], (double)U[i][k]);
+	++n_failed;
+	break;
+      }
+    }
+  }
+  return n_failed;
+}
+
+
+int
+main(int, char*[])
+{
+  int n_failed = 0;
+  vector<int> dynamic_orders(orders, orders + n_signals);
+  /// row counts that leave remainders to the transposing blocks
+  size_t n_rows[] = { 1, 17, 255, 1000 };
+  for (size_t r = 0; r < sizeof(n_rows) / sizeof(n_rows[0]); ++r) {
+    for (int ut_regressor = 0; ut_regressor <= 1; ++ut_regressor) {
+      Data a;
+      make_signals(a, first + max_order + n_rows[r]);
+      Data b;
+      b.assign_lags("lags", a, dynamic_orders, ut_regressor, first, 
+		    n_rows[r]);
+      const Data& lags = b;
+      int n = check_lags(a, lags, ut_regressor, true);
+      /// a copy keeps the views
+      const Data copy(b);
+      n += check_lags(a, copy, ut_regressor, true);
+      /// the lags need no mirror
+      b.U().mirror_columns();
+      if (! lags.U().by_columns()) {
+	printf("  mirrored lags not stored by columns\n");
+	++n;
+      }
+      /// changing a row copies the lags into rows
+      Data rows(b);
+      rows.U()[0][0] += 0.0;
+      if (rows.U().by_columns() || rows.U().has_columns()) {
+	printf("  changed lags still stored by columns\n");
+	++n;
+      }
+      n += check_lags(a, rows, ut_regressor, false);
+      n += check_lags(a, lags, ut_regressor, true);
+      rows.U().mirror_columns();
+      n += check_mirror(rows.U());
+      printf("%4lu rows%s: %s\n", (unsigned long)n_rows[r], 
+	     ut_regressor ? ", -rt" : "     ", (n == 0) ? "ok" : "FAILED");
+      n_failed += n;
+    }
+  }
+  return (n_failed == 0) ? 0 : 1;
+}
@@ -0,0 +1,125 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 1999, 2020 Manfred Maennle
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * $Id$
+ */
+
+
+/*
+ * Check program for the membership kernels (see membership()): every
+ * kernel the CPU supports must agree with the scalar sigmoid() kernel on
+ * inputs covering the sigmoid table, its borders and both tails, for
+ * column lengths that leave remainders to the scalar loop.  A build 
+ * with the vectorized kernels (see SIMD_MEMBERSHIP in fmodel.hh) fails 
+ * if the CPU runs none of them, as every x86 CPU it is built for has 
+ * SSE2; a build without them says so.
+ *
+ * usage: check_membership; exit status 0 if all kernels pass
+ */
+
+#include <stdio.h>
+#include <math.h>
+
+#include "global.hh"
+#include "fmodel.hh"
+
+
+/// largest deviation of a vectorized kernel from the scalar kernel
+const Real membership_tolerance = 1.0e-6;
+
+
+/// largest deviation of kernel from the scalar kernel
+static Real
+membership_deviation(MembershipKernel kernel)
+{
+  MembershipKernel scalar = membership_kernel("scalar");
+  const size_t n_max = 4003;
+  vector<Real> u(n_max + 1);
+  vector<Real> F(n_max + 1);
+  vector<Real> F_scalar(n_max + 1);
+  Real deviation = 0.0;
+  size_t n[] = { 1, 7, 9, 17, 33, n_max };
+  Real mu[] = { 0.0, 0.3, -0.7 };
+  Real sigma[] = { 1.0, -2.5, 40.0 };
+  for (size_t l = 0; l < sizeof(n) / sizeof(n[0]); ++l) {
+    /// inputs covering the table, its borders and both tails; the
+    /// column starts one element in, so it is not aligned
+    for (size_t i = 0; i < n[l]; ++i) {
+      u[i + 1] = (n[l] > 1) ? -8.0 + 16.0 * i / (n[l] - 1) : 0.5;
+    }
+    for (size_t k = 0; k < 3; ++k) {
+      kernel(mu[k], sigma[k], &u[1], &F[1], n[l]);
+      scalar(mu[k], sigma[k], &u[1], &F_scalar[1], n[l]);
+      for (size_t i = 1; i <= n[l]; ++i) {
+	Real d = fabs(F[i] - F_scalar[i]);
+	if (!(d <= deviation)) {
+	  deviation = d;
+	}
+      }
+    }
+  }
+  return deviation;
+}
+
+
+int
+main(int, char*[])
+{
+  const char* name[] = { "avx512f", "avx2", "sse2" };
+  int n_failed = 0;
+  int n_tested = 0;
+  for (size_t k = 0; k < 3; ++k) {
+    MembershipKernel kernel = membership_kernel(name[k]);
+    if (kernel == NULL) {
+      printf("%-8s not available\n", name[k]);
+      continue;
+    }
+    ++n_tested;
+    Real deviation = membership_deviation(kernel);
+    bool passed = (deviation <= membership_tolerance);
+    printf("%-8s deviation %g: %s\n", name[k], (double)deviation,
+	   passed ? "ok" : "FAILED");
+    if (!passed) {
+      ++n_failed;
+    }
+  }
+  /// the kernel membership() dispatches to
+  Real deviation = membership_deviation(membership);
+  bool passed = (deviation <= membership_tolerance);
+  printf("%-8s deviation %g: %s (membership())\n", membership_kernel(),
+	 (double)deviation, passed ? "ok" : "FAILED");
+  if (!passed) {
+    ++n_failed;
+  }
+  if (n_tested == 0) {
+#ifdef SIMD_MEMBERSHIP
+    printf("no vectorized kernel tested: FAILED\n");
+    ++n_failed;
+#else
+    printf("WARNING: this build has no vectorized kernels (see "
+	   "SIMD_MEMBERSHIP in fmodel.hh),\n"
+	   "         only the scalar kernel was checked\n");
+#endif
+  }
+  return (n_failed == 0) ? 0 : 1;
+}
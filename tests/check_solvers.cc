@@ -0,0 +1,194 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 1999, 2020 Manfred Maennle
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * $Id$
+ */
+
+
+/*
+ * Check program for the least squares solvers of the consequences (see
+ * FModel::optimize_SVD()): on a small well-conditioned problem, the
+ * streaming QR (-Cs) and the QR-preconditioned SVD (-Cp) must give the
+ * parameter vector of the SVD, and the local weighted least squares
+ * (-Cl) those of the SVDs of the rules' weighted problems, up to 
+ * rounding.
+ *
+ * usage: check_solvers; exit status 0 if all checks pass
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+
+#include "global.hh"
+#include "svd.hh"
+#include "cmodel.hh"
+
+
+/// input space dimension of the test model
+const size_t udim = 3;
+/// refinements of the test model (rules - 1)
+const size_t n_refinements = 2;
+/// samples; more than one block of the streaming solvers
+const size_t n_rows = 5000;
+/// largest deviation from the reference, relative to its largest 
+/// parameter
+const Real parameter_tolerance = 1.0e-3;
+
+
+static Real
+random_real(void)
+{
+  return (Real)rand() / RAND_MAX;
+}
+
+
+/// consequence parameters of m, rule by rule, after optimize_SVD() on
+/// d; they are cleared before, as a failing solver keeps them
+static void
+optimized_consequences(FModel& m, const Data& d, vector<Real>& p)
+{
+  for (size_t r = 0; r < m.rdim(); ++r) {
+    for (size_t c = 0; c < m.cdim(); ++c) {
+      m.frules(r).cons()[c] = 0.0;
+    }
+  }
+  m.optimize_SVD(d);
+  p.clear();
+  for (size_t r = 0; r < m.rdim(); ++r) {
+    for (size_t c = 0; c < m.cdim(); ++c) {
+      p.push_back(m.frules(r).cons()[c]);
+    }
+  }
+}
+
+
+/// reference of the local weighted least squares: the SVD of each 
+/// rule's problem, its rows weighted by the square roots of the 
+/// normalized premise values
+static void
+local_reference(const FModel& m, const Data& d, vector<Real>& p)
+{
+  CModel cmodel(m);
+  vector<Real> w;
+  cmodel.premvalues(d.U(), w);
+  size_t rdim = m.rdim();
+  size_t cdim = m.cdim();
+  p.clear();
+  for (size_t r = 0; r < rdim; ++r) {
+    Matrix<Real> A(d.U().size(), cdim);
+    Vector<Real> y(d.U().size());
+    for (size_t i = 0; i < d.U().size(); ++i) {
+      Real sum_w = 0.0;
+      for (size_t k = 0; k < rdim; ++k) {
+	sum_w += w[i * rdim + k];
+      }
+      Real v = sqrt(w[i * rdim + r] / sum_w);
+      A(i + 1, 1) = v;
+      for (size_t c = 1; c < cdim; ++c) {
+	A(i + 1, c + 1) = v * d.U()[i][c - 1];
+      }
+      y(i + 1) = v * d.y()[i];
+    }
+    Matrix<Real> Q;
+    Matrix<Real> U;
+    Matrix<Real> V;
+    SVD(A, Q, U, V);
+    for (size_t c = 1; c <= cdim; ++c) {
+      if (Q(c, c) != 0.0) {
+	Q(c, c) = 1.0 / Q(c, c);
+      }
+    }
+    Vector<Real> p_r = V * (Q * (transpose(U) * y));
+    for (size_t c = 1; c <= cdim; ++c) {
+      p.push_back(p_r(c));
+    }
+  }
+}
+
+
+/// number of failed checks of p against the reference p_ref
+static int
+check_parameters(const char* name, const vector<Real>& p, 
+		 const vector<Real>& p_ref)
+{
+  Real scale = 0.0;
+  for (size_t k = 0; k < p_ref.size(); ++k) {
+    if (fabs(p_ref[k]) > scale) {
+      scale = fabs(p_ref[k]);
+    }
+  }
+  Real deviation = 0.0;
+  for (size_t k = 0; k < p_ref.size(); ++k) {
+    Real dk = fabs(p[k] - p_ref[k]);
+    if (!(dk <= deviation)) {
+      deviation = dk;
+    }
+  }
+  bool passed = (p.size() == p_ref.size()) && (scale > 0.0)
+    && (deviation <= parameter_tolerance * scale);
+  printf("%-4s deviation %g: %s\n", name, (double)deviation, 
+	 passed ? "ok" : "FAILED");
+  return passed ? 0 : 1;
+}
+
+
+int
+main(int, char*[])
+{
+  Data d(udim, n_rows, 0.0);
+  for (size_t i = 0; i < n_rows; ++i) {
+    Real y = 0.0;
+    for (size_t k = 0; k < udim; ++k) {
+      d.U()[i][k] = random_real();
+      y += (k + 1) * d.U()[i][k] * d.U()[i][k];
+    }
+    d.y()[i] = y + 0.01 * (random_real() - 0.5);
+  }
+  FModel m(d, udim + 1);
+  for (size_t k = 0; k < n_refinements; ++k) {
+    FModel refined(m, m.rdim() - 1, k % udim);
+    m.copy(refined);
+  }
+  for (size_t s = 0; s < m.sdim(); ++s) {
+    m.fsets(s).mu() = 0.3 + 0.4 * random_real();
+    m.fsets(s).sigma() = (m.fsets(s).sigma() < 0.0 ? -1.0 : 1.0) * 8.0;
+  }
+  int n_failed = 0;
+  vector<Real> p_ref;
+  vector<Real> p;
+  optimized_consequences(m, d, p_ref);
+  GLOBAL::consequence_streaming = 1;
+  optimized_consequences(m, d, p);
+  n_failed += check_parameters("-Cs", p, p_ref);
+  GLOBAL::consequence_streaming = 0;
+  GLOBAL::svd_threads = 3;
+  optimized_consequences(m, d, p);
+  n_failed += check_parameters("-Cp", p, p_ref);
+  GLOBAL::svd_threads = 0;
+  local_reference(m, d, p_ref);
+  GLOBAL::consequence_local = 1;
+  optimized_consequences(m, d, p);
+  n_failed += check_parameters("-Cl", p, p_ref);
+  return (n_failed == 0) ? 0 : 1;
+}
@@ -0,0 +1,40 @@
+#!/bin/sh
+#
+# common part of the fzymodel tests; sourced by each test_*.sh
+#
+# Every test runs in its own scratch directory, with the program names
+# (fzymodel, fzynorml, ...) linked to the binary in $FZYBIN.
+#
+
+TESTDIR=$(cd "$(dirname "$0")" && pwd)
+EXAMPLES=$TESTDIR/../examples
+WORKDIR=$(mktemp -d "${TMPDIR:-/tmp}/fzytest.XXXXXX") || exit 1
+trap 'cd /; rm -rf "$WORKDIR"' 0
+
+mkdir "$WORKDIR/bin"
+for prg in fzymodel fzynorml fzymkdat fzyestim fzysimul fzy2sets; do
+  ln -s "$FZYBIN" "$WORKDIR/bin/$prg"
+done
+PATH=$WORKDIR/bin:$PATH
+export PATH
+cd "$WORKDIR"
+
+fail() {
+  echo "FAIL: $*" >&2
+  exit 1
+}
+
+# files $1 and $2 must be equal
+same_file() {
+  cmp -s "$1" "$2" || fail "$1 and $2 differ"
+}
+
+# normalized tank example data: tank_t.nrm (learning), tank_f1.nrm
+# (validation), and the scaling in tank.nor
+make_tank_data() {
+  cp "$EXAMPLES/tank/tank_t.dat" "$EXAMPLES/tank/tank_f1.dat" .
+  fzynorml -f1 tank_t.dat -f2 tank.nor -q || fail "fzynorml"
+  for f in tank_t tank_f1; do
+    fzymkdat -f1 tank.nor -f2 $f.dat -f3 $f -d 1 1 -q || fail "fzymkdat $f"
+  done
+}
@@ -0,0 +1,35 @@
+#!/bin/sh
+#
+# run the fzymodel tests
+#
+# usage: run_tests.sh <fzymodel binary> [test_*.sh ...]
+#
+
+if [ $# -lt 1 ] || [ ! -x "$1" ]; then
+  echo "usage: $0 <fzymodel binary> [test_*.sh ...]" >&2
+  exit 2
+fi
+FZYBIN=$(cd "$(dirname "$1")" && pwd)/$(basename "$1")
+export FZYBIN
+shift
+cd "$(dirname "$0")" || exit 2
+
+if [ $# -eq 0 ]; then
+  set -- test_*.sh
+fi
+n_failed=0
+for test in "$@"; do
+  if output=$(sh "./$test" 2>&1); then
+    echo "PASS $test"
+  else
+    echo "FAIL $test"
+    echo "$output" | tail -20 | sed 's/^/    /'
+    n_failed=$((n_failed + 1))
+  fi
+done
+if [ $n_failed -gt 0 ]; then
+  echo "$n_failed of $# tests failed"
+  exit 1
+fi
+echo "all $# tests passed"
+exit 0
@@ -0,0 +1,44 @@
+#!/bin/sh
+#
+# -b: a binary data file (see write_binary_data()) loads the values of
+# the corresponding text file; with 6-digit data and the identity
+# normalization the text file is exact, so models and normalizations
+# made from the binary files equal those made from the text files
+#
+
+. "$(dirname "$0")/common.sh"
+
+for f in tank_t tank_f1; do
+  awk '{ printf "%.6g %.6g\n", $1, $2 }' "$EXAMPLES/tank/$f.dat" > $f.dat
+done
+cat > id.nor <<END
+##source: "tank_t.dat"
+##rows: 1000
+##columns: 2
+##shift: 0 0
+##factor: 1 1
+0 0
+1 1
+END
+
+mkdir text bin
+for f in tank_t tank_f1; do
+  fzymkdat -f1 id.nor -f2 $f.dat -f3 text/$f -d 1 1 -q >/dev/null \
+    || fail "fzymkdat $f"
+  fzymkdat -f1 id.nor -f2 $f.dat -f3 bin/$f -d 1 1 -b -q >/dev/null \
+    || fail "fzymkdat -b $f"
+  [ "$(head -c 7 bin/$f.nrm)" = FZYDATA ] || fail "bin/$f.nrm is not binary"
+  same_file text/$f.ogl bin/$f.ogl
+done
+
+for d in text bin; do
+  (cd $d \
+    && fzymodel -f1 tank_t.nrm -f2 tank_f1.nrm -c 2 -R 4 -q -e a \
+    && fzynorml -f1 tank_t.nrm -f2 all.nor -q \
+    && fzynorml -f1 tank_t.nrm -f2 stream.nor -M 100 -q) \
+    || fail "models of the $d files"
+done
+for f in text/mod_ac2_* text/all.nor text/stream.nor; do
+  same_file $f bin/${f#text/}
+done
+exit 0
@@ -0,0 +1,40 @@
+#!/bin/sh
+#
+# --resume: a structure search that is stopped after an epoch and resumed
+# from its checkpoint ends with the same models as an uninterrupted one
+#
+
+. "$(dirname "$0")/common.sh"
+
+make_tank_data
+MODEL="-f1 tank_t.nrm -f2 tank_f1.nrm -c 2 -q"
+
+fzymodel $MODEL -R 4 -e a || fail "uninterrupted search"
+
+fzymodel $MODEL -R 2 -e b || fail "search up to epoch 2"
+[ -f mod_bc2_rr.ckp ] || fail "no checkpoint written"
+# a checkpoint write interrupted before its rename leaves a partial
+# temporary file, which must not affect the last checkpoint
+cp mod_bc2_rr.ckp mod_bc2_rr.ckp.saved
+head -c 100 mod_bc2_rr.ckp > mod_bc2_rr.ckp.tmp
+fzymodel $MODEL -R 4 -e b --resume || fail "resumed search"
+for f in mod_ac2_r*.fzy mod_ac2_r*.out mod_ac2_*.r2 mod_ac2_*.err \
+	 mod_ac2_rr.ckp; do
+  same_file $f mod_b${f#mod_a}
+done
+[ -f mod_bc2_rr.ckp.tmp ] && fail "temporary checkpoint left behind"
+
+# the checkpoint is self-contained: it is all that a resume needs
+mkdir alone
+cp tank_t.nrm tank_f1.nrm alone
+cp mod_bc2_rr.ckp.saved alone/mod_bc2_rr.ckp
+(cd alone && fzymodel $MODEL -R 4 -e b --resume) \
+  || fail "resume from the checkpoint alone"
+same_file mod_ac2_ro.fzy alone/mod_bc2_ro.fzy
+
+# a truncated checkpoint is rejected
+head -n 30 mod_bc2_rr.ckp.saved > mod_bc2_rr.ckp
+fzymodel $MODEL -R 4 -e b --resume && fail "truncated checkpoint accepted"
+grep -q "error: read_checkpoint" mod_bc2_rr.log \
+  || fail "no checkpoint error message"
+exit 0
@@ -0,0 +1,38 @@
+#!/bin/sh
+#
+# fzymkdat --configs: the data sets of a configuration file, made in
+# parallel from one load of the data, equal those of one fzymkdat call
+# per line; a file naming one output data set twice is rejected
+#
+
+. "$(dirname "$0")/common.sh"
+
+make_tank_data
+cat > configs.txt <<END
+# output  options
+c_11  -d 1 1
+c_22  -d 2 2 -Np 500
+
+c_rt  -d 1 2 -rt -Ns 10
+END
+
+fzymkdat -f1 tank.nor -f2 tank_t.dat -f3 s_11 -d 1 1 -q || fail "-d 1 1"
+fzymkdat -f1 tank.nor -f2 tank_t.dat -f3 s_22 -d 2 2 -Np 500 -q \
+  || fail "-d 2 2"
+fzymkdat -f1 tank.nor -f2 tank_t.dat -f3 s_rt -d 1 2 -rt -Ns 10 -q \
+  || fail "-d 1 2 -rt"
+for j in 1 3; do
+  fzymkdat -f1 tank.nor -f2 tank_t.dat --configs configs.txt -j $j -q \
+    || fail "--configs -j $j"
+  for f in 11 22 rt; do
+    same_file s_$f.nrm c_$f.nrm
+    same_file s_$f.ogl c_$f.ogl
+  done
+  rm -f c_*
+done
+
+echo "c_11  -d 2 2" >> configs.txt
+fzymkdat -f1 tank.nor -f2 tank_t.dat --configs configs.txt -q 2>/dev/null \
+  && fail "duplicate output data accepted"
+[ -f c_11.nrm ] && fail "data written despite the duplicate"
+exit 0
@@ -0,0 +1,25 @@
+#!/bin/sh
+#
+# -Cu: the preselected candidates' consequences fitted by CGLS on the
+# parent's QR factors give the model of the fit by SVD (up to the CGLS
+# tolerance), and -Cu needs -Sp and excludes -Cl and -Cs
+#
+
+. "$(dirname "$0")/common.sh"
+
+make_tank_data
+MODEL="-f1 tank_t.nrm -f2 tank_f1.nrm -c 2 -R 6 -Sp 4 -q"
+
+fzymodel $MODEL -e a || fail "-Sp 4"
+fzymodel $MODEL -Cu -e b || fail "-Sp 4 -Cu"
+grep "CGLS on parent's QR for preselection: 1" mod_bc2_rr.log >/dev/null \
+  || fail "-Cu not reported in the log"
+awk -v a="$(tail -1 mod_ac2_ro.r2)" -v b="$(tail -1 mod_bc2_ro.r2)" \
+  'BEGIN { d = a - b; if (d < 0) d = -d; exit !(d < 1e-3) }' \
+  || fail "R2 with -Cu differs from the SVD's"
+
+fzymodel -f1 tank_t.nrm -f2 tank_f1.nrm -c 2 -R 2 -Cu -q -e c 2>/dev/null \
+  && fail "-Cu accepted without -Sp"
+fzymodel $MODEL -Cu -Cl -e c 2>/dev/null && fail "-Cu accepted with -Cl"
+fzymodel $MODEL -Cu -Cs -e c 2>/dev/null && fail "-Cu accepted with -Cs"
+exit 0
@@ -0,0 +1,31 @@
+#!/bin/sh
+#
+# -J: gradients accumulated in data-parallel shards; -J 1 is the serial
+# accumulation, and a given -J gives the same models however many threads
+# OpenMP grants
+#
+
+. "$(dirname "$0")/common.sh"
+
+make_tank_data
+MODEL="-f1 tank_t.nrm -f2 tank_f1.nrm -c 2 -R 3 -q"
+
+fzymodel $MODEL -e a || fail "serial gradients"
+fzymodel $MODEL -J 1 -e b || fail "-J 1"
+for f in mod_ac2_*.fzy mod_ac2_*.out mod_ac2_*.r2 mod_ac2_*.err; do
+  same_file $f mod_b${f#mod_a}
+done
+
+OMP_THREAD_LIMIT=1 fzymodel $MODEL -J 3 -e c || fail "-J 3 on one thread"
+fzymodel $MODEL -J 3 -e d || fail "-J 3"
+for f in mod_cc2_*.fzy mod_cc2_*.r2 mod_cc2_*.err; do
+  same_file $f mod_d${f#mod_c}
+done
+
+# the shards only change the summation order
+R2_serial=$(tail -1 mod_ac2_ro.r2)
+R2_shards=$(tail -1 mod_dc2_ro.r2)
+awk -v a="$R2_serial" -v b="$R2_shards" \
+  'BEGIN { d = a - b; if (d < 0) d = -d; exit !(d < 1e-3) }' \
+  || fail "R2 $R2_shards with -J 3 far from serial $R2_serial"
+exit 0
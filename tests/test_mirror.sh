@@ -0,0 +1,17 @@
+#!/bin/sh
+#
+# -Mc: the block kernels reading the column mirror of the data give the
+# models of the kernels that transpose each block
+#
+
+. "$(dirname "$0")/common.sh"
+
+make_tank_data
+MODEL="-f1 tank_t.nrm -f2 tank_f1.nrm -c 2 -R 4 -q"
+
+fzymodel $MODEL -e a || fail "without mirror"
+fzymodel $MODEL -Mc -e b || fail "-Mc"
+for f in mod_ac2_*.fzy mod_ac2_*.out mod_ac2_*.r2 mod_ac2_*.err; do
+  same_file $f mod_b${f#mod_a}
+done
+exit 0
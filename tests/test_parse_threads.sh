@@ -0,0 +1,45 @@
+#!/bin/sh
+#
+# -Lt: a text data file parsed by several threads, with comments and
+# blank lines at the bounds of the ranges, gives the same results as
+# parsed by one thread, blocks (blocksize) included
+#
+
+. "$(dirname "$0")/common.sh"
+
+make_tank_data
+fzymodel -f1 tank_t.nrm -f2 tank_f1.nrm -c 2 -R 2 -q || fail "fzymodel"
+MODEL=mod_c2_ro.fzy
+
+# 20 copies of 490 rows of tank_f1.nrm in blocks of 10 rows, with
+# comments and extra blank lines between the blocks; more than 4 ranges
+# of 64 kB
+{
+  grep '^##' tank_f1.nrm | grep -v '^##rows:'
+  for round in 1 2 3 4 5 6 7 8 9 10 11 12 13 14 15 16 17 18 19 20; do
+    grep -v '^#' tank_f1.nrm | head -490 \
+      | awk -v r=$round '{ print }
+          NR % 10 == 0 {
+            print ""
+            if ((NR / 10 + r) % 3 == 0)
+              print "# comment " NR " of round " r ": a long line, so that" \
+                " the bounds of the ranges fall into comments"
+            if ((NR / 10) % 4 == 0) print ""
+          }'
+  done
+} > comments.nrm
+[ $(wc -c < comments.nrm) -gt 262144 ] || fail "comments.nrm too small"
+
+for threads in 1 3 4 5; do
+  mkdir lt$threads
+  (cd lt$threads && fzyestim -f1 ../$MODEL -f2 ../comments.nrm \
+    -Lt $threads -q) || fail "fzyestim -Lt $threads"
+done
+# blocks of 10 rows: a blank line behind every 10th row of the estimation
+[ $(cat lt1/*.out | grep -c '^$') -eq 980 ] || fail "-Lt 1: blocksize"
+for threads in 3 4 5; do
+  for f in lt1/*.out lt1/*.err lt1/*.r2; do
+    same_file $f lt$threads/$(basename $f)
+  done
+done
+exit 0
@@ -0,0 +1,67 @@
+#!/bin/sh
+#
+# --pipeline: normalizing, making the data and modeling in one process
+# gives the files and models of fzynorml, fzymkdat and fzymodel, up to
+# the precision the tools' .nor file keeps of the scaling;
+# --pipeline-no-original leaves out the .ogl files (fzymkdat -o)
+#
+
+. "$(dirname "$0")/common.sh"
+
+make_tank_data
+for f in tank_t tank_f1; do
+  mv $f.nrm $f.nrm.tools
+  mv $f.ogl $f.ogl.tools
+done
+MODEL="-c 2 -R 3 -q"
+
+# files $1 and $2 must have the same header, and the same numbers up to
+# their six significant digits
+same_numbers() {
+  awk 'NR == FNR { line[FNR] = $0; n = FNR; next }
+       { if (FNR > n) exit 1
+         if ($0 ~ /^#/) { if ($0 != line[FNR]) exit 1; next }
+         k = split(line[FNR], a, " ")
+         if (k != NF) exit 1
+         for (i = 1; i <= NF; ++i) {
+           d = $i - a[i]; if (d < 0) d = -d
+           m = $i; if (m < 0) m = -m
+           if (d > 1e-5 * (m + 1)) exit 1
+         }
+       }
+       END { if (FNR != n) exit 1 }' "$1" "$2" || fail "$1 and $2 differ"
+}
+
+# the final R2 of models $1 and $2 must agree within 1e-2; the
+# rounding of the tools' data leads the optimization to another model
+same_R2() {
+  awk -v a="$(tail -1 mod_$1_ro.r2)" -v b="$(tail -1 mod_$2_ro.r2)" \
+    'BEGIN { d = a - b; if (d < 0) d = -d; exit !(d < 1e-2) }' \
+    || fail "R2 of mod_$1 and mod_$2 differ"
+}
+
+fzymodel -f1 tank_t.nrm.tools -f2 tank_f1.nrm.tools $MODEL -e a \
+  || fail "fzymodel"
+fzymodel --pipeline tank_t.dat -d 1 1 --pipeline-files \
+  -f1 tank_t.dat -f2 tank_f1.dat $MODEL -e b || fail "--pipeline"
+same_file tank.nor tank_t.dat.nor
+for f in tank_t tank_f1; do
+  same_numbers $f.nrm.tools $f.nrm
+  same_numbers $f.ogl.tools $f.ogl
+done
+same_R2 ac2 bc2
+
+rm -f tank_t.nrm tank_f1.nrm tank_t.ogl tank_f1.ogl
+fzymodel --pipeline tank_t.dat -d 1 1 --pipeline-files \
+  --pipeline-no-original -f1 tank_t.dat -f2 tank_f1.dat $MODEL -e c \
+  || fail "--pipeline-no-original"
+[ -f tank_t.nrm ] && [ -f tank_f1.nrm ] || fail "no .nrm files written"
+[ -f tank_t.ogl ] || [ -f tank_f1.ogl ] && fail ".ogl file written"
+for f in mod_bc2_*.fzy mod_bc2_*.out mod_bc2_*.r2 mod_bc2_*.err; do
+  same_file $f mod_c${f#mod_b}
+done
+
+fzymodel --pipeline tank_t.dat -d 1 1 --pipeline-no-original \
+  -f1 tank_t.dat -f2 tank_f1.dat $MODEL -e d 2>/dev/null \
+  && fail "--pipeline-no-original accepted without --pipeline-files"
+exit 0
@@ -0,0 +1,39 @@
+#!/bin/sh
+#
+# -Sr: a race of the candidate models continues the training of the
+# survivors from round to round, so a race whose first budget covers the
+# full optimization (-O) gives the models of the serial search, and no
+# candidate's race error grows from one round to the next
+#
+
+. "$(dirname "$0")/common.sh"
+
+make_tank_data
+MODEL="-f1 tank_t.nrm -f2 tank_f1.nrm -c 2 -R 4 -q"
+
+fzymodel $MODEL -e a || fail "serial search"
+fzymodel $MODEL -Sr 250 -e b || fail "-Sr 250"
+for f in mod_ac2_*.fzy mod_ac2_*.out mod_ac2_*.r2 mod_ac2_*.err; do
+  same_file $f mod_b${f#mod_a}
+done
+
+fzymodel $MODEL -Sr 20 -j 1 -e c || fail "-Sr 20 on one thread"
+fzymodel $MODEL -Sr 20 -j 3 -e d || fail "-Sr 20"
+for f in mod_cc2_*.fzy mod_cc2_*.out mod_cc2_*.r2 mod_cc2_*.err; do
+  same_file $f mod_d${f#mod_c}
+done
+
+grep -c "race budget = 40" mod_cc2_rr.log >/dev/null \
+  || fail "-Sr 20 ran no second round"
+awk -F', ' '/race budget = / {
+  key = $2 ", " $3 ", " $4
+  split($6, e, " = ")
+  error = e[2] + 0
+  if ((key in last) && error > last[key]) {
+    print key ": race error " last[key] " grew to " error
+    bad = 1
+  }
+  last[key] = error
+}
+END { exit bad }' mod_cc2_rr.log >&2 || fail "race error grew between rounds"
+exit 0
@@ -0,0 +1,104 @@
+#!/bin/sh
+#
+# fzyestim --serve: each line of inputs is answered with the y_hat of
+# the batch estimation, also a last line without a newline; comment and
+# blank lines are not answered, malformed lines with an error line; -n
+# takes the scale from the head of -f2 only. On a socket, a live server
+# keeps its socket, a stale socket is replaced. At its end, also with
+# -q, the server reports the number of answers and their latencies on
+# stderr.
+#
+
+. "$(dirname "$0")/common.sh"
+
+make_tank_data
+fzymodel -f1 tank_t.nrm -f2 tank_f1.nrm -c 2 -R 3 -q -e a \
+  || fail "fzymodel"
+MODEL=mod_ac2_ro.fzy
+# a build without serving (WIN2017)
+fzyestim -f1 $MODEL --serve < /dev/null 2>&1 | grep -q "not supported" \
+  && exit 0
+
+# the inputs of tank_f1.nrm, the last line without a newline
+grep -v '^#' tank_f1.nrm | awk '{ printf "%s%s", s, $0; s = "\n" }' \
+  > inputs.txt
+fzyestim -f1 $MODEL -f2 tank_f1.nrm -v 0 > /dev/null \
+  || fail "batch estimation"
+grep -v '^#' est_ac2_ro.out | awk '{ print $3 }' > batch.txt
+fzyestim -f1 $MODEL --serve -q < inputs.txt > served.txt 2> report.txt \
+  || fail "--serve"
+same_file batch.txt served.txt
+# the report: served patterns: <n>, latency [us]: mean, p50, p99, max
+check_report() {
+  grep -q "^served patterns: $2\$" "$1" \
+    || fail "$1: no report of $2 served patterns"
+  grep -q '^latency \[us\]: mean [0-9.e+-]*, p50 [0-9.e+-]*, p99 [0-9.e+-]*, max [0-9.e+-]*$' "$1" \
+    || fail "$1: no latency report"
+}
+check_report report.txt $(wc -l < batch.txt)
+
+printf '# comment\n\n0.1 0.2\n1 2 3 4\n0.1 x\n0.3 0.4\n' > protocol.txt
+fzyestim -f1 $MODEL --serve -q < protocol.txt > answers.txt \
+  || fail "--serve of protocol.txt"
+[ $(wc -l < answers.txt) -eq 4 ] || fail "not 4 answers"
+sed -n 2p answers.txt | grep -q '^error: expected 2 input values$' \
+  || fail "no error for 4 values"
+sed -n 3p answers.txt | grep -q '^error: ' || fail "no error for 0.1 x"
+sed -n 1p answers.txt | grep -q '^error' && fail "error for 0.1 0.2"
+
+# -n reads the scale from the head of -f2, not its rows
+{ sed -n '/^#/p' tank_t.nrm; grep -v '^#' tank_t.nrm | head -1; \
+  echo "1 2 x"; } > scale.nrm
+grep -v '^#' tank_f1.ogl | head -20 > raw.txt
+fzyestim -f1 $MODEL -f2 tank_t.nrm -n --serve -q < raw.txt > n_full.txt \
+  || fail "-n --serve"
+fzyestim -f1 $MODEL -f2 scale.nrm -n --serve -q < raw.txt > n_head.txt \
+  || fail "-n --serve read behind the first row of -f2"
+same_file n_full.txt n_head.txt
+
+# the socket; the client needs perl
+perl -MIO::Socket::UNIX -e 1 2>/dev/null || exit 0
+client() {
+  perl -MIO::Socket::UNIX -e '
+    my $s = IO::Socket::UNIX->new(Peer => $ARGV[0]) or exit 1;
+    local $/; my $in = <STDIN>; print $s $in; shutdown($s, 1);
+    print while <$s>;' "$1"
+}
+wait_socket() {
+  n=0
+  while [ ! -S "$1" ]; do
+    n=$((n + 1))
+    [ $n -le 100 ] || fail "no socket $1"
+    sleep 0.1
+  done
+}
+fzyestim -f1 $MODEL --serve serve.sock -q 2> socket_report.txt &
+SERVER=$!
+wait_socket serve.sock
+client serve.sock < inputs.txt > socket.txt || fail "socket client"
+same_file batch.txt socket.txt
+fzyestim -f1 $MODEL --serve serve.sock -q 2>/dev/null \
+  && fail "second server on a live socket"
+client serve.sock < inputs.txt > socket2.txt \
+  || fail "live socket taken over"
+same_file batch.txt socket2.txt
+kill -TERM $SERVER
+wait $SERVER
+[ -e serve.sock ] && fail "socket left at SIGTERM"
+check_report socket_report.txt $((2 * $(wc -l < batch.txt)))
+
+# a server killed without removing its socket
+fzyestim -f1 $MODEL --serve stale.sock -q &
+SERVER=$!
+wait_socket stale.sock
+kill -KILL $SERVER
+wait $SERVER 2>/dev/null
+[ -S stale.sock ] || fail "no stale socket"
+fzyestim -f1 $MODEL --serve stale.sock -q &
+SERVER=$!
+sleep 1
+client stale.sock < inputs.txt > stale.txt || fail "stale socket kept"
+kill -TERM $SERVER
+wait $SERVER
+same_file batch.txt stale.txt
+exit 0
@@ -0,0 +1,35 @@
+#!/bin/sh
+#
+# fzysimul: the free-run simulation of output orders 1 and 3 reproduces
+# the results of release 2.9 (commit 9a53727), with and without -n, and
+# streamed (-M) or along the refinement tree (-Tp) as well
+#
+# The fixtures in simulation/: sim_o<order>.fzy and sim_o<order>.nrm,
+# the model and the data (200 rows of tank_f1.dat with dynamics 1
+# <order>), and the .out, .err and .r2 files of fzysimul -d <order> of
+# 9a53727 (sim_o<order>_n.* for -n). The consequences of sim_o3.fzy are
+# edited to weight all three lagged outputs.
+#
+
+. "$(dirname "$0")/common.sh"
+
+FIXTURES=$TESTDIR/simulation
+cp "$FIXTURES"/sim_o*.fzy "$FIXTURES"/sim_o*.nrm .
+
+for order in 1 3; do
+  for n in "" -n; do
+    expected=$FIXTURES/sim_o$order${n:+_n}
+    for options in "" "-M 64" "-Tp"; do
+      rm -rf run
+      mkdir run
+      (cd run && fzysimul -f1 ../sim_o$order.fzy -f2 ../sim_o$order.nrm \
+        -d $order $n $options -q) \
+        || fail "fzysimul -d $order $n $options"
+      for suffix in out err r2; do
+        cmp -s run/*.$suffix $expected.$suffix \
+          || fail "fzysimul -d $order $n $options: .$suffix differs"
+      done
+    done
+  done
+done
+exit 0
@@ -0,0 +1,37 @@
+#!/bin/sh
+#
+# fzyestim -M and fzysimul -M: the estimation (simulation) read and
+# written chunk by chunk equals that of the loaded data, .out (with the
+# Page-Hinkley columns), .err (RMS) and .r2 (R2), for chunks of whole
+# kernel blocks and of a row count that is none
+#
+
+. "$(dirname "$0")/common.sh"
+
+make_tank_data
+fzymodel -f1 tank_t.nrm -f2 tank_f1.nrm -c 2 -R 2 -q || fail "fzymodel"
+MODEL=mod_c2_ro.fzy
+[ -f $MODEL ] || fail "no $MODEL"
+
+# the results of <program> -M <rows> in directory <program>_<rows>
+for prg in fzyestim fzysimul; do
+  options="-Dph 0 0.01 0.01 0.1 -q"
+  [ $prg = fzysimul ] && options="$options -d 1"
+  for rows in 0 64 100; do
+    mkdir ${prg}_$rows
+    (cd ${prg}_$rows && $prg -f1 ../$MODEL -f2 ../tank_f1.nrm $options \
+      -M $rows) || fail "$prg -M $rows"
+  done
+  ls ${prg}_0/*.out ${prg}_0/*.err ${prg}_0/*.r2 > /dev/null 2>&1 \
+    || fail "$prg: missing output files"
+  for rows in 64 100; do
+    for f in ${prg}_0/*.out ${prg}_0/*.err ${prg}_0/*.r2; do
+      same_file $f ${prg}_$rows/$(basename $f)
+    done
+  done
+done
+
+# the Page-Hinkley test raises alarms and clears them
+awk 'NF > 0 { alarm[$NF] = 1 } END { exit !(alarm[0] && alarm[1]) }' \
+  fzyestim_0/*.out || fail "no alarms of the Page-Hinkley test"
+exit 0
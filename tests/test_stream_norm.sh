@@ -0,0 +1,49 @@
+#!/bin/sh
+#
+# fzynorml -M: the normalization read chunk by chunk, without a scan of
+# the file, equals that of the loaded data up to the last digits, on
+# any number of threads; with -u it reads no row behind the first n
+#
+
+. "$(dirname "$0")/common.sh"
+
+# .nor files $1 and $2 must agree, numbers up to their last two digits;
+# the ##source: and ##rows: lines are left out
+same_normalization() {
+  grep -v -e '^##source:' -e '^##rows:' "$1" > same.1
+  grep -v -e '^##source:' -e '^##rows:' "$2" > same.2
+  awk 'NR == FNR { line[FNR] = $0; n = FNR; next }
+       { if (FNR > n) exit 1
+         k = split(line[FNR], a, " ")
+         if (k != NF) exit 1
+         for (i = 1; i <= NF; ++i) {
+           if ($i == a[i]) continue
+           if ($i !~ /^[-+.0-9eE]+$/) exit 1
+           d = $i - a[i]; if (d < 0) d = -d
+           m = $i; if (m < 0) m = -m
+           if (d > 1e-4 * (m + 1)) exit 1
+         }
+       }
+       END { if (FNR != n) exit 1 }' same.1 same.2 \
+    || fail "$1 and $2 differ"
+}
+
+cp "$EXAMPLES/tank/tank_t.dat" .
+fzynorml -f1 tank_t.dat -f2 load.nor -q || fail "fzynorml"
+fzynorml -f1 tank_t.dat -f2 stream.nor -M 64 -q || fail "-M 64"
+same_normalization load.nor stream.nor
+grep -q '^##rows: 1000$' stream.nor || fail "-M 64: rows of the file"
+fzynorml -f1 tank_t.dat -f2 stream3.nor -M 64 -Lt 3 -q \
+  || fail "-M 64 -Lt 3"
+same_file stream.nor stream3.nor
+
+# a parse error behind the rows to normalize
+head -300 tank_t.dat > head.dat
+{ cat head.dat; echo "1 2 x"; } > bad.dat
+fzynorml -f1 head.dat -f2 head.nor -q || fail "fzynorml of 300 rows"
+fzynorml -f1 bad.dat -f2 bad.nor -M 64 -u 300 -q \
+  || fail "-M 64 -u 300 read behind row 300"
+same_normalization head.nor bad.nor
+fzynorml -f1 bad.dat -f2 bad_all.nor -M 64 -q 2>/dev/null \
+  && fail "-M 64 accepted a parse error"
+exit 0
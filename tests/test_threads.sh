@@ -0,0 +1,19 @@
+#!/bin/sh
+#
+# -j: the candidate models of an epoch trained on several threads give
+# the models of the serial search, whatever number of threads
+#
+
+. "$(dirname "$0")/common.sh"
+
+make_tank_data
+MODEL="-f1 tank_t.nrm -f2 tank_f1.nrm -c 2 -R 4 -q"
+
+fzymodel $MODEL -e a || fail "serial search"
+fzymodel $MODEL -j 2 -e b || fail "-j 2"
+fzymodel $MODEL -j 5 -e c || fail "-j 5"
+for f in mod_ac2_*.fzy mod_ac2_*.out mod_ac2_*.r2 mod_ac2_*.err; do
+  same_file $f mod_b${f#mod_a}
+  same_file $f mod_c${f#mod_a}
+done
+exit 0